@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AsyncAnnotationWriter.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+typedef TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>> FCondensedJsonWriter;
+
+/**
+ * Writes a vector as a JSON array.
+ *
+ * @param Writer The JSON writer.
+ * @param Name The name of the field.
+ * @param Vector The vector to write.
+ */
+static void WriteVector(FCondensedJsonWriter& Writer, const TCHAR* Name, const FVector& Vector)
+{
+	Writer.WriteArrayStart(Name);
+	Writer.WriteValue(Vector.X);
+	Writer.WriteValue(Vector.Y);
+	Writer.WriteValue(Vector.Z);
+	Writer.WriteArrayEnd();
+}
+
+/**
+ * Serializes a single annotation record to a JSON line.
+ *
+ * @param Annotation The record to serialize.
+ * @param OutLine The JSON line, without the line terminator.
+ * @return True if the record was serialized, false otherwise.
+ */
+static bool SerializeAnnotation(const FCaptureAnnotation& Annotation, FString& OutLine)
+{
+	TSharedRef<FCondensedJsonWriter> writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutLine);
+	writer->WriteObjectStart();
+	writer->WriteValue(TEXT("Image"), Annotation.ImageFilename);
+	writer->WriteValue(TEXT("Camera"), Annotation.CameraName);
+	writer->WriteValue(TEXT("Frame"), (int64)Annotation.FrameNumber);
+	writer->WriteValue(TEXT("SimTime"), Annotation.SimTime);
+
+	writer->WriteObjectStart(TEXT("Weather"));
+	writer->WriteValue(TEXT("Daylight"), Annotation.Daylight);
+	writer->WriteValue(TEXT("Cloudiness"), Annotation.Cloudiness);
+	writer->WriteValue(TEXT("RainIntensity"), Annotation.RainIntensity);
+	writer->WriteObjectEnd();
+
+	writer->WriteArrayStart(TEXT("Cars"));
+	for (const FCarAnnotation& car : Annotation.Cars)
+	{
+		writer->WriteObjectStart();
+		writer->WriteValue(TEXT("Id"), car.Id);
+		writer->WriteValue(TEXT("Class"), car.ClassName);
+		writer->WriteValue(TEXT("Path"), car.PathName);
+		writer->WriteArrayStart(TEXT("Box2D"));
+		writer->WriteValue(car.ScreenBox.Min.X);
+		writer->WriteValue(car.ScreenBox.Min.Y);
+		writer->WriteValue(car.ScreenBox.Max.X);
+		writer->WriteValue(car.ScreenBox.Max.Y);
+		writer->WriteArrayEnd();
+		WriteVector(*writer, TEXT("Center"), car.Center);
+		WriteVector(*writer, TEXT("Extent"), car.Extent);
+		WriteVector(*writer, TEXT("Rotation"), FVector(car.Rotation.Pitch, car.Rotation.Yaw, car.Rotation.Roll));
+		writer->WriteValue(TEXT("Speed"), car.Speed);
+		writer->WriteValue(TEXT("CanMove"), car.bCanMove);
+		writer->WriteValue(TEXT("LightsOn"), car.bLightsOn);
+		writer->WriteObjectEnd();
+	}
+	writer->WriteArrayEnd();
+
+	writer->WriteObjectStart(TEXT("TrafficLights"));
+	for (const FTrafficLightsAnnotation& trafficLights : Annotation.TrafficLights)
+	{
+		writer->WriteValue(trafficLights.Id, trafficLights.State);
+	}
+	writer->WriteObjectEnd();
+
+	writer->WriteObjectEnd();
+	return writer->Close();
+}
+
+/**
+ * Destructor for FAsyncAnnotationWriter.
+ * Waits for the batch in flight to be written.
+ */
+FAsyncAnnotationWriter::~FAsyncAnnotationWriter()
+{
+	Flush();
+}
+
+/**
+ * Queues a batch of annotation records for serialization and writing.
+ * Blocks until the previous batch completes if it is still in flight.
+ *
+ * @param Annotations The records to write, moved into the writer.
+ */
+void FAsyncAnnotationWriter::Enqueue(TArray<FCaptureAnnotation>&& Annotations)
+{
+	if (Annotations.Num() <= 0)
+	{
+		return;
+	}
+
+	_CollectPending(false);
+	if (_Pending.IsValid())
+	{
+		_StallCount++;
+		_CollectPending(true);
+	}
+
+	_Pending = Async(EAsyncExecution::ThreadPool,
+		[annotations = MoveTemp(Annotations)]()
+		{
+			return _SerializeAndAppend(annotations);
+		});
+}
+
+/**
+ * Waits for the batch in flight to be written and collects it.
+ */
+void FAsyncAnnotationWriter::Flush()
+{
+	_CollectPending(true);
+}
+
+/**
+ * Logs the accumulated metrics of the writer.
+ */
+void FAsyncAnnotationWriter::LogStatistics() const
+{
+	double averageSerializeMs = (_WrittenCount > 0) ? _TotalSerializeSeconds * 1000.0 / _WrittenCount : 0.0;
+	UE_LOG(LogTemp, Log, TEXT("Annotation writer: %d records written, %d failed, %lld bytes, average serialize %.3f ms, %d stalls."),
+		_WrittenCount, _FailedCount, _TotalBytesWritten, averageSerializeMs, _StallCount);
+}
+
+/**
+ * Collects the batch in flight if it completed, or waits for it.
+ *
+ * @param bWait True to wait for the batch, false to collect it only if it completed.
+ */
+void FAsyncAnnotationWriter::_CollectPending(bool bWait)
+{
+	if (!_Pending.IsValid() || (!bWait && !_Pending.IsReady()))
+	{
+		return;
+	}
+
+	FAsyncAnnotationResult result = _Pending.Get();
+	_Pending.Reset();
+
+	if (result.FailedCount > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write %d annotation records."), result.FailedCount);
+	}
+
+	_WrittenCount += result.WrittenCount;
+	_FailedCount += result.FailedCount;
+	_TotalSerializeSeconds += result.SerializeSeconds;
+	_TotalBytesWritten += result.BytesWritten;
+}
+
+/**
+ * Serializes annotation records to JSON lines and appends them to their files. Runs on a worker thread.
+ * Records of the same file are appended with a single write, encoded as UTF-8.
+ *
+ * @param Annotations The records to write.
+ * @return The result of the batch.
+ */
+FAsyncAnnotationResult FAsyncAnnotationWriter::_SerializeAndAppend(const TArray<FCaptureAnnotation>& Annotations)
+{
+	FAsyncAnnotationResult result;
+
+	double serializeStart = FPlatformTime::Seconds();
+	TMap<FString, FString> fileContents;
+	TMap<FString, int32> fileRecordCounts;
+	for (const FCaptureAnnotation& annotation : Annotations)
+	{
+		FString line;
+		if (!SerializeAnnotation(annotation, line))
+		{
+			result.FailedCount++;
+			continue;
+		}
+
+		FString& contents = fileContents.FindOrAdd(annotation.AnnotationFilepath);
+		contents += line;
+		contents += TEXT("\n");
+		fileRecordCounts.FindOrAdd(annotation.AnnotationFilepath)++;
+	}
+	result.SerializeSeconds = FPlatformTime::Seconds() - serializeStart;
+
+	for (const TPair<FString, FString>& file : fileContents)
+	{
+		int32 recordCount = fileRecordCounts[file.Key];
+		FTCHARToUTF8 utf8(*file.Value);
+		TArrayView<const uint8> bytes((const uint8*)utf8.Get(), utf8.Length());
+		if (!FFileHelper::SaveArrayToFile(bytes, *file.Key, &IFileManager::Get(), FILEWRITE_Append))
+		{
+			result.FailedCount += recordCount;
+			continue;
+		}
+
+		result.WrittenCount += recordCount;
+		result.BytesWritten += utf8.Length();
+	}
+
+	return result;
+}
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+/**
+ * FCarAnnotation holds the ground truth of a single car seen by a camera.
+ */
+struct FCarAnnotation
+{
+	/** Identifier of the car, unique across the lifetimes of pooled car actors. */
+	FString Id;
+
+	/** Name of the car's class, the blueprint the car was spawned from. */
+	FString ClassName;
+
+	/** Name of the path the car follows. */
+	FString PathName;
+
+	/** Bounding box of the car in the image, normalized to [0, 1] with the origin in the top left corner. */
+	FBox2D ScreenBox = FBox2D(ForceInit);
+
+	/** Center of the car's body box in world space. */
+	FVector Center = FVector::ZeroVector;
+
+	/** Half extent of the car's body box. */
+	FVector Extent = FVector::ZeroVector;
+
+	/** Rotation of the car's body box in world space. */
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/** Current speed of the car, in units per second. */
+	float Speed = 0.0f;
+
+	/** Whether the car is moving, false if it is stopped or waiting for traffic lights, a critical zone or another car. */
+	bool bCanMove = true;
+
+	/** Whether the car's lights are on. */
+	bool bLightsOn = false;
+};
+
+/**
+ * FTrafficLightsAnnotation holds the state of a single traffic lights actor.
+ */
+struct FTrafficLightsAnnotation
+{
+	/** Name of the traffic lights actor. */
+	FString Id;
+
+	/** Name of the current state of the traffic lights. */
+	FString State;
+};
+
+/**
+ * FCaptureAnnotation holds the ground truth of a single captured image, collected from the simulation state
+ * in the frame the image was captured.
+ */
+struct FCaptureAnnotation
+{
+	/** Path of the annotation file the record is appended to. */
+	FString AnnotationFilepath;
+
+	/** Name of the image file the record describes. */
+	FString ImageFilename;
+
+	/** Name of the camera that captured the image. */
+	FString CameraName;
+
+	/** Engine frame the image was captured in. */
+	uint64 FrameNumber = 0;
+
+	/** Simulation time the image was captured at, in seconds. */
+	double SimTime = 0.0;
+
+	/** Amount of daylight, 0 for night and 1 for day. */
+	float Daylight = 1.0f;
+
+	/** Cloudiness, 0 for a clear sky and 1 for an overcast sky. */
+	float Cloudiness = 0.0f;
+
+	/** Rain intensity, 0 for no rain and 1 for full rain. */
+	float RainIntensity = 0.0f;
+
+	/** Cars inside the camera's view. */
+	TArray<FCarAnnotation> Cars;
+
+	/** All traffic lights of the level. */
+	TArray<FTrafficLightsAnnotation> TrafficLights;
+};
+
+/**
+ * FAsyncAnnotationResult describes a batch of annotation records serialized and written by a worker thread.
+ */
+struct FAsyncAnnotationResult
+{
+	/** Number of records written successfully. */
+	int32 WrittenCount = 0;
+
+	/** Number of records that failed to serialize or write. */
+	int32 FailedCount = 0;
+
+	/** Time spent serializing the records, in seconds. */
+	double SerializeSeconds = 0.0;
+
+	/** Number of bytes written. */
+	int64 BytesWritten = 0;
+};
+
+/**
+ * FAsyncAnnotationWriter serializes capture annotations to JSON lines and appends them to one file per camera
+ * on the thread pool. A single batch is in flight at a time, so the records of every file stay in capture order;
+ * if the previous batch is still running when a new one is queued, the game thread waits for it.
+ * All methods must be called from the game thread.
+ */
+class TSTOOLKIT_API FAsyncAnnotationWriter
+{
+public:
+	/**
+	 * Destructor for FAsyncAnnotationWriter.
+	 * Waits for the batch in flight to be written.
+	 */
+	~FAsyncAnnotationWriter();
+
+	/**
+	 * Queues a batch of annotation records for serialization and writing.
+	 * Blocks until the previous batch completes if it is still in flight.
+	 *
+	 * @param Annotations The records to write, moved into the writer.
+	 */
+	void Enqueue(TArray<FCaptureAnnotation>&& Annotations);
+
+	/**
+	 * Waits for the batch in flight to be written and collects it.
+	 */
+	void Flush();
+
+	/**
+	 * Logs the accumulated metrics of the writer.
+	 */
+	void LogStatistics() const;
+
+private:
+	/** Batch in flight, invalid if there is none. */
+	TFuture<FAsyncAnnotationResult> _Pending;
+
+	/** Number of records written successfully. */
+	int32 _WrittenCount = 0;
+
+	/** Number of records that failed to serialize or write. */
+	int32 _FailedCount = 0;
+
+	/** Number of times the game thread had to wait for the previous batch. */
+	int32 _StallCount = 0;
+
+	/** Total time spent serializing, in seconds. */
+	double _TotalSerializeSeconds = 0.0;
+
+	/** Total number of bytes written. */
+	int64 _TotalBytesWritten = 0;
+
+	/**
+	 * Collects the batch in flight if it completed, or waits for it.
+	 *
+	 * @param bWait True to wait for the batch, false to collect it only if it completed.
+	 */
+	void _CollectPending(bool bWait);
+
+	/**
+	 * Serializes annotation records to JSON lines and appends them to their files. Runs on a worker thread.
+	 *
+	 * @param Annotations The records to write.
+	 * @return The result of the batch.
+	 */
+	static FAsyncAnnotationResult _SerializeAndAppend(const TArray<FCaptureAnnotation>& Annotations);
+};
@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AsyncScreenshotWriter.h"
+#include "Async/Async.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Misc/FileHelper.h"
+#include "Modules/ModuleManager.h"
+#include "HAL/PlatformTime.h"
+
+/**
+ * Constructor for FAsyncScreenshotWriter.
+ * Loads the image wrapper module on the game thread so the workers only create encoders.
+ *
+ * @param MaxQueueDepth The maximum number of screenshots encoded at the same time.
+ */
+FAsyncScreenshotWriter::FAsyncScreenshotWriter(int32 MaxQueueDepth)
+	: _MaxQueueDepth(FMath::Max(1, MaxQueueDepth))
+{
+	_ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	_Pending.Reserve(_MaxQueueDepth);
+}
+
+/**
+ * Destructor for FAsyncScreenshotWriter.
+ * Waits for all queued screenshots to be written.
+ */
+FAsyncScreenshotWriter::~FAsyncScreenshotWriter()
+{
+	Flush();
+}
+
+/**
+ * Queues a pixel buffer for encoding and writing.
+ * Blocks until the oldest screenshot completes if the queue is full.
+ *
+ * @param Filepath The path of the file to write.
+ * @param Width The width of the image, in pixels.
+ * @param Height The height of the image, in pixels.
+ * @param Pixels The pixels of the image, moved into the writer.
+ * @return True if the screenshot was queued, false otherwise.
+ */
+bool FAsyncScreenshotWriter::Enqueue(const FString& Filepath, int32 Width, int32 Height, TArray<FColor>&& Pixels)
+{
+	if (Width <= 0 || Height <= 0 || Pixels.Num() != Width * Height)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Enqueue: Invalid image %dx%d with %d pixels for %s."), Width, Height, Pixels.Num(), *Filepath);
+		return false;
+	}
+
+	// Backpressure, wait for the oldest screenshot when the queue is full
+	CollectCompleted();
+	if (_Pending.Num() >= _MaxQueueDepth)
+	{
+		_Stats.StallCount++;
+		_Pending[0].Wait();
+		_AddResult(_Pending[0].Get());
+		_Pending.RemoveAt(0, 1, false);
+	}
+
+	IImageWrapperModule* imageWrapperModule = _ImageWrapperModule;
+	_Pending.Add(Async(EAsyncExecution::ThreadPool,
+		[imageWrapperModule, Filepath, Width, Height, pixels = MoveTemp(Pixels)]()
+		{
+			return _EncodeAndWrite(imageWrapperModule, Filepath, Width, Height, pixels);
+		}));
+
+	_Stats.QueueDepth = _Pending.Num();
+	_Stats.PeakQueueDepth = FMath::Max(_Stats.PeakQueueDepth, _Stats.QueueDepth);
+	return true;
+}
+
+/**
+ * Collects the screenshots completed since the last call and updates the metrics.
+ * Screenshots are collected in queue order, so a slow screenshot holds back the ones queued after it.
+ */
+void FAsyncScreenshotWriter::CollectCompleted()
+{
+	_Stats.FrameCompletedCount = 0;
+	_Stats.FrameEncodeSeconds = 0.0;
+	_Stats.FrameBytesWritten = 0;
+
+	int32 completedCount = 0;
+	while (completedCount < _Pending.Num() && _Pending[completedCount].IsReady())
+	{
+		_AddResult(_Pending[completedCount].Get());
+		completedCount++;
+	}
+
+	if (completedCount > 0)
+	{
+		_Pending.RemoveAt(0, completedCount, false);
+	}
+
+	_Stats.QueueDepth = _Pending.Num();
+}
+
+/**
+ * Waits for all queued screenshots to be written and collects them.
+ */
+void FAsyncScreenshotWriter::Flush()
+{
+	for (TFuture<FAsyncScreenshotResult>& pending : _Pending)
+	{
+		pending.Wait();
+	}
+
+	CollectCompleted();
+}
+
+/**
+ * Logs the accumulated metrics of the writer.
+ */
+void FAsyncScreenshotWriter::LogStatistics() const
+{
+	double averageEncodeMs = (_Stats.WrittenCount > 0) ? _Stats.TotalEncodeSeconds * 1000.0 / _Stats.WrittenCount : 0.0;
+	UE_LOG(LogTemp, Log, TEXT("Screenshot writer: %d written, %d failed, %lld bytes, average encode %.2f ms, peak queue depth %d of %d, %d stalls."),
+		_Stats.WrittenCount, _Stats.FailedCount, _Stats.TotalBytesWritten, averageEncodeMs,
+		_Stats.PeakQueueDepth, _MaxQueueDepth, _Stats.StallCount);
+}
+
+/**
+ * Adds a completed screenshot to the metrics.
+ *
+ * @param Result The result of the completed screenshot.
+ */
+void FAsyncScreenshotWriter::_AddResult(const FAsyncScreenshotResult& Result)
+{
+	if (!Result.bSucceeded)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write screenshot: %s"), *Result.Filepath);
+		_Stats.FailedCount++;
+		return;
+	}
+
+	_Stats.WrittenCount++;
+	_Stats.TotalEncodeSeconds += Result.EncodeSeconds;
+	_Stats.TotalBytesWritten += Result.BytesWritten;
+	_Stats.FrameCompletedCount++;
+	_Stats.FrameEncodeSeconds += Result.EncodeSeconds;
+	_Stats.FrameBytesWritten += Result.BytesWritten;
+}
+
+/**
+ * Encodes a pixel buffer to PNG and writes it to disk. Runs on a worker thread.
+ *
+ * @param ImageWrapperModule The image wrapper module used to create the encoder.
+ * @param Filepath The path of the file to write.
+ * @param Width The width of the image, in pixels.
+ * @param Height The height of the image, in pixels.
+ * @param Pixels The pixels of the image.
+ * @return The result of the screenshot.
+ */
+FAsyncScreenshotResult FAsyncScreenshotWriter::_EncodeAndWrite(IImageWrapperModule* ImageWrapperModule, const FString& Filepath,
+	int32 Width, int32 Height, const TArray<FColor>& Pixels)
+{
+	FAsyncScreenshotResult result;
+	result.Filepath = Filepath;
+
+	if (!ImageWrapperModule)
+	{
+		return result;
+	}
+
+	TSharedPtr<IImageWrapper> imageWrapper = ImageWrapperModule->CreateImageWrapper(EImageFormat::PNG);
+	if (!imageWrapper.IsValid())
+	{
+		return result;
+	}
+
+	double encodeStart = FPlatformTime::Seconds();
+	if (!imageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Width, Height, ERGBFormat::BGRA, 8))
+	{
+		return result;
+	}
+	TArray64<uint8> compressed = imageWrapper->GetCompressed();
+	result.EncodeSeconds = FPlatformTime::Seconds() - encodeStart;
+
+	double writeStart = FPlatformTime::Seconds();
+	if (!FFileHelper::SaveArrayToFile(compressed, *Filepath))
+	{
+		return result;
+	}
+	result.WriteSeconds = FPlatformTime::Seconds() - writeStart;
+
+	result.BytesWritten = compressed.Num();
+	result.bSucceeded = true;
+	return result;
+}
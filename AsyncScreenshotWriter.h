@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+class IImageWrapperModule;
+
+/**
+ * FAsyncScreenshotResult describes a single screenshot encoded and written by a worker thread.
+ */
+struct FAsyncScreenshotResult
+{
+	/** Path of the written file. */
+	FString Filepath;
+
+	/** Whether the file was encoded and written successfully. */
+	bool bSucceeded = false;
+
+	/** Time spent encoding the image, in seconds. */
+	double EncodeSeconds = 0.0;
+
+	/** Time spent writing the file, in seconds. */
+	double WriteSeconds = 0.0;
+
+	/** Size of the written file, in bytes. */
+	int64 BytesWritten = 0;
+};
+
+/**
+ * FAsyncScreenshotStats holds the metrics of an FAsyncScreenshotWriter.
+ * The Frame* values cover the screenshots completed in the last call to CollectCompleted.
+ */
+struct FAsyncScreenshotStats
+{
+	/** Number of screenshots queued and not yet completed. */
+	int32 QueueDepth = 0;
+
+	/** Highest number of screenshots queued at the same time. */
+	int32 PeakQueueDepth = 0;
+
+	/** Number of times the game thread had to wait because the queue was full. */
+	int32 StallCount = 0;
+
+	/** Number of screenshots written successfully. */
+	int32 WrittenCount = 0;
+
+	/** Number of screenshots that failed to encode or write. */
+	int32 FailedCount = 0;
+
+	/** Total time spent encoding, in seconds. */
+	double TotalEncodeSeconds = 0.0;
+
+	/** Total number of bytes written. */
+	int64 TotalBytesWritten = 0;
+
+	/** Number of screenshots completed in the last collection. */
+	int32 FrameCompletedCount = 0;
+
+	/** Time spent encoding the screenshots completed in the last collection, in seconds. */
+	double FrameEncodeSeconds = 0.0;
+
+	/** Bytes written by the screenshots completed in the last collection. */
+	int64 FrameBytesWritten = 0;
+};
+
+/**
+ * FAsyncScreenshotWriter encodes captured pixel buffers to PNG and writes them to disk on the thread pool.
+ * The number of screenshots in flight is bounded by MaxQueueDepth; when the queue is full the game thread
+ * waits for the oldest screenshot, which applies backpressure instead of growing memory without limit.
+ * All methods must be called from the game thread.
+ */
+class TSTOOLKIT_API FAsyncScreenshotWriter
+{
+public:
+	/**
+	 * Constructor for FAsyncScreenshotWriter.
+	 *
+	 * @param MaxQueueDepth The maximum number of screenshots encoded at the same time.
+	 */
+	explicit FAsyncScreenshotWriter(int32 MaxQueueDepth);
+
+	/**
+	 * Destructor for FAsyncScreenshotWriter.
+	 * Waits for all queued screenshots to be written.
+	 */
+	~FAsyncScreenshotWriter();
+
+	/**
+	 * Queues a pixel buffer for encoding and writing.
+	 * Blocks until the oldest screenshot completes if the queue is full.
+	 *
+	 * @param Filepath The path of the file to write.
+	 * @param Width The width of the image, in pixels.
+	 * @param Height The height of the image, in pixels.
+	 * @param Pixels The pixels of the image, moved into the writer.
+	 * @return True if the screenshot was queued, false otherwise.
+	 */
+	bool Enqueue(const FString& Filepath, int32 Width, int32 Height, TArray<FColor>&& Pixels);
+
+	/**
+	 * Collects the screenshots completed since the last call and updates the metrics.
+	 */
+	void CollectCompleted();
+
+	/**
+	 * Waits for all queued screenshots to be written and collects them.
+	 */
+	void Flush();
+
+	/**
+	 * Logs the accumulated metrics of the writer.
+	 */
+	void LogStatistics() const;
+
+	/**
+	 * Gets the metrics of the writer.
+	 *
+	 * @return The metrics of the writer.
+	 */
+	FORCEINLINE const FAsyncScreenshotStats& GetStats() const
+	{
+		return _Stats;
+	}
+
+private:
+	/** The maximum number of screenshots encoded at the same time. */
+	int32 _MaxQueueDepth;
+
+	/** Image wrapper module used by the workers, loaded on the game thread. */
+	IImageWrapperModule* _ImageWrapperModule = nullptr;
+
+	/** Screenshots in flight, oldest first. */
+	TArray<TFuture<FAsyncScreenshotResult>> _Pending;
+
+	/** Metrics of the writer. */
+	FAsyncScreenshotStats _Stats;
+
+	/**
+	 * Adds a completed screenshot to the metrics.
+	 *
+	 * @param Result The result of the completed screenshot.
+	 */
+	void _AddResult(const FAsyncScreenshotResult& Result);
+
+	/**
+	 * Encodes a pixel buffer to PNG and writes it to disk. Runs on a worker thread.
+	 *
+	 * @param ImageWrapperModule The image wrapper module used to create the encoder.
+	 * @param Filepath The path of the file to write.
+	 * @param Width The width of the image, in pixels.
+	 * @param Height The height of the image, in pixels.
+	 * @param Pixels The pixels of the image.
+	 * @return The result of the screenshot.
+	 */
+	static FAsyncScreenshotResult _EncodeAndWrite(IImageWrapperModule* ImageWrapperModule, const FString& Filepath,
+		int32 Width, int32 Height, const TArray<FColor>& Pixels);
+};
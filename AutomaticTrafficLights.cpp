@@ -11,34 +11,26 @@ AAutomaticTrafficLights::AAutomaticTrafficLights()
 		UE_LOG(LogTemp, Warning, TEXT("RedToGreenLightCountDownTime is invalid. Setting to default value of 5.0f."));
 		RedToGreenLightCountDownTime = 5.0f;
 	}
-
-	_Countdown = RedToGreenLightCountDownTime;
 }
 
-void AAutomaticTrafficLights::Tick(float DeltaTime)
+void AAutomaticTrafficLights::BeginPlay()
 {
-	Super::Tick(DeltaTime);
+	Super::BeginPlay();
 
-	// Ensure DeltaTime is valid
-	if (DeltaTime <= 0.0f)
+	// Ensure the countdown time is valid, it may have been changed in the editor
+	if (RedToGreenLightCountDownTime <= 0.0f)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("DeltaTime is invalid. Skipping Tick update."));
-		return;
+		UE_LOG(LogTemp, Warning, TEXT("RedToGreenLightCountDownTime is invalid. Setting to default value of 5.0f."));
+		RedToGreenLightCountDownTime = 5.0f;
 	}
 
-	// Decrease the countdown timer
-	_Countdown -= DeltaTime;
-	if (_Countdown <= 0)
-	{
-		_ChangeStateAfterCountdown();
-	}
+	// Change the state on a looping timer instead of counting down every frame
+	GetWorldTimerManager().SetTimer(_CountdownTimerHandle, this, &AAutomaticTrafficLights::_ChangeStateAfterCountdown,
+		RedToGreenLightCountDownTime, true);
 }
 
 void AAutomaticTrafficLights::_ChangeStateAfterCountdown()
 {
-	// Reset the countdown timer
-	_Countdown = RedToGreenLightCountDownTime;
-
 	// Validate the current state before toggling
 	if (CurrentState != ETrafficLightsStates::Red && CurrentState != ETrafficLightsStates::Green)
 	{
@@ -32,21 +32,21 @@ public:
 
 private:
 	/**
-  * Internal countdown timer used to track the time remaining before changing the light state.
+  * Handle of the looping timer that changes the light state.
   */
-	float _Countdown;
+	FTimerHandle _CountdownTimerHandle;
 
-public:
+protected:
 	/**
-  * Called every frame to update the traffic light system.
-  * @param DeltaTime - The time elapsed since the last frame.
+  * Called when the game starts or when the actor is spawned.
+  * Starts the looping countdown timer.
   */
-	virtual void Tick(float DeltaTime) override;
+	virtual void BeginPlay() override;
 
 private:
 	/**
   * Changes the traffic light state after the countdown timer reaches zero.
-  * This method is called internally to handle the state transition logic.
+  * This method is called by the countdown timer to handle the state transition logic.
   */
 	virtual void _ChangeStateAfterCountdown();
 };
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include "Camera/CameraComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerController.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "TrafficRegistrySubsystem.h"
+#include "CaptureManifestSubsystem.h"
 
 /**
  * Constructor for the ACamera class.
@@ -23,6 +27,20 @@ ACamera::ACamera()
 	cameraComponent->AspectRatio = 16.0f / 9.0f;
 	cameraComponent->bConstrainAspectRatio = false;
 
+	// Set up the scene capture, it only renders when a capture is requested
+	SceneCapture = CreateDefaultSubobject<USceneCaptureComponent2D>(TEXT("Scene Capture Component"));
+	if (!SceneCapture)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to create SceneCapture in ACamera constructor."));
+	}
+	else
+	{
+		SceneCapture->SetupAttachment(cameraComponent);
+		SceneCapture->bCaptureEveryFrame = false;
+		SceneCapture->bCaptureOnMovement = false;
+		SceneCapture->CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+	}
+
 	// Set default save directory and screenshot countdown
 	SaveDirectory = FPaths::ProjectDir() + "Screenshots/" + CameraName + "/";
 	_ScreenshotCountdown = ScreenshotInterval;
@@ -43,6 +61,38 @@ void ACamera::Tick(float DeltaTime)
 	}
 }
 
+/**
+ * Called after the actor's components are initialized.
+ * Registers the camera with the traffic registry before any actor begins play.
+ */
+void ACamera::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterCamera(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the camera from the traffic registry.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void ACamera::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterCamera(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 /**
  * Called when the actor is constructed or properties are changed in the editor.
  * Updates the save directory based on the camera name.
@@ -61,10 +111,8 @@ void ACamera::OnConstruction(const FTransform& Transform)
 void ACamera::TakeScreenshot()
 {
 	// Create the file path for the screenshot
-	FDateTime currentTime = FDateTime::Now();
-	FString currentTimeString = currentTime.ToString(TEXT("%Y%m%d%H%M%S"));
-	FString filename = currentTimeString + ".png";
-	FString filepath = FPaths::Combine(SaveDirectory, filename);
+	FString filepath = CreateScreenshotFilepath();
+	_LastScreenshotFilepath = filepath;
 
 	// Store the original view target
 	UWorld* world = GetWorld();
@@ -112,6 +160,102 @@ void ACamera::TakeScreenshot()
 	FScreenshotRequest::RequestScreenshot(filepath, false, false);
 }
 
+/**
+ * Renders the camera's view into its render target.
+ * The render target is created on first use, and the capture uses the camera's field of view and post process settings.
+ * The pixels are available once the render thread has processed the capture.
+ *
+ * @return True if the capture was queued, false otherwise.
+ */
+bool ACamera::CaptureToRenderTarget()
+{
+	if (!SceneCapture)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SceneCapture is null in CaptureToRenderTarget."));
+		return false;
+	}
+
+	UCameraComponent* cameraComponent = GetCameraComponent();
+	if (!cameraComponent)
+	{
+		UE_LOG(LogTemp, Error, TEXT("CameraComponent is null in CaptureToRenderTarget."));
+		return false;
+	}
+
+	if (!_RenderTarget)
+	{
+		_RenderTarget = NewObject<UTextureRenderTarget2D>(this);
+		if (!_RenderTarget)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to create render target in CaptureToRenderTarget."));
+			return false;
+		}
+
+		_RenderTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8_SRGB;
+		_RenderTarget->InitAutoFormat(CaptureWidth, CaptureHeight);
+		_RenderTarget->UpdateResourceImmediate(true);
+		SceneCapture->TextureTarget = _RenderTarget;
+	}
+
+	SceneCapture->FOVAngle = cameraComponent->FieldOfView;
+	SceneCapture->PostProcessSettings = cameraComponent->PostProcessSettings;
+	SceneCapture->PostProcessBlendWeight = cameraComponent->PostProcessBlendWeight;
+	SceneCapture->CaptureScene();
+	return true;
+}
+
+/**
+ * Creates the path of a new screenshot file in the save directory.
+ * The file is named by the next frame id of the capture manifest, which also indexes the file.
+ * Without a manifest the file is named by the current time with millisecond precision.
+ *
+ * @return The path of the screenshot file.
+ */
+FString ACamera::CreateScreenshotFilepath() const
+{
+	UWorld* world = GetWorld();
+	UCaptureManifestSubsystem* manifest = world ? world->GetSubsystem<UCaptureManifestSubsystem>() : nullptr;
+	if (manifest)
+	{
+		return manifest->AddCapture(CameraName, SaveDirectory);
+	}
+
+	FDateTime currentTime = FDateTime::Now();
+	FString currentTimeString = currentTime.ToString(TEXT("%Y%m%d%H%M%S%s"));
+	FString filename = currentTimeString + ".png";
+	return FPaths::Combine(SaveDirectory, filename);
+}
+
+/**
+ * Gets the view projection matrix of the camera at its capture resolution.
+ * The aspect ratio follows CaptureWidth and CaptureHeight, so projected points match the captured image.
+ *
+ * @param OutViewProjectionMatrix The view projection matrix.
+ * @return True if the matrix was computed, false otherwise.
+ */
+bool ACamera::GetCaptureViewProjection(FMatrix& OutViewProjectionMatrix) const
+{
+	UCameraComponent* cameraComponent = GetCameraComponent();
+	if (!cameraComponent)
+	{
+		UE_LOG(LogTemp, Error, TEXT("CameraComponent is null in GetCaptureViewProjection."));
+		return false;
+	}
+
+	FMinimalViewInfo viewInfo;
+	cameraComponent->GetCameraView(0.0f, viewInfo);
+	if (CaptureWidth > 0 && CaptureHeight > 0)
+	{
+		viewInfo.AspectRatio = (float)CaptureWidth / CaptureHeight;
+		viewInfo.bConstrainAspectRatio = true;
+	}
+
+	FMatrix viewMatrix;
+	FMatrix projectionMatrix;
+	UGameplayStatics::GetViewProjectionMatrix(viewInfo, viewMatrix, projectionMatrix, OutViewProjectionMatrix);
+	return true;
+}
+
 /**
  * Handles automatic actions such as taking screenshots.
  * Decrements the countdown timer and triggers a screenshot when the timer reaches zero.
@@ -37,10 +37,29 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Screenshot details")
 	FString SaveDirectory;
 
+	/** Scene capture rendering the camera's view into its render target. */
+	UPROPERTY(VisibleAnywhere, Category = "Camera components")
+	class USceneCaptureComponent2D* SceneCapture;
+
+	/** Width of the captured image, in pixels. */
+	UPROPERTY(EditAnywhere, Category = "Screenshot details")
+	int CaptureWidth = 1920;
+
+	/** Height of the captured image, in pixels. */
+	UPROPERTY(EditAnywhere, Category = "Screenshot details")
+	int CaptureHeight = 1080;
+
 private:
 	/** Internal countdown timer for automatic screenshots. */
 	float _ScreenshotCountdown;
 
+	/** Render target the scene capture renders into, created on first capture. */
+	UPROPERTY()
+	class UTextureRenderTarget2D* _RenderTarget = nullptr;
+
+	/** Path of the last screenshot requested by TakeScreenshot. */
+	FString _LastScreenshotFilepath;
+
 public:
 	/**
 	 * Called every frame to update the camera.
@@ -48,6 +67,20 @@ public:
 	 */
 	virtual void Tick(float DeltaTime) override;
 
+	/**
+	 * Called after the actor's components are initialized.
+	 * Registers the camera with the traffic registry before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the camera from the traffic registry.
+	 *
+	 * @param EndPlayReason The reason the actor is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Called when the actor is constructed or properties are changed in the editor.
 	 * @param Transform The transform of the actor.
@@ -60,6 +93,49 @@ public:
 	UFUNCTION()
 	void TakeScreenshot();
 
+	/**
+	 * Renders the camera's view into its render target.
+	 * The pixels are available once the render thread has processed the capture.
+	 *
+	 * @return True if the capture was queued, false otherwise.
+	 */
+	bool CaptureToRenderTarget();
+
+	/**
+	 * Creates the path of a new screenshot file in the save directory.
+	 *
+	 * @return The path of the screenshot file.
+	 */
+	FString CreateScreenshotFilepath() const;
+
+	/**
+	 * Gets the view projection matrix of the camera at its capture resolution.
+	 *
+	 * @param OutViewProjectionMatrix The view projection matrix.
+	 * @return True if the matrix was computed, false otherwise.
+	 */
+	bool GetCaptureViewProjection(FMatrix& OutViewProjectionMatrix) const;
+
+	/**
+	 * Gets the path of the last screenshot requested by TakeScreenshot.
+	 *
+	 * @return The path of the screenshot file.
+	 */
+	FORCEINLINE const FString& GetLastScreenshotFilepath() const
+	{
+		return _LastScreenshotFilepath;
+	}
+
+	/**
+	 * Gets the render target the camera captures into.
+	 *
+	 * @return A pointer to the render target, or nullptr if the camera has not captured yet.
+	 */
+	FORCEINLINE class UTextureRenderTarget2D* GetRenderTarget() const
+	{
+		return _RenderTarget;
+	}
+
 protected:
 	/**
 	 * Handles automatic actions such as taking screenshots.
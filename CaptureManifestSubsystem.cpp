@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CaptureManifestSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/Archive.h"
+
+// Static member initialization
+const FString UCaptureManifestSubsystem::ManifestDirPath = FPaths::ProjectDir() + "Screenshots/";
+const FString UCaptureManifestSubsystem::ManifestFileName = "Manifest.csv";
+const int32 UCaptureManifestSubsystem::RowsPerFlush = 64;
+
+/** Number of bytes read from the end of the manifest to find the last row. */
+static const int64 ManifestTailSize = 4096;
+
+/**
+ * Quotes a CSV field, doubling the quotes inside it.
+ *
+ * @param Field The field to quote.
+ * @return The quoted field.
+ */
+static FString QuoteCsvField(const FString& Field)
+{
+	return TEXT("\"") + Field.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+}
+
+/**
+ * Sets the hash of the simulation configuration recorded with every capture of the run.
+ *
+ * @param ConfigHash The hash of the simulation configuration.
+ */
+void UCaptureManifestSubsystem::SetConfigHash(uint32 ConfigHash)
+{
+	_ConfigHash = ConfigHash;
+}
+
+/**
+ * Hands out the next frame id for a capture and records it in the manifest.
+ * The file is named by the zero padded frame id, so file names sort in capture order.
+ *
+ * @param CameraName The name of the capturing camera.
+ * @param SaveDirectory The directory the capture is saved to.
+ * @return The path of the capture file.
+ */
+FString UCaptureManifestSubsystem::AddCapture(const FString& CameraName, const FString& SaveDirectory)
+{
+	if (!_IsStarted)
+	{
+		_Start();
+	}
+
+	_LastFrameId++;
+	FString filepath = FPaths::Combine(SaveDirectory, FString::Printf(TEXT("%09lld.png"), _LastFrameId));
+
+	FString relativePath = filepath;
+	FPaths::MakePathRelativeTo(relativePath, *ManifestDirPath);
+
+	UWorld* world = GetWorld();
+	double simTime = world ? world->GetTimeSeconds() : 0.0;
+	_PendingRows += FString::Printf(TEXT("%lld,%s,%.4f,%s,%08x,%s"),
+		_LastFrameId, *_RunId, simTime, *QuoteCsvField(CameraName), _ConfigHash, *QuoteCsvField(relativePath));
+	_PendingRows += LINE_TERMINATOR;
+	_PendingRowsCount++;
+
+	if (_PendingRowsCount >= RowsPerFlush)
+	{
+		Flush();
+	}
+
+	return filepath;
+}
+
+/**
+ * Appends the buffered rows to the manifest.
+ */
+void UCaptureManifestSubsystem::Flush()
+{
+	if (_PendingRowsCount <= 0)
+	{
+		return;
+	}
+
+	FString manifestFilePath = ManifestDirPath + ManifestFileName;
+	if (!FFileHelper::SaveStringToFile(_PendingRows, *manifestFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+		&IFileManager::Get(), FILEWRITE_Append))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to append to capture manifest: %s"), *manifestFilePath);
+	}
+
+	_PendingRows.Reset();
+	_PendingRowsCount = 0;
+}
+
+/**
+ * Called when the world is torn down. Appends the buffered rows.
+ */
+void UCaptureManifestSubsystem::Deinitialize()
+{
+	Flush();
+
+	Super::Deinitialize();
+}
+
+/**
+ * Reads the last frame id from the manifest and writes the header if the manifest does not exist yet.
+ */
+void UCaptureManifestSubsystem::_Start()
+{
+	_IsStarted = true;
+	_RunId = FDateTime::Now().ToString(TEXT("%Y%m%d%H%M%S"));
+
+	FString manifestFilePath = ManifestDirPath + ManifestFileName;
+	if (!IFileManager::Get().FileExists(*manifestFilePath))
+	{
+		FString header = TEXT("FrameId,RunId,SimTime,Camera,ConfigHash,File");
+		header += LINE_TERMINATOR;
+		if (!FFileHelper::SaveStringToFile(header, *manifestFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to create capture manifest: %s"), *manifestFilePath);
+		}
+		return;
+	}
+
+	int64 lastFrameId = -1;
+	if (_ReadLastFrameId(manifestFilePath, lastFrameId))
+	{
+		_LastFrameId = lastFrameId;
+		UE_LOG(LogTemp, Log, TEXT("Capture manifest %s resumed after frame %lld."), *manifestFilePath, _LastFrameId);
+	}
+}
+
+/**
+ * Reads the id of the last row of the manifest from the end of the file.
+ * Only the tail of the file is read, so resuming does not depend on the size of the manifest.
+ *
+ * @param ManifestFilePath The path of the manifest.
+ * @param OutFrameId The id of the last row.
+ * @return True if a row was found, false otherwise.
+ */
+bool UCaptureManifestSubsystem::_ReadLastFrameId(const FString& ManifestFilePath, int64& OutFrameId)
+{
+	TUniquePtr<FArchive> reader(IFileManager::Get().CreateFileReader(*ManifestFilePath));
+	if (!reader)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open capture manifest: %s"), *ManifestFilePath);
+		return false;
+	}
+
+	int64 totalSize = reader->TotalSize();
+	int64 tailSize = FMath::Min(totalSize, ManifestTailSize);
+	TArray<uint8> tail;
+	tail.SetNumUninitialized(tailSize + 1);
+	reader->Seek(totalSize - tailSize);
+	reader->Serialize(tail.GetData(), tailSize);
+	tail[tailSize] = 0;
+
+	FString tailString = UTF8_TO_TCHAR((const ANSICHAR*)tail.GetData());
+	TArray<FString> lines;
+	tailString.ParseIntoArrayLines(lines);
+
+	// The first line of the tail may be cut off, and the header has no numeric id
+	for (int32 i = lines.Num() - 1; i >= 0; i--)
+	{
+		FString idField;
+		if (!lines[i].Split(TEXT(","), &idField, nullptr) || !idField.IsNumeric())
+		{
+			continue;
+		}
+
+		OutFrameId = FCString::Atoi64(*idField);
+		return true;
+	}
+
+	return false;
+}
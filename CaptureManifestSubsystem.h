@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CaptureManifestSubsystem.generated.h"
+
+/**
+ * UCaptureManifestSubsystem hands out screenshot file names and indexes them in a manifest.
+ * Every capture gets a frame id that increases monotonically across cameras and runs, the file is named by it,
+ * and a row mapping the frame id to the run, simulation time, camera, configuration hash and file is appended
+ * to a CSV manifest. Rows are buffered and appended in batches. A new run continues after the last frame id
+ * in the manifest, which is read from the end of the file, so existing captures are never overwritten.
+ */
+UCLASS()
+class TSTOOLKIT_API UCaptureManifestSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Directory path where the manifest is stored, screenshot paths in the manifest are relative to it. */
+	static const FString ManifestDirPath;
+
+	/** Name of the manifest file. */
+	static const FString ManifestFileName;
+
+	/** Number of rows buffered before they are appended to the manifest. */
+	static const int32 RowsPerFlush;
+
+private:
+	/** Indicates whether the last frame id was read from the manifest. */
+	bool _IsStarted = false;
+
+	/** Id of the last frame handed out. */
+	int64 _LastFrameId = -1;
+
+	/** Id of the current run, the time the first frame of the run was captured. */
+	FString _RunId;
+
+	/** Hash of the simulation configuration of the run. */
+	uint32 _ConfigHash = 0;
+
+	/** Rows not yet appended to the manifest. */
+	FString _PendingRows;
+
+	/** Number of rows in _PendingRows. */
+	int32 _PendingRowsCount = 0;
+
+public:
+	/**
+	 * Sets the hash of the simulation configuration recorded with every capture of the run.
+	 *
+	 * @param ConfigHash The hash of the simulation configuration.
+	 */
+	void SetConfigHash(uint32 ConfigHash);
+
+	/**
+	 * Hands out the next frame id for a capture and records it in the manifest.
+	 *
+	 * @param CameraName The name of the capturing camera.
+	 * @param SaveDirectory The directory the capture is saved to.
+	 * @return The path of the capture file.
+	 */
+	FString AddCapture(const FString& CameraName, const FString& SaveDirectory);
+
+	/**
+	 * Appends the buffered rows to the manifest.
+	 */
+	void Flush();
+
+	/**
+	 * Called when the world is torn down. Appends the buffered rows.
+	 */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Gets the id of the last frame handed out.
+	 *
+	 * @return The last frame id, or -1 if no frame was captured yet.
+	 */
+	FORCEINLINE int64 GetLastFrameId() const
+	{
+		return _LastFrameId;
+	}
+
+private:
+	/**
+	 * Reads the last frame id from the manifest and writes the header if the manifest does not exist yet.
+	 */
+	void _Start();
+
+	/**
+	 * Reads the id of the last row of the manifest from the end of the file.
+	 *
+	 * @param ManifestFilePath The path of the manifest.
+	 * @param OutFrameId The id of the last row.
+	 * @return True if a row was found, false otherwise.
+	 */
+	static bool _ReadLastFrameId(const FString& ManifestFilePath, int64& OutFrameId);
+};
@@ -6,12 +6,16 @@
 #include "Components/BoxComponent.h"
 #include "Components/SplineComponent.h"
 #include "Components/SpotLightComponent.h"
+#include "Engine/StaticMesh.h"
 #include "CarPath.h"
 #include "TrafficLights.h"
-#include "Kismet/KismetMathLibrary.h"
+#include "TrafficManager.h"
+#include "CarSpawnController.h"
+#include "TelemetrySubsystem.h"
 
 #define MAX_MOVEMENT_PRIORITY 1000000000
 #define PATH_VARIATION_HALF_RANGE 20
+#define STOPPED_SPEED_THRESHOLD 1.0f
 
 /**
  * Constructor for ACar.
@@ -46,6 +50,7 @@ ACar::ACar()
 	_LastTrafficLights = nullptr;
 	_Path = nullptr;
 
+	_RandomStream.GenerateNewSeed();
 	_SetMovementPriority();
 }
 
@@ -71,9 +76,27 @@ void ACar::BeginPlay()
 	CarBoxRoot->OnComponentEndOverlap.AddDynamic(this, &ACar::_OnRootBoxEndOverlap);
 }
 
+/**
+ * Called when the car is being removed from the level.
+ * Unregisters the car from its traffic manager.
+ *
+ * @param EndPlayReason The reason the car is being removed.
+ */
+void ACar::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (_TrafficManager)
+	{
+		_TrafficManager->UnregisterCar(this);
+	}
+
+	_LeaveTrafficControls();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 /**
  * Called every frame to update the car's behavior.
- * Handles movement, path following, and critical zone interactions.
+ * Handles movement and path following.
  *
  * @param DeltaTime The time elapsed since the last frame.
  */
@@ -83,7 +106,7 @@ void ACar::Tick(float DeltaTime)
 
 	if (_ReachedDestination)
 	{
-		K2_DestroyActor();
+		Despawn();
 		return;
 	}
 
@@ -94,74 +117,377 @@ void ACar::Tick(float DeltaTime)
 			UE_LOG(LogTemp, Error, TEXT("Path for a car is nullptr in Tick."));
 			return;
 		}
-		_MoveAlongSpline(_Path->Path, StaticSpeed, DeltaTime);
+		_MoveAlongSpline(_Path, StaticSpeed, DeltaTime);
 	}
+}
+
+/**
+ * Called to bind functionality to input.
+ *
+ * @param PlayerInputComponent The input component to bind to.
+ */
+void ACar::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
+{
+	Super::SetupPlayerInputComponent(PlayerInputComponent);
+}
+
+/**
+ * Turns the car's lights on.
+ */
+void ACar::TurnLightsOn()
+{
+	_IsLightsOn = true;
+	_UpdateLightComponents();
+}
 
-	if (!_WaitingForCriticalZone)
+/**
+ * Turns the car's lights off.
+ */
+void ACar::TurnLightsOff()
+{
+	_IsLightsOn = false;
+	_UpdateLightComponents();
+}
+
+/**
+ * Sets whether the car's lights use the spotlight components or only the emissive headlight proxy.
+ * Nothing changes if the car already uses the requested lights.
+ *
+ * @param bUse True to use the spotlights, false to use only the proxy.
+ */
+void ACar::SetUseSpotLights(bool bUse)
+{
+	if (_UseSpotLights == bUse)
 	{
 		return;
 	}
 
-	if (!_CurrentCriticalZone)
+	_UseSpotLights = bUse;
+	if (_IsLightsOn)
+	{
+		_UpdateLightComponents();
+	}
+}
+
+/**
+ * Sets whether the car is rendered at full quality.
+ * Insignificant cars use their lowest LOD, cast no shadows, hide their spotlights and tick less often.
+ * Nothing changes if the car already has the requested significance.
+ *
+ * @param bSignificant True for full quality, false for reduced quality.
+ */
+void ACar::SetSignificant(bool bSignificant)
+{
+	if (_IsSignificant == bSignificant)
 	{
-		_WaitingForCriticalZone = false;
 		return;
 	}
 
-	if (_CurrentCriticalZone->IsReserved())
+	_IsSignificant = bSignificant;
+	SetActorTickInterval(bSignificant ? 0.0f : InsignificantTickInterval);
+
+	if (CarMeshComponent)
 	{
+		// A forced LOD of zero lets the engine pick the LOD, N forces LOD N - 1
+		UStaticMesh* mesh = CarMeshComponent->GetStaticMesh();
+		CarMeshComponent->SetForcedLodModel((bSignificant || !mesh) ? 0 : mesh->GetNumLODs());
+		CarMeshComponent->SetCastShadow(bSignificant);
+	}
+
+	_UpdateLightComponents();
+}
+
+/**
+ * Shows the spotlights if the lights are on, use them and the car is significant, and drives the emissive headlight proxy.
+ * A managed car is also switched between its own mesh and an instanced mesh by its traffic manager.
+ */
+void ACar::_UpdateLightComponents()
+{
+	if (!LeftSpotLight || !LeftSpotLightEffect || !RightSpotLight || !RightSpotLightEffect)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SpotLight components are null in _UpdateLightComponents."));
 		return;
 	}
-	else
+
+	bool spotLightsVisible = _IsLightsOn && _UseSpotLights && _IsSignificant;
+	LeftSpotLight->SetVisibility(spotLightsVisible);
+	LeftSpotLightEffect->SetVisibility(spotLightsVisible);
+	RightSpotLight->SetVisibility(spotLightsVisible);
+	RightSpotLightEffect->SetVisibility(spotLightsVisible);
+
+	if (CarMeshComponent && !HeadlightEmissiveParameterName.IsNone())
 	{
-		_ReserveCriticalZone(_CurrentCriticalZone);
+		CarMeshComponent->SetScalarParameterValueOnMaterials(HeadlightEmissiveParameterName, _IsLightsOn ? 1.0f : 0.0f);
+	}
+
+	if (_TrafficManager)
+	{
+		_TrafficManager->UpdateCarInstance(this);
 	}
 }
 
 /**
- * Called to bind functionality to input.
+ * Lets the car continue after the traffic lights it is stopped by turned green.
  *
- * @param PlayerInputComponent The input component to bind to.
+ * @param TrafficLights The traffic lights releasing the car.
  */
-void ACar::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
+void ACar::ReleaseFromTrafficLights(ATrafficLights* TrafficLights)
 {
-	Super::SetupPlayerInputComponent(PlayerInputComponent);
+	if (!TrafficLights)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrafficLights is null in ReleaseFromTrafficLights."));
+		return;
+	}
+
+	if (_WaitingTrafficLights == TrafficLights)
+	{
+		_WaitingTrafficLights = nullptr;
+	}
+
+	_LastTrafficLights = TrafficLights;
+	SetCanMove(true);
 }
 
 /**
- * Turns the car's lights on.
+ * Lets the car continue after the critical zone it waits for admitted it.
+ *
+ * @param Zone The critical zone admitting the car.
  */
-void ACar::TurnLightsOn()
+void ACar::AdmitToCriticalZone(ACriticalZone* Zone)
 {
-	if (!LeftSpotLight || !LeftSpotLightEffect || !RightSpotLight || !RightSpotLightEffect)
+	if (!Zone)
 	{
-		UE_LOG(LogTemp, Error, TEXT("SpotLight components are null in TurnLightsOn."));
+		UE_LOG(LogTemp, Error, TEXT("Zone is null in AdmitToCriticalZone."));
 		return;
 	}
 
-	LeftSpotLight->SetVisibility(true);
-	LeftSpotLightEffect->SetVisibility(true);
-	RightSpotLight->SetVisibility(true);
-	RightSpotLightEffect->SetVisibility(true);
-	_IsLightsOn = true;
+	_CurrentCriticalZone = Zone;
+	_SetWaitingForCriticalZone(false);
+	SetCanMove(true);
 }
 
 /**
- * Turns the car's lights off.
+ * Seeds the car's random stream and re-rolls its movement priority and offset.
+ * Must be called before the car is registered with the traffic manager.
+ *
+ * @param Seed The seed of the random stream.
  */
-void ACar::TurnLightsOff()
+void ACar::SetRandomSeed(int32 Seed)
 {
-	if (!LeftSpotLight || !LeftSpotLightEffect || !RightSpotLight || !RightSpotLightEffect)
+	_RandomStream.Initialize(Seed);
+	_SetMovementPriority();
+	_MovementOffset = _CreateRandomOffset();
+}
+
+/**
+ * Removes the car from the simulation after it reached its destination.
+ * The car is returned to its spawn controller's pool, or destroyed if it has none.
+ */
+void ACar::Despawn()
+{
+	UWorld* world = GetWorld();
+	if (UTelemetrySubsystem* telemetry = world ? world->GetSubsystem<UTelemetrySubsystem>() : nullptr)
 	{
-		UE_LOG(LogTemp, Error, TEXT("SpotLight components are null in TurnLightsOff."));
+		telemetry->CountDespawn();
+	}
+
+	if (_SpawnController)
+	{
+		_SpawnController->ReleaseCar(this);
 		return;
 	}
 
-	LeftSpotLight->SetVisibility(false);
-	LeftSpotLightEffect->SetVisibility(false);
-	RightSpotLight->SetVisibility(false);
-	RightSpotLightEffect->SetVisibility(false);
-	_IsLightsOn = false;
+	K2_DestroyActor();
+}
+
+/**
+ * Resets the car's behavioral state and makes it visible and collidable again.
+ * Called when the car is reused from a pool.
+ */
+void ACar::ActivateFromPool()
+{
+	_LastTrafficLights = nullptr;
+	_CollisionHandlingState = false;
+	_WaitingForCriticalZone = false;
+	_CurrentCriticalZone = nullptr;
+	_WaitingTrafficLights = nullptr;
+	_ReachedDestination = false;
+	_CanMove = true;
+	_DistanceAlongSpline = 0;
+	_SetMovementPriority();
+	_MovementOffset = _CreateRandomOffset();
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+	SetSignificant(true);
+}
+
+/**
+ * Hides the car, disables its collision and tick and detaches it from the traffic manager.
+ * Called when the car is returned to a pool.
+ */
+void ACar::DeactivateToPool()
+{
+	if (_TrafficManager)
+	{
+		_TrafficManager->UnregisterCar(this);
+	}
+
+	_LeaveTrafficControls();
+
+	TurnLightsOff();
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	_Path = nullptr;
+}
+
+/**
+ * Gets the distance the car has traveled along the spline.
+ * Managed cars read the distance from their traffic manager.
+ *
+ * @return The distance along the spline.
+ */
+float ACar::GetDistanceAlongSpline() const
+{
+	return _TrafficManager
+		? _TrafficManager->GetCarDistance(_TrafficIndex)
+		: _DistanceAlongSpline;
+}
+
+/**
+ * Gets how far in front of the car's origin the safe distance box reaches.
+ *
+ * @return The reach of the safe distance box along the car's forward axis.
+ */
+float ACar::GetSafeDistanceReach() const
+{
+	if (!SafeDistanceBox)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SafeDistanceBox is null in GetSafeDistanceReach."));
+		return 0.0f;
+	}
+
+	FVector localCenter = GetActorTransform().InverseTransformPosition(SafeDistanceBox->GetComponentLocation());
+	return localCenter.X + SafeDistanceBox->GetScaledBoxExtent().X;
+}
+
+/**
+ * Gets the half extent of the car's body box.
+ *
+ * @return The scaled half extent of the car's root box.
+ */
+FVector ACar::GetBodyHalfExtent() const
+{
+	if (!CarBoxRoot)
+	{
+		UE_LOG(LogTemp, Error, TEXT("CarBoxRoot is null in GetBodyHalfExtent."));
+		return FVector::ZeroVector;
+	}
+
+	return CarBoxRoot->GetScaledBoxExtent();
+}
+
+/**
+ * Enables or disables overlap events between this car and other cars.
+ * The car boxes are moved to the vehicle object channel, so ignoring that channel only drops car-to-car pairs
+ * while overlaps with traffic lights, critical zones, sinks and sources are kept.
+ *
+ * @param bEnabled True to overlap other cars, false to ignore them.
+ */
+void ACar::SetCarOverlapsEnabled(bool bEnabled)
+{
+	if (!SafeDistanceBox || !CarBoxRoot)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SafeDistanceBox or CarBoxRoot is null in SetCarOverlapsEnabled."));
+		return;
+	}
+
+	ECollisionResponse response = bEnabled ? ECR_Overlap : ECR_Ignore;
+	for (UBoxComponent* box : { SafeDistanceBox, CarBoxRoot })
+	{
+		box->SetCollisionObjectType(ECC_Vehicle);
+		box->SetCollisionResponseToChannel(ECC_Vehicle, response);
+	}
+}
+
+/**
+ * Sets whether the car can move.
+ * The state is mirrored to the traffic manager if the car is managed.
+ *
+ * @param NewState True if the car can move, false otherwise.
+ */
+void ACar::SetCanMove(bool NewState)
+{
+	_CanMove = NewState;
+	if (_TrafficManager)
+	{
+		_TrafficManager->SetCarFlag(_TrafficIndex, ETrafficCarFlags::CanMove, NewState);
+	}
+}
+
+/**
+ * Sets whether the car has reached its destination.
+ * The state is mirrored to the traffic manager if the car is managed.
+ *
+ * @param NewValue True if the car has reached its destination, false otherwise.
+ */
+void ACar::SetReachedDestination(bool NewValue)
+{
+	_ReachedDestination = NewValue;
+	if (_TrafficManager)
+	{
+		_TrafficManager->SetCarFlag(_TrafficIndex, ETrafficCarFlags::ReachedDestination, NewValue);
+	}
+}
+
+/**
+ * Sets whether the car is waiting for a critical zone.
+ * The state is mirrored to the traffic manager if the car is managed.
+ *
+ * @param NewState True if the car is waiting, false otherwise.
+ */
+void ACar::_SetWaitingForCriticalZone(bool NewState)
+{
+	_WaitingForCriticalZone = NewState;
+	if (_TrafficManager)
+	{
+		_TrafficManager->SetCarFlag(_TrafficIndex, ETrafficCarFlags::WaitingForCriticalZone, NewState);
+	}
+}
+
+/**
+ * Checks whether the car is stopped or waiting for traffic lights, a critical zone or another car.
+ * With the car following model red lights and zones no longer clear CanMove, so the waiting lists
+ * and the speed reported by the traffic manager, which is zero for blocked cars, are checked as well.
+ *
+ * @return True if the car is stopped or waiting, false if it is moving.
+ */
+bool ACar::IsStopped() const
+{
+	if (!_CanMove || _WaitingTrafficLights || _WaitingForCriticalZone)
+	{
+		return true;
+	}
+
+	if (_TrafficManager && _TrafficIndex != INDEX_NONE)
+	{
+		return _TrafficManager->GetCarSpeed(_TrafficIndex) <= STOPPED_SPEED_THRESHOLD;
+	}
+
+	return false;
+}
+
+/**
+ * Checks whether the car brakes at the stop lines of its traffic manager's car following model.
+ * The safe box reaches lights and zones before their stop lines, so the overlap only keeps the waiting lists.
+ *
+ * @return True if red lights and reserved zones are handled by the stop lines, false if the car stops on overlap.
+ */
+bool ACar::_IsStoppedAtStopLines() const
+{
+	return _TrafficManager && _TrafficManager->IsCarFollowingModelActive();
 }
 
 /**
@@ -180,25 +506,26 @@ void ACar::_MoveToLocation(FVector Location, float Speed, float DeltaTime)
 }
 
 /**
- * Moves the car along a spline.
+ * Moves the car along a path.
+ * Positions are read from the path's baked lookup table.
  *
- * @param Spline The spline component to follow.
+ * @param CarPath The path to follow.
  * @param Speed The speed of movement.
  * @param DeltaTime The time elapsed since the last frame.
  */
-void ACar::_MoveAlongSpline(USplineComponent* Spline, float Speed, float DeltaTime)
+void ACar::_MoveAlongSpline(ACarPath* CarPath, float Speed, float DeltaTime)
 {
-	if (!Spline)
+	if (!CarPath || !CarPath->Path)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Spline is null in _MoveAlongSpline."));
+		UE_LOG(LogTemp, Error, TEXT("Path is null in _MoveAlongSpline."));
 		return;
 	}
 
 	float newDistance = _DistanceAlongSpline + Speed * DeltaTime;
-	FVector newLocation = Spline->GetLocationAtDistanceAlongSpline(newDistance, ESplineCoordinateSpace::World) + _MovementOffset;
-	FRotator newRotation = Spline->GetRotationAtDistanceAlongSpline(newDistance, ESplineCoordinateSpace::World);
-	SetActorLocation(newLocation);
-	SetActorRotation(newRotation);
+	FVector newLocation;
+	FRotator newRotation;
+	CarPath->GetTransformAtDistance(newDistance, newLocation, newRotation);
+	SetActorLocationAndRotation(newLocation + _MovementOffset, newRotation);
 	_DistanceAlongSpline = newDistance;
 }
 
@@ -218,13 +545,18 @@ void ACar::_HandleTrafficLightsBegin(ATrafficLights* TrafficLights)
 	if (TrafficLights->IsGreen())
 	{
 		_LastTrafficLights = TrafficLights;
-		_CanMove = true;
+		SetCanMove(true);
 		return;
 	}
 
 	if (TrafficLights->IsRed() && TrafficLights != _LastTrafficLights)
 	{
-		_CanMove = false;
+		_WaitingTrafficLights = TrafficLights;
+		TrafficLights->AddWaitingCar(this);
+		if (!_IsStoppedAtStopLines())
+		{
+			SetCanMove(false);
+		}
 	}
 }
 
@@ -244,24 +576,24 @@ void ACar::_HandleCollisionBegin(ACar* OtherCar, UPrimitiveComponent* OtherComp)
 
 	if (_CollisionHandlingState)
 	{
-		_CanMove = true;
+		SetCanMove(true);
 		return;
 	}
 
 	if (OtherComp != OtherCar->SafeDistanceBox)
 	{
-		_CanMove = false;
+		SetCanMove(false);
 		return;
 	}
 
 	if (_MovementPriority < OtherCar->GetMovementPriority())
 	{
 		_CollisionHandlingState = true;
-		_CanMove = true;
+		SetCanMove(true);
 	}
 	else
 	{
-		_CanMove = false;
+		SetCanMove(false);
 	}
 }
 
@@ -279,7 +611,7 @@ void ACar::_HandleCollisionEnd(ACar* OtherCar, UPrimitiveComponent* OtherComp)
 		return;
 	}
 
-	_CanMove = true;
+	SetCanMove(true);
 	_CollisionHandlingState = false;
 }
 
@@ -296,15 +628,16 @@ void ACar::_HandleCollisionCriticalZoneBegin(ACriticalZone* Zone)
 		return;
 	}
 
-	if (Zone->IsReserved() && !Zone->IsReservedForPath(_Path))
+	_CurrentCriticalZone = Zone;
+	if (!Zone->TryEnter(this))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Critical zone is reserved. Waiting for reservation to end."));
-		_CurrentCriticalZone = Zone;
-		_WaitingForCriticalZone = true;
-		_CanMove = false;
-		return;
+		UE_LOG(LogTemp, Verbose, TEXT("Critical zone is reserved. Waiting for reservation to end."));
+		_SetWaitingForCriticalZone(true);
+		if (!_IsStoppedAtStopLines())
+		{
+			SetCanMove(false);
+		}
 	}
-	_ReserveCriticalZone(Zone);
 }
 
 /**
@@ -320,77 +653,51 @@ void ACar::_HandleCollisionCriticalZoneEnd(ACriticalZone* Zone)
 		return;
 	}
 
-	if (!Zone->IsReserved())
-	{
-		return;
-	}
-
-	Zone->TryEndReservation();
-	_CanMove = true;
-}
-
-/**
- * Reserves a critical zone for the car.
- *
- * @param Zone The critical zone to reserve.
- */
-void ACar::_ReserveCriticalZone(ACriticalZone* Zone)
-{
-	if (!Zone)
-	{
-		UE_LOG(LogTemp, Error, TEXT("Zone is null in _ReserveCriticalZone."));
-		return;
-	}
-
-	if (Zone->IsReserved())
+	Zone->Leave(this);
+	if (_CurrentCriticalZone == Zone)
 	{
-		return;
+		_CurrentCriticalZone = nullptr;
 	}
-
-	Zone->SetReserved(_Path);
-	_WaitingForCriticalZone = false;
-	_CanMove = true;
 }
 
 /**
- * Ends the reservation of a critical zone.
- *
- * @param Zone The critical zone to release.
+ * Leaves the critical zone and traffic lights the car is registered with.
+ * Called when the car leaves the simulation so that it is not notified after being reused.
  */
-void ACar::_EndCriticalZoneReservation(ACriticalZone* Zone)
+void ACar::_LeaveTrafficControls()
 {
-	if (!Zone)
+	if (_CurrentCriticalZone)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Zone is null in _EndCriticalZoneReservation."));
-		return;
+		_CurrentCriticalZone->Leave(this);
+		_CurrentCriticalZone = nullptr;
 	}
 
-	if (!Zone->IsReserved())
+	if (_WaitingTrafficLights)
 	{
-		return;
+		_WaitingTrafficLights->RemoveWaitingCar(this);
+		_WaitingTrafficLights = nullptr;
 	}
 
-	Zone->SetReserved(nullptr);
-	_CanMove = true;
+	_SetWaitingForCriticalZone(false);
 }
 
 /**
- * Sets the movement priority of the car to a random value.
+ * Sets the movement priority of the car to a random value drawn from its random stream.
  */
 void ACar::_SetMovementPriority()
 {
-	_MovementPriority = UKismetMathLibrary::RandomInteger(MAX_MOVEMENT_PRIORITY);
+	_MovementPriority = _RandomStream.RandHelper(MAX_MOVEMENT_PRIORITY);
 }
 
 /**
- * Creates a random offset for the car's movement.
+ * Creates a random offset for the car's movement drawn from its random stream.
  *
  * @return A random offset vector.
  */
 FVector ACar::_CreateRandomOffset()
 {
-	return FVector(FMath::RandRange(-PATH_VARIATION_HALF_RANGE, PATH_VARIATION_HALF_RANGE),
-		FMath::RandRange(-PATH_VARIATION_HALF_RANGE, PATH_VARIATION_HALF_RANGE), 0.0f);
+	return FVector(_RandomStream.RandRange(-PATH_VARIATION_HALF_RANGE, PATH_VARIATION_HALF_RANGE),
+		_RandomStream.RandRange(-PATH_VARIATION_HALF_RANGE, PATH_VARIATION_HALF_RANGE), 0.0f);
 }
 
 /**
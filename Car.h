@@ -58,10 +58,40 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Car Details")
 	float StaticSpeed = 50;
 
+	/** Maximum acceleration of the car in the car following model, in units per second squared. */
+	UPROPERTY(EditAnywhere, Category = "Car Details")
+	float MaxAcceleration = 100.0f;
+
+	/** Comfortable deceleration of the car in the car following model, in units per second squared. */
+	UPROPERTY(EditAnywhere, Category = "Car Details")
+	float ComfortableDeceleration = 150.0f;
+
+	/** Gap the car keeps to a standing car or a closed stop line in the car following model, in units. */
+	UPROPERTY(EditAnywhere, Category = "Car Details")
+	float MinimumGap = 100.0f;
+
+	/** Time gap the car keeps to the car in front in the car following model, in seconds. */
+	UPROPERTY(EditAnywhere, Category = "Car Details")
+	float TimeHeadway = 1.0f;
+
+	/** Scalar material parameter set to 1 while the lights are on, used as the headlight proxy without spotlights. */
+	UPROPERTY(EditAnywhere, Category = "Car Details")
+	FName HeadlightEmissiveParameterName = TEXT("HeadlightEmissive");
+
+	/** Tick interval of the car while no capture camera sees it, in seconds. */
+	UPROPERTY(EditAnywhere, Category = "Car Details")
+	float InsignificantTickInterval = 0.5f;
+
 protected:
 	/** Indicates whether the car's lights are on. */
 	bool _IsLightsOn = false;
 
+	/** Indicates whether the lights use the spotlight components, or only the emissive headlight proxy. */
+	bool _UseSpotLights = true;
+
+	/** Indicates whether the car is rendered at full quality because a capture camera may see it. */
+	bool _IsSignificant = true;
+
 	// Behavioral attributes
 	/** The last traffic light the car interacted with. */
 	class ATrafficLights* _LastTrafficLights;
@@ -99,12 +129,36 @@ private:
 	/** The critical zone the car is currently in. */
 	ACriticalZone* _CurrentCriticalZone = nullptr;
 
+	/** The traffic lights the car is stopped by, or nullptr if it is not stopped by any. */
+	class ATrafficLights* _WaitingTrafficLights = nullptr;
+
+	/** The traffic manager advancing this car, or nullptr if the car ticks on its own. */
+	class ATrafficManager* _TrafficManager = nullptr;
+
+	/** Index of the car in the traffic manager's state arrays. */
+	int32 _TrafficIndex = INDEX_NONE;
+
+	/** The spawn controller whose pool the car returns to, or nullptr if the car is destroyed instead. */
+	class ACarSpawnController* _SpawnController = nullptr;
+
+	/** Identifier of the car's current lifetime, assigned each time the car is acquired, or INDEX_NONE. */
+	int32 _CarId = INDEX_NONE;
+
+	/** Random stream driving the car's random behavior. */
+	FRandomStream _RandomStream;
+
 protected:
 	/**
 	 * Called when the game starts or when the car is spawned.
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Called when the car is being removed from the level.
+	 * @param EndPlayReason The reason the car is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	/**
 	 * Called every frame to update the car's behavior.
@@ -128,6 +182,49 @@ public:
 	 */
 	void TurnLightsOff();
 
+	/**
+	 * Sets whether the car's lights use the spotlight components or only the emissive headlight proxy.
+	 * @param bUse True to use the spotlights, false to use only the proxy.
+	 */
+	void SetUseSpotLights(bool bUse);
+
+	/**
+	 * Sets whether the car is rendered at full quality.
+	 * Insignificant cars use their lowest LOD, cast no shadows, hide their spotlights and tick less often.
+	 * @param bSignificant True for full quality, false for reduced quality.
+	 */
+	void SetSignificant(bool bSignificant);
+
+	/**
+	 * Lets the car continue after the traffic lights it is stopped by turned green.
+	 * @param TrafficLights The traffic lights releasing the car.
+	 */
+	void ReleaseFromTrafficLights(class ATrafficLights* TrafficLights);
+
+	/**
+	 * Lets the car continue after the critical zone it waits for admitted it.
+	 * @param Zone The critical zone admitting the car.
+	 */
+	void AdmitToCriticalZone(ACriticalZone* Zone);
+
+	/**
+	 * Removes the car from the simulation after it reached its destination.
+	 * The car is returned to its spawn controller's pool, or destroyed if it has none.
+	 */
+	void Despawn();
+
+	/**
+	 * Resets the car's behavioral state and makes it visible and collidable again.
+	 * Called when the car is reused from a pool.
+	 */
+	void ActivateFromPool();
+
+	/**
+	 * Hides the car, disables its collision and tick and detaches it from the traffic manager.
+	 * Called when the car is returned to a pool.
+	 */
+	void DeactivateToPool();
+
 	// Inline getters
 	/**
 	 * Gets whether the car's lights are on.
@@ -138,6 +235,24 @@ public:
 		return _IsLightsOn;
 	}
 
+	/**
+	 * Gets whether the car's lights use the spotlight components.
+	 * @return True if the spotlights are used, false if only the emissive proxy is used.
+	 */
+	FORCEINLINE bool GetUseSpotLights() const
+	{
+		return _UseSpotLights;
+	}
+
+	/**
+	 * Gets whether the car is rendered at full quality.
+	 * @return True if the car is significant, false otherwise.
+	 */
+	FORCEINLINE bool IsSignificant() const
+	{
+		return _IsSignificant;
+	}
+
 	/**
 	 * Gets the last traffic light the car interacted with.
 	 * @return A pointer to the last traffic light.
@@ -165,6 +280,83 @@ public:
 		return _Path;
 	}
 
+	/**
+	 * Gets whether the car can move.
+	 * @return True if the car can move, false otherwise.
+	 */
+	FORCEINLINE bool GetCanMove() const
+	{
+		return _CanMove;
+	}
+
+	/**
+	 * Gets whether the car has reached its destination.
+	 * @return True if the car has reached its destination, false otherwise.
+	 */
+	FORCEINLINE bool GetReachedDestination() const
+	{
+		return _ReachedDestination;
+	}
+
+	/**
+	 * Gets whether the car is waiting for a critical zone.
+	 * @return True if the car is waiting, false otherwise.
+	 */
+	FORCEINLINE bool IsWaitingForCriticalZone() const
+	{
+		return _WaitingForCriticalZone;
+	}
+
+	/**
+	 * Checks whether the car is stopped or waiting for traffic lights, a critical zone or another car.
+	 * Unlike GetCanMove it also covers cars braked to a standstill by the car following model.
+	 * @return True if the car is stopped or waiting, false if it is moving.
+	 */
+	bool IsStopped() const;
+
+	/**
+	 * Gets the offset of the car from its path.
+	 * @return The movement offset.
+	 */
+	FORCEINLINE FVector GetMovementOffset() const
+	{
+		return _MovementOffset;
+	}
+
+	/**
+	 * Gets the index of the car in the traffic manager.
+	 * @return The traffic index, or INDEX_NONE if the car is not managed.
+	 */
+	FORCEINLINE int32 GetTrafficIndex() const
+	{
+		return _TrafficIndex;
+	}
+
+	/**
+	 * Gets the distance the car has traveled along the spline.
+	 * @return The distance along the spline.
+	 */
+	float GetDistanceAlongSpline() const;
+
+	/**
+	 * Gets how far in front of the car's origin the safe distance box reaches.
+	 * @return The reach of the safe distance box along the car's forward axis.
+	 */
+	float GetSafeDistanceReach() const;
+
+	/**
+	 * Gets the half extent of the car's body box.
+	 * @return The scaled half extent of the car's root box.
+	 */
+	FVector GetBodyHalfExtent() const;
+
+	/**
+	 * Enables or disables overlap events between this car and other cars.
+	 * Overlaps with traffic lights, critical zones, sinks and sources are kept.
+	 * @param bEnabled True to overlap other cars, false to ignore them.
+	 */
+	void SetCarOverlapsEnabled(bool bEnabled);
+
 	// Inline setters
 	/**
 	 * Sets the initial distance the car has traveled along the spline.
@@ -194,23 +386,62 @@ public:
 	}
 
 	/**
-	 * Sets whether the car can move.
-	 * @param NewState True if the car can move, false otherwise.
+	 * Seeds the car's random stream and re-rolls its movement priority and offset.
+	 * @param Seed The seed of the random stream.
 	 */
-	FORCEINLINE void SetCanMove(bool NewState)
+	void SetRandomSeed(int32 Seed);
+
+	/**
+	 * Sets the spawn controller whose pool the car returns to.
+	 * @param Controller The spawn controller, or nullptr to destroy the car instead.
+	 */
+	FORCEINLINE void SetSpawnController(class ACarSpawnController* Controller)
 	{
-		_CanMove = NewState;
+		_SpawnController = Controller;
 	}
 
 	/**
-	 * Sets whether the car has reached its destination.
-	 * @param NewValue True if the car has reached its destination, false otherwise.
+	 * Sets the identifier of the car's current lifetime.
+	 * @param CarId The identifier, unique among the cars acquired from the spawn controller.
+	 */
+	FORCEINLINE void SetCarId(int32 CarId)
+	{
+		_CarId = CarId;
+	}
+
+	/**
+	 * Gets the identifier of the car's current lifetime.
+	 * Pooled actors are reused for many cars, so unlike the actor name the identifier never repeats.
+	 * @return The identifier, or INDEX_NONE if the car was not acquired from a spawn controller.
+	 */
+	FORCEINLINE int32 GetCarId() const
+	{
+		return _CarId;
+	}
+
+	/**
+	 * Sets the traffic manager advancing this car.
+	 * @param Manager The traffic manager, or nullptr if the car ticks on its own.
+	 * @param Index The index of the car in the manager.
 	 */
-	FORCEINLINE void SetReachedDestination(bool NewValue)
+	FORCEINLINE void SetTrafficHandle(class ATrafficManager* Manager, int32 Index)
 	{
-		_ReachedDestination = NewValue;
+		_TrafficManager = Manager;
+		_TrafficIndex = Index;
 	}
 
+	/**
+	 * Sets whether the car can move.
+	 * @param NewState True if the car can move, false otherwise.
+	 */
+	void SetCanMove(bool NewState);
+
+	/**
+	 * Sets whether the car has reached its destination.
+	 * @param NewValue True if the car has reached its destination, false otherwise.
+	 */
+	void SetReachedDestination(bool NewValue);
+
 protected:
 	/**
 	 * Moves the car to a specified location.
@@ -221,12 +452,18 @@ protected:
 	void _MoveToLocation(FVector Location, float Speed, float DeltaTime);
 
 	/**
-	 * Moves the car along a spline.
-	 * @param Spline The spline component to follow.
+	 * Moves the car along a path.
+	 * @param CarPath The path to follow.
 	 * @param Speed The speed of movement.
 	 * @param DeltaTime The time elapsed since the last frame.
 	 */
-	void _MoveAlongSpline(class USplineComponent* Spline, float Speed, float DeltaTime);
+	void _MoveAlongSpline(class ACarPath* CarPath, float Speed, float DeltaTime);
+
+	/**
+	 * Shows the spotlights if the lights are on, use them and the car is significant, and drives the emissive headlight proxy.
+	 * A managed car is also switched between its own mesh and an instanced mesh by its traffic manager.
+	 */
+	void _UpdateLightComponents();
 
 	/**
 	 * Handles the beginning of interaction with a traffic light.
@@ -261,24 +498,29 @@ protected:
 	void _HandleCollisionCriticalZoneEnd(ACriticalZone* Zone);
 
 	/**
-	 * Reserves a critical zone for the car.
-	 * @param Zone The critical zone to reserve.
+	 * Leaves the critical zone and traffic lights the car is registered with.
+	 */
+	void _LeaveTrafficControls();
+
+	/**
+	 * Sets whether the car is waiting for a critical zone.
+	 * @param NewState True if the car is waiting, false otherwise.
 	 */
-	void _ReserveCriticalZone(ACriticalZone* Zone);
+	void _SetWaitingForCriticalZone(bool NewState);
 
 	/**
-	 * Ends the reservation of a critical zone.
-	 * @param Zone The critical zone to release.
+	 * Checks whether the car brakes at the stop lines of its traffic manager's car following model.
+	 * @return True if red lights and reserved zones are handled by the stop lines, false if the car stops on overlap.
 	 */
-	void _EndCriticalZoneReservation(ACriticalZone* Zone);
+	bool _IsStoppedAtStopLines() const;
 
 	/**
-	 * Sets the movement priority of the car.
+	 * Sets the movement priority of the car from its random stream.
 	 */
 	void _SetMovementPriority();
 
 	/**
-	 * Creates a random offset for the car's movement.
+	 * Creates a random offset for the car's movement from its random stream.
 	 * @return A random offset vector.
 	 */
 	FVector _CreateRandomOffset();
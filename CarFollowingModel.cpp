@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CarFollowingModel.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Math/VectorRegister.h"
+
+// Static member initialization
+const float FCarFollowingModel::NoObstacleGap = 1.0e6f;
+
+/** Lower bound of the divisors of the model, keeps stopped cars and zero gaps finite. */
+static const float MinModelValue = 1.0e-3f;
+
+/** Default number of cars of the TSToolkit.BenchCarFollowing console command. */
+static const int32 DefaultBenchmarkCars = 10000;
+
+/** Default number of steps of the TSToolkit.BenchCarFollowing console command. */
+static const int32 DefaultBenchmarkSteps = 1000;
+
+/**
+ * Advances the speeds of a range of cars by one step and computes the distance they travel.
+ * Full groups of four cars are processed with vector registers, the remaining cars with the scalar kernel.
+ *
+ * @param Batch The per-car arrays.
+ * @param Start The index of the first car of the range.
+ * @param Count The number of cars in the range.
+ * @param DeltaTime The simulated time of the step.
+ */
+void FCarFollowingModel::Step(const FCarFollowingBatch& Batch, int32 Start, int32 Count, float DeltaTime)
+{
+	const VectorRegister4Float zero = VectorZeroFloat();
+	const VectorRegister4Float one = VectorOneFloat();
+	const VectorRegister4Float half = VectorSetFloat1(0.5f);
+	const VectorRegister4Float minValue = VectorSetFloat1(MinModelValue);
+	const VectorRegister4Float deltaTime = VectorSetFloat1(DeltaTime);
+
+	const int32 end = Start + Count;
+	int32 i = Start;
+	for (; i + 4 <= end; i += 4)
+	{
+		VectorRegister4Float speed = VectorLoad(Batch.Speeds + i);
+		VectorRegister4Float desiredSpeed = VectorMax(VectorLoad(Batch.DesiredSpeeds + i), minValue);
+		VectorRegister4Float maxAcceleration = VectorMax(VectorLoad(Batch.MaxAccelerations + i), minValue);
+		VectorRegister4Float comfortableDeceleration = VectorMax(VectorLoad(Batch.ComfortableDecelerations + i), minValue);
+		VectorRegister4Float minimumGap = VectorLoad(Batch.MinimumGaps + i);
+		VectorRegister4Float timeHeadway = VectorLoad(Batch.TimeHeadways + i);
+		VectorRegister4Float gap = VectorMax(VectorLoad(Batch.Gaps + i), minValue);
+		VectorRegister4Float leaderSpeed = VectorLoad(Batch.LeaderSpeeds + i);
+
+		// Desired gap s* = s0 + max(0, v * T + v * dv / (2 * sqrt(a * b)))
+		VectorRegister4Float approachTerm = VectorMultiply(speed, VectorSubtract(speed, leaderSpeed));
+		VectorRegister4Float brakingFactor = VectorMultiply(half, VectorReciprocalSqrt(VectorMultiply(maxAcceleration, comfortableDeceleration)));
+		VectorRegister4Float dynamicGap = VectorMultiplyAdd(speed, timeHeadway, VectorMultiply(approachTerm, brakingFactor));
+		VectorRegister4Float desiredGap = VectorAdd(minimumGap, VectorMax(dynamicGap, zero));
+
+		// Acceleration a * (1 - (v / v0)^4 - (s* / s)^2)
+		VectorRegister4Float speedRatio = VectorDivide(speed, desiredSpeed);
+		speedRatio = VectorMultiply(speedRatio, speedRatio);
+		speedRatio = VectorMultiply(speedRatio, speedRatio);
+		VectorRegister4Float gapRatio = VectorDivide(desiredGap, gap);
+		gapRatio = VectorMultiply(gapRatio, gapRatio);
+		VectorRegister4Float acceleration = VectorMultiply(maxAcceleration, VectorSubtract(VectorSubtract(one, speedRatio), gapRatio));
+
+		// Cars brake to a standstill but never reverse, the distance is the mean speed over the step
+		VectorRegister4Float newSpeed = VectorMax(VectorMultiplyAdd(acceleration, deltaTime, speed), zero);
+		VectorRegister4Float advance = VectorMultiply(VectorMultiply(VectorAdd(speed, newSpeed), half), deltaTime);
+
+		VectorStore(newSpeed, Batch.Speeds + i);
+		VectorStore(advance, Batch.Advances + i);
+	}
+
+	if (i < end)
+	{
+		StepScalar(Batch, i, end - i, DeltaTime);
+	}
+}
+
+/**
+ * Advances the speeds of a range of cars by one step one car at a time.
+ * Reference for the vectorized kernel, which produces the same results up to rounding.
+ *
+ * @param Batch The per-car arrays.
+ * @param Start The index of the first car of the range.
+ * @param Count The number of cars in the range.
+ * @param DeltaTime The simulated time of the step.
+ */
+void FCarFollowingModel::StepScalar(const FCarFollowingBatch& Batch, int32 Start, int32 Count, float DeltaTime)
+{
+	const int32 end = Start + Count;
+	for (int32 i = Start; i < end; i++)
+	{
+		float speed = Batch.Speeds[i];
+		float desiredSpeed = FMath::Max(Batch.DesiredSpeeds[i], MinModelValue);
+		float maxAcceleration = FMath::Max(Batch.MaxAccelerations[i], MinModelValue);
+		float comfortableDeceleration = FMath::Max(Batch.ComfortableDecelerations[i], MinModelValue);
+		float gap = FMath::Max(Batch.Gaps[i], MinModelValue);
+
+		float brakingFactor = 0.5f * FMath::InvSqrt(maxAcceleration * comfortableDeceleration);
+		float dynamicGap = speed * Batch.TimeHeadways[i] + speed * (speed - Batch.LeaderSpeeds[i]) * brakingFactor;
+		float desiredGap = Batch.MinimumGaps[i] + FMath::Max(dynamicGap, 0.0f);
+
+		float speedRatio = FMath::Square(FMath::Square(speed / desiredSpeed));
+		float gapRatio = FMath::Square(desiredGap / gap);
+		float acceleration = maxAcceleration * (1.0f - speedRatio - gapRatio);
+
+		float newSpeed = FMath::Max(speed + acceleration * DeltaTime, 0.0f);
+		Batch.Speeds[i] = newSpeed;
+		Batch.Advances[i] = (speed + newSpeed) * 0.5f * DeltaTime;
+	}
+}
+
+/**
+ * FCarFollowingBenchmarkArrays owns the per-car arrays of the car following benchmark.
+ */
+struct FCarFollowingBenchmarkArrays
+{
+	TArray<float> Speeds;
+	TArray<float> DesiredSpeeds;
+	TArray<float> MaxAccelerations;
+	TArray<float> ComfortableDecelerations;
+	TArray<float> MinimumGaps;
+	TArray<float> TimeHeadways;
+	TArray<float> Gaps;
+	TArray<float> LeaderSpeeds;
+	TArray<float> Advances;
+
+	/**
+	 * Gets the batch pointing to the arrays.
+	 *
+	 * @return The batch of the arrays.
+	 */
+	FCarFollowingBatch GetBatch()
+	{
+		FCarFollowingBatch batch;
+		batch.Speeds = Speeds.GetData();
+		batch.DesiredSpeeds = DesiredSpeeds.GetData();
+		batch.MaxAccelerations = MaxAccelerations.GetData();
+		batch.ComfortableDecelerations = ComfortableDecelerations.GetData();
+		batch.MinimumGaps = MinimumGaps.GetData();
+		batch.TimeHeadways = TimeHeadways.GetData();
+		batch.Gaps = Gaps.GetData();
+		batch.LeaderSpeeds = LeaderSpeeds.GetData();
+		batch.Advances = Advances.GetData();
+		return batch;
+	}
+};
+
+/**
+ * Fills the benchmark arrays with a reproducible mix of free, following and stopping cars.
+ *
+ * @param Arrays The arrays to fill.
+ * @param CarsCount The number of cars.
+ */
+static void FillBenchmarkArrays(FCarFollowingBenchmarkArrays& Arrays, int32 CarsCount)
+{
+	FRandomStream stream(CarsCount);
+	for (int32 i = 0; i < CarsCount; i++)
+	{
+		float desiredSpeed = stream.FRandRange(300.0f, 1500.0f);
+		Arrays.DesiredSpeeds.Add(desiredSpeed);
+		Arrays.Speeds.Add(stream.FRandRange(0.0f, desiredSpeed));
+		Arrays.MaxAccelerations.Add(stream.FRandRange(100.0f, 300.0f));
+		Arrays.ComfortableDecelerations.Add(stream.FRandRange(150.0f, 400.0f));
+		Arrays.MinimumGaps.Add(stream.FRandRange(100.0f, 300.0f));
+		Arrays.TimeHeadways.Add(stream.FRandRange(0.8f, 2.0f));
+		Arrays.Gaps.Add((i % 8 == 0) ? FCarFollowingModel::NoObstacleGap : stream.FRandRange(0.0f, 5000.0f));
+		Arrays.LeaderSpeeds.Add((i % 4 == 0) ? 0.0f : stream.FRandRange(0.0f, desiredSpeed));
+		Arrays.Advances.Add(0.0f);
+	}
+}
+
+/**
+ * Runs the scalar and the vectorized car following kernel over synthetic cars on the game thread
+ * and logs the cost per car and step and the largest difference between the two kernels.
+ *
+ * @param Args The optional number of cars and number of steps.
+ */
+static void BenchCarFollowing(const TArray<FString>& Args)
+{
+	int32 carsCount = DefaultBenchmarkCars;
+	int32 steps = DefaultBenchmarkSteps;
+	if (Args.Num() > 0 && Args[0].IsNumeric())
+	{
+		carsCount = FMath::Max(FCString::Atoi(*Args[0]), 1);
+	}
+	if (Args.Num() > 1 && Args[1].IsNumeric())
+	{
+		steps = FMath::Max(FCString::Atoi(*Args[1]), 1);
+	}
+
+	const float deltaTime = 1.0f / 30.0f;
+
+	FCarFollowingBenchmarkArrays scalarArrays;
+	FillBenchmarkArrays(scalarArrays, carsCount);
+	FCarFollowingBenchmarkArrays vectorArrays = scalarArrays;
+	FCarFollowingBatch scalarBatch = scalarArrays.GetBatch();
+	FCarFollowingBatch vectorBatch = vectorArrays.GetBatch();
+
+	double start = FPlatformTime::Seconds();
+	for (int32 i = 0; i < steps; i++)
+	{
+		FCarFollowingModel::StepScalar(scalarBatch, 0, carsCount, deltaTime);
+	}
+	double scalarSeconds = FPlatformTime::Seconds() - start;
+
+	start = FPlatformTime::Seconds();
+	for (int32 i = 0; i < steps; i++)
+	{
+		FCarFollowingModel::Step(vectorBatch, 0, carsCount, deltaTime);
+	}
+	double vectorSeconds = FPlatformTime::Seconds() - start;
+
+	float maxSpeedDifference = 0.0f;
+	for (int32 i = 0; i < carsCount; i++)
+	{
+		maxSpeedDifference = FMath::Max(maxSpeedDifference, FMath::Abs(scalarArrays.Speeds[i] - vectorArrays.Speeds[i]));
+	}
+
+	double carSteps = (double)carsCount * steps;
+	double scalarNs = scalarSeconds * 1.0e9 / carSteps;
+	double vectorNs = vectorSeconds * 1.0e9 / carSteps;
+	UE_LOG(LogTemp, Log, TEXT("BenchCarFollowing: %d cars, %d steps, scalar %.2f ns per car, vector %.2f ns per car, speedup %.2fx, max speed difference %f."),
+		carsCount, steps, scalarNs, vectorNs, (vectorNs > 0.0) ? scalarNs / vectorNs : 0.0, maxSpeedDifference);
+}
+
+static FAutoConsoleCommandWithArgs BenchCarFollowingCommand(
+	TEXT("TSToolkit.BenchCarFollowing"),
+	TEXT("Times the scalar and vectorized car following kernels. Usage: TSToolkit.BenchCarFollowing [Cars] [Steps]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchCarFollowing));
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FCarFollowingBatch points to the packed per-car arrays the car following model reads and writes.
+ * All arrays hold one value per car and are indexed by the same car index.
+ */
+struct FCarFollowingBatch
+{
+	/** Current speed of each car, in units per second. Updated by the step. */
+	float* Speeds = nullptr;
+
+	/** Speed each car drives at on a free road, in units per second. */
+	const float* DesiredSpeeds = nullptr;
+
+	/** Maximum acceleration of each car, in units per second squared. */
+	const float* MaxAccelerations = nullptr;
+
+	/** Comfortable deceleration of each car, in units per second squared. */
+	const float* ComfortableDecelerations = nullptr;
+
+	/** Gap each car keeps to a standing obstacle, in units. */
+	const float* MinimumGaps = nullptr;
+
+	/** Time gap each car keeps to its leader, in seconds. */
+	const float* TimeHeadways = nullptr;
+
+	/** Bumper to bumper gap of each car to its leader or nearest obstacle, in units. */
+	const float* Gaps = nullptr;
+
+	/** Speed of each car's leader, zero for a standing obstacle. */
+	const float* LeaderSpeeds = nullptr;
+
+	/** Distance each car travels in the step, in units. Written by the step. */
+	float* Advances = nullptr;
+};
+
+/**
+ * FCarFollowingModel advances car speeds with the Intelligent Driver Model.
+ * Each car accelerates towards its desired speed and brakes smoothly for its leader or an obstacle,
+ * so queues form and dissolve without the cars switching between full speed and a standstill.
+ * The kernel runs over packed per-car arrays four cars at a time using the engine's vector registers.
+ */
+class TSTOOLKIT_API FCarFollowingModel
+{
+public:
+	/** Gap used for a car with no leader and no obstacle ahead, in units. */
+	static const float NoObstacleGap;
+
+	/**
+	 * Advances the speeds of a range of cars by one step and computes the distance they travel.
+	 * Full groups of four cars are processed with vector registers, the remaining cars with the scalar kernel.
+	 *
+	 * @param Batch The per-car arrays.
+	 * @param Start The index of the first car of the range.
+	 * @param Count The number of cars in the range.
+	 * @param DeltaTime The simulated time of the step.
+	 */
+	static void Step(const FCarFollowingBatch& Batch, int32 Start, int32 Count, float DeltaTime);
+
+	/**
+	 * Advances the speeds of a range of cars by one step one car at a time.
+	 * Reference for the vectorized kernel, which produces the same results.
+	 *
+	 * @param Batch The per-car arrays.
+	 * @param Start The index of the first car of the range.
+	 * @param Count The number of cars in the range.
+	 * @param DeltaTime The simulated time of the step.
+	 */
+	static void StepScalar(const FCarFollowingBatch& Batch, int32 Start, int32 Count, float DeltaTime);
+};
@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CarLightBudgetSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformTime.h"
+#include "Kismet/GameplayStatics.h"
+#include "Car.h"
+#include "TrafficManager.h"
+#include "TrafficRegistrySubsystem.h"
+#include "TSToolkit.h"
+
+DECLARE_CYCLE_STAT(TEXT("Car Light Budget"), STAT_CarLightBudget, STATGROUP_TSToolkit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Car Spot Lights"), STAT_CarSpotLights, STATGROUP_TSToolkit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Proxy Lit Cars"), STAT_ProxyLitCars, STATGROUP_TSToolkit);
+
+/** Number of spotlights of a car with headlights and taillights on. */
+static const int32 SpotLightsPerCar = 4;
+
+/** Weight of the last frame in the smoothed frame time. */
+static const double FrameTimeSmoothing = 0.1;
+
+/**
+ * Enables the budget, or disables it and gives every car its spotlights back.
+ *
+ * @param bEnabled True to apply the budget, false otherwise.
+ */
+void UCarLightBudgetSubsystem::SetEnabled(bool bEnabled)
+{
+	_IsEnabled = bEnabled;
+	_SpotLightCarsBudget = FMath::Max(MaxSpotLightCars, 0);
+	_UpdateCountdown = 0.0f;
+	_LastTickSeconds = FPlatformTime::Seconds();
+	_SmoothedFrameSeconds = 0.0;
+
+	if (_IsEnabled)
+	{
+		UpdateBudget();
+		return;
+	}
+
+	ATrafficManager* trafficManager = _GetTrafficManager();
+	if (trafficManager)
+	{
+		for (ACar* car : trafficManager->GetCars())
+		{
+			if (car)
+			{
+				car->SetUseSpotLights(true);
+			}
+		}
+	}
+	_SpotLightCarsCount = 0;
+	_ProxyCarsCount = 0;
+}
+
+/**
+ * Sets the actors whose distance decides which cars keep their spotlights and updates the budget immediately.
+ *
+ * @param FocusActors The focus actors, usually the cameras captured next.
+ */
+void UCarLightBudgetSubsystem::SetFocusActors(const TArray<AActor*>& FocusActors)
+{
+	_FocusActors.Reset(FocusActors.Num());
+	for (AActor* actor : FocusActors)
+	{
+		if (actor)
+		{
+			_FocusActors.Add(actor);
+		}
+	}
+
+	if (_IsEnabled)
+	{
+		UpdateBudget();
+	}
+}
+
+/**
+ * Reassigns the spotlights to the cars closest to the focus actors.
+ * Cars with lights off are skipped, their spotlights are hidden anyway.
+ */
+void UCarLightBudgetSubsystem::UpdateBudget()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CarLightBudget);
+
+	ATrafficManager* trafficManager = _GetTrafficManager();
+	if (!trafficManager)
+	{
+		return;
+	}
+
+	TArray<FVector, TInlineAllocator<8>> focusLocations;
+	for (const TWeakObjectPtr<AActor>& focus : _FocusActors)
+	{
+		if (focus.IsValid())
+		{
+			focusLocations.Add(focus->GetActorLocation());
+		}
+	}
+
+	FVector viewLocation;
+	if (focusLocations.Num() == 0 && _GetViewLocation(viewLocation))
+	{
+		focusLocations.Add(viewLocation);
+	}
+
+	_Candidates.Reset();
+	for (ACar* car : trafficManager->GetCars())
+	{
+		if (!car || !car->GetLightsOn())
+		{
+			continue;
+		}
+
+		// Cars no capture camera sees do not render spotlights and do not take a slot of the budget
+		if (!car->IsSignificant())
+		{
+			car->SetUseSpotLights(false);
+			continue;
+		}
+
+		float distanceSquared = focusLocations.Num() > 0 ? MAX_flt : 0.0f;
+		FVector carLocation = car->GetActorLocation();
+		for (const FVector& focusLocation : focusLocations)
+		{
+			distanceSquared = FMath::Min(distanceSquared, (float)FVector::DistSquared(carLocation, focusLocation));
+		}
+		_Candidates.Emplace(distanceSquared, car);
+	}
+
+	_Candidates.Sort([](const TPair<float, ACar*>& A, const TPair<float, ACar*>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	_SpotLightCarsCount = FMath::Min(_SpotLightCarsBudget, _Candidates.Num());
+	_ProxyCarsCount = _Candidates.Num() - _SpotLightCarsCount;
+	for (int32 i = 0; i < _Candidates.Num(); i++)
+	{
+		_Candidates[i].Value->SetUseSpotLights(i < _SpotLightCarsCount);
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("UCarLightBudgetSubsystem: %d cars with spotlights (%d lights), %d cars with emissive proxy, budget %d."),
+		_SpotLightCarsCount, _SpotLightCarsCount * SpotLightsPerCar, _ProxyCarsCount, _SpotLightCarsBudget);
+}
+
+/**
+ * Called every frame while the budget is enabled. Adapts the budget to the frame time and updates it periodically.
+ * The frame time is measured on the wall clock, so a fixed simulation step does not hide rendering cost.
+ *
+ * @param DeltaTime The simulation time elapsed since the last frame.
+ */
+void UCarLightBudgetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	double now = FPlatformTime::Seconds();
+	double frameSeconds = now - _LastTickSeconds;
+	_LastTickSeconds = now;
+	_SmoothedFrameSeconds = (_SmoothedFrameSeconds > 0.0)
+		? FMath::Lerp(_SmoothedFrameSeconds, frameSeconds, FrameTimeSmoothing)
+		: frameSeconds;
+
+	_UpdateCountdown -= DeltaTime;
+	if (_UpdateCountdown <= 0.0f)
+	{
+		_UpdateCountdown = UpdateInterval;
+		_AdaptToFrameTime();
+		UpdateBudget();
+	}
+
+	SET_DWORD_STAT(STAT_CarSpotLights, _SpotLightCarsCount * SpotLightsPerCar);
+	SET_DWORD_STAT(STAT_ProxyLitCars, _ProxyCarsCount);
+}
+
+/**
+ * Gets whether the subsystem ticks this frame.
+ *
+ * @return True while the budget is enabled.
+ */
+bool UCarLightBudgetSubsystem::IsTickable() const
+{
+	return _IsEnabled;
+}
+
+/**
+ * Gets the stat id used to profile the subsystem's tick.
+ *
+ * @return The stat id of the subsystem.
+ */
+TStatId UCarLightBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCarLightBudgetSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ * Shrinks or grows the budget by one car depending on the smoothed frame time.
+ * The gap between the two thresholds keeps the budget from oscillating around the target.
+ */
+void UCarLightBudgetSubsystem::_AdaptToFrameTime()
+{
+	int32 maxCars = FMath::Max(MaxSpotLightCars, 0);
+	int32 minCars = FMath::Clamp(MinSpotLightCars, 0, maxCars);
+	if (TargetFrameTimeMs <= 0.0f)
+	{
+		_SpotLightCarsBudget = maxCars;
+		return;
+	}
+
+	double frameMs = _SmoothedFrameSeconds * 1000.0;
+	if (frameMs > TargetFrameTimeMs * 1.05)
+	{
+		_SpotLightCarsBudget--;
+	}
+	else if (frameMs < TargetFrameTimeMs * 0.85)
+	{
+		_SpotLightCarsBudget++;
+	}
+	_SpotLightCarsBudget = FMath::Clamp(_SpotLightCarsBudget, minCars, maxCars);
+}
+
+/**
+ * Gets the traffic manager of the world from the traffic registry.
+ *
+ * @return The traffic manager, or nullptr if the level has none.
+ */
+ATrafficManager* UCarLightBudgetSubsystem::_GetTrafficManager() const
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	return registry ? registry->GetTrafficManager() : nullptr;
+}
+
+/**
+ * Gets the location of the player's view, used when no focus actor is set.
+ *
+ * @param OutLocation The location of the view.
+ * @return True if a view location is available, false otherwise.
+ */
+bool UCarLightBudgetSubsystem::_GetViewLocation(FVector& OutLocation) const
+{
+	APlayerController* playerController = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+	if (!playerController)
+	{
+		return false;
+	}
+
+	FRotator viewRotation;
+	playerController->GetPlayerViewPoint(OutLocation, viewRotation);
+	return true;
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CarLightBudgetSubsystem.generated.h"
+
+class ACar;
+class ATrafficManager;
+
+/**
+ * UCarLightBudgetSubsystem limits the number of cars whose headlights are rendered with spotlights.
+ * Only the cars with lights on closest to the focus actors (the capture cameras) keep their spotlights,
+ * the others fall back to the emissive headlight proxy of their mesh. The budget shrinks while the frame
+ * time is above the target and grows back while it is well below it.
+ * The subsystem only ticks while it is enabled.
+ */
+UCLASS()
+class TSTOOLKIT_API UCarLightBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Upper bound of the number of cars using spotlights. */
+	int32 MaxSpotLightCars = 16;
+
+	/** Lower bound of the number of cars using spotlights when the budget adapts to the frame time. */
+	int32 MinSpotLightCars = 2;
+
+	/** Frame time the budget adapts to, in milliseconds, or zero to always allow MaxSpotLightCars. */
+	float TargetFrameTimeMs = 0.0f;
+
+	/** Time between two budget updates, in seconds. */
+	float UpdateInterval = 0.25f;
+
+private:
+	/** Indicates whether the budget is applied. */
+	bool _IsEnabled = false;
+
+	/** Current number of cars allowed to use spotlights. */
+	int32 _SpotLightCarsBudget = 16;
+
+	/** Time until the next budget update, in seconds. */
+	float _UpdateCountdown = 0.0f;
+
+	/** Wall clock time of the previous tick. */
+	double _LastTickSeconds = 0.0;
+
+	/** Exponentially smoothed wall clock frame time, in seconds. */
+	double _SmoothedFrameSeconds = 0.0;
+
+	/** Actors whose distance decides which cars keep their spotlights. */
+	TArray<TWeakObjectPtr<AActor>> _FocusActors;
+
+	/** Cars with lights on and their squared distance to the nearest focus, reused between updates. */
+	TArray<TPair<float, ACar*>> _Candidates;
+
+	/** Number of cars using spotlights after the last update. */
+	int32 _SpotLightCarsCount = 0;
+
+	/** Number of cars using the emissive proxy after the last update. */
+	int32 _ProxyCarsCount = 0;
+
+public:
+	/**
+	 * Enables the budget, or disables it and gives every car its spotlights back.
+	 *
+	 * @param bEnabled True to apply the budget, false otherwise.
+	 */
+	void SetEnabled(bool bEnabled);
+
+	/**
+	 * Sets the actors whose distance decides which cars keep their spotlights and updates the budget immediately.
+	 *
+	 * @param FocusActors The focus actors, usually the cameras captured next.
+	 */
+	void SetFocusActors(const TArray<AActor*>& FocusActors);
+
+	/**
+	 * Reassigns the spotlights to the cars closest to the focus actors.
+	 */
+	void UpdateBudget();
+
+	/**
+	 * Called every frame while the budget is enabled. Adapts the budget to the frame time and updates it periodically.
+	 *
+	 * @param DeltaTime The simulation time elapsed since the last frame.
+	 */
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Gets whether the subsystem ticks this frame.
+	 *
+	 * @return True while the budget is enabled.
+	 */
+	virtual bool IsTickable() const override;
+
+	/**
+	 * Gets the stat id used to profile the subsystem's tick.
+	 *
+	 * @return The stat id of the subsystem.
+	 */
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Gets whether the budget is applied.
+	 *
+	 * @return True if the budget is enabled, false otherwise.
+	 */
+	FORCEINLINE bool IsEnabled() const
+	{
+		return _IsEnabled;
+	}
+
+	/**
+	 * Gets the current number of cars allowed to use spotlights.
+	 *
+	 * @return The spotlight budget, in cars.
+	 */
+	FORCEINLINE int32 GetSpotLightCarsBudget() const
+	{
+		return _SpotLightCarsBudget;
+	}
+
+private:
+	/**
+	 * Shrinks or grows the budget by one car depending on the smoothed frame time.
+	 */
+	void _AdaptToFrameTime();
+
+	/**
+	 * Gets the traffic manager of the world from the traffic registry.
+	 *
+	 * @return The traffic manager, or nullptr if the level has none.
+	 */
+	ATrafficManager* _GetTrafficManager() const;
+
+	/**
+	 * Gets the location of the player's view, used when no focus actor is set.
+	 *
+	 * @param OutLocation The location of the view.
+	 * @return True if a view location is available, false otherwise.
+	 */
+	bool _GetViewLocation(FVector& OutLocation) const;
+};
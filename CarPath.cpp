@@ -1,8 +1,28 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "CarPath.h"
+#include "Components/BoxComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/SplineComponent.h"
+#include "TrafficRegistrySubsystem.h"
+
+/** Number of bisection steps refining the distance at which the path enters a box. */
+static const int32 BoxEntryRefineSteps = 8;
+
+/**
+ * Checks whether a location lies inside a box, ignoring the height.
+ * The path runs along the road surface, which may lie slightly outside a box placed on it.
+ *
+ * @param BoxTransform The world transform of the box.
+ * @param BoxExtent The unscaled half extent of the box.
+ * @param Location The world location to test.
+ * @return True if the location is inside the box, false otherwise.
+ */
+static bool IsInsideBox(const FTransform& BoxTransform, const FVector& BoxExtent, const FVector& Location)
+{
+	FVector local = BoxTransform.InverseTransformPosition(Location);
+	return FMath::Abs(local.X) <= BoxExtent.X && FMath::Abs(local.Y) <= BoxExtent.Y;
+}
 
 /**
  * Constructor for ACarPath.
@@ -10,8 +30,8 @@
  */
 ACarPath::ACarPath()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Initialize the spline component for the car path
 	Path = CreateDefaultSubobject<USplineComponent>(TEXT("Car Path"));
@@ -59,6 +79,40 @@ void ACarPath::BeginPlay()
 	{
 		UE_LOG(LogTemp, Error, TEXT("EndMesh is null in BeginPlay."));
 	}
+
+	BakeLookupTable();
+}
+
+/**
+ * Called after the actor's components are initialized.
+ * Registers the path with the traffic registry, which compiles the path network before any actor begins play.
+ */
+void ACarPath::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterCarPath(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the path from the traffic registry.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void ACarPath::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterCarPath(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
@@ -84,18 +138,9 @@ void ACarPath::OnConstruction(const FTransform& Transform)
 	}
 }
 
-/**
- * Called every frame to update the actor.
- *
- * @param DeltaTime The time elapsed since the last frame.
- */
-void ACarPath::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 /**
  * Checks if the given path is related to this path.
+ * Paths of the compiled network are looked up in the relation matrix, other paths in RelatedPaths.
  *
  * @param OtherPath The other path to check.
  * @return True if the other path is related, false otherwise.
@@ -108,9 +153,38 @@ bool ACarPath::IsPathRelated(ACarPath* OtherPath)
 		return false;
 	}
 
+	int32 otherIndex = OtherPath->GetRelationIndex();
+	if (_RelationIndex != INDEX_NONE && _RelatedPathBits.IsValidIndex(otherIndex))
+	{
+		return _RelatedPathBits[otherIndex];
+	}
+
 	return RelatedPaths.Contains(OtherPath);
 }
 
+/**
+ * Checks whether any path is related to this path.
+ *
+ * @return True if the path has related paths, false otherwise.
+ */
+bool ACarPath::HasRelatedPaths() const
+{
+	return (_RelationIndex != INDEX_NONE) ? _RelatedPathsCount > 0 : RelatedPaths.Num() > 0;
+}
+
+/**
+ * Sets the relations of this path compiled by the traffic registry.
+ *
+ * @param RelationIndex The dense index of the path in the network, or INDEX_NONE to clear the compiled relations.
+ * @param RelatedPathBits The row of the relation matrix of the path.
+ */
+void ACarPath::SetCompiledRelations(int32 RelationIndex, const TBitArray<>& RelatedPathBits)
+{
+	_RelationIndex = RelationIndex;
+	_RelatedPathBits = (RelationIndex != INDEX_NONE) ? RelatedPathBits : TBitArray<>();
+	_RelatedPathsCount = _RelatedPathBits.CountSetBits();
+}
+
 /**
  * Adds a relation between this path and another path.
  *
@@ -123,9 +197,10 @@ void ACarPath::AddPathRelation(ACarPath* OtherPath)
 		UE_LOG(LogTemp, Warning, TEXT("AddPathRelation called with a null OtherPath."));
 		return;
 	}
-	if (!IsPathRelated(OtherPath))
+	if (!RelatedPaths.Contains(OtherPath))
 	{
 		RelatedPaths.Add(OtherPath);
+		_RecompileRelations();
 	}
 }
 
@@ -142,12 +217,16 @@ void ACarPath::RemovePathRelation(ACarPath* OtherPath)
 		return;
 	}
 
-	RelatedPaths.Remove(OtherPath);
+	if (RelatedPaths.Remove(OtherPath) > 0)
+	{
+		_RecompileRelations();
+	}
 }
 
 /**
  * Updates the relations of this path with other paths.
- * Ensures bidirectional relationships are maintained.
+ * Null entries and self-references are removed first, then this path is added to every related path.
+ * Only the other paths' arrays are changed while the relations of this path are iterated.
  */
 void ACarPath::UpdateRelations()
 {
@@ -157,29 +236,293 @@ void ACarPath::UpdateRelations()
 		return;
 	}
 
-	for (auto path : RelatedPaths)
+	int32 removedCount = RelatedPaths.RemoveAll([this](const ACarPath* Path)
+		{
+			return !Path || Path == this;
+		});
+	if (removedCount > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UpdateRelations removed %d null or self-referencing entries from RelatedPaths."), removedCount);
+	}
+
+	for (ACarPath* path : RelatedPaths)
+	{
+		path->AddPathRelation(this);
+	}
+
+	_RecompileRelations();
+}
+
+/**
+ * Schedules a recompilation of the path network of the traffic registry if this path is part of it,
+ * so the relation matrix follows changes of RelatedPaths made during play from the next tick on.
+ */
+void ACarPath::_RecompileRelations()
+{
+	if (_RelationIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
 	{
-		if (!path)
+		registry->MarkPathNetworkDirty();
+	}
+}
+
+/**
+ * Bakes the lookup table of locations, rotations and tangents along the spline.
+ * Starts with SampleSpacing and halves the spacing until the location interpolated halfway between
+ * two samples is within MaxSampleError of the real spline, or MinSampleSpacing is reached.
+ */
+void ACarPath::BakeLookupTable()
+{
+	if (!Path)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BakeLookupTable: Path is null."));
+		return;
+	}
+
+	_SplineLength = Path->GetSplineLength();
+	if (_SplineLength <= KINDA_SMALL_NUMBER)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BakeLookupTable: Spline of %s has zero length."), *GetName());
+		return;
+	}
+
+	float spacing = FMath::Max(SampleSpacing, MinSampleSpacing);
+	int32 samplesCount = 0;
+	float maxError = 0.0f;
+
+	while (true)
+	{
+		samplesCount = FMath::Max(2, FMath::CeilToInt(_SplineLength / spacing) + 1);
+		_SampleStep = _SplineLength / (samplesCount - 1);
+
+		_SampleLocations.SetNumUninitialized(samplesCount);
+		for (int32 i = 0; i < samplesCount; i++)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("UpdateRelations encountered a null path in RelatedPaths."));
-			continue;
+			_SampleLocations[i] = Path->GetLocationAtDistanceAlongSpline(i * _SampleStep, ESplineCoordinateSpace::World);
+		}
+
+		maxError = 0.0f;
+		for (int32 i = 0; i < samplesCount - 1; i++)
+		{
+			FVector real = Path->GetLocationAtDistanceAlongSpline((i + 0.5f) * _SampleStep, ESplineCoordinateSpace::World);
+			FVector interpolated = FMath::Lerp(_SampleLocations[i], _SampleLocations[i + 1], 0.5f);
+			maxError = FMath::Max(maxError, FVector::Dist(real, interpolated));
 		}
 
-		if (path == this)
+		if (maxError <= MaxSampleError || spacing * 0.5f < MinSampleSpacing)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("UpdateRelations detected a self-reference. Removing this path from RelatedPaths."));
-			RemovePathRelation(this);
+			break;
 		}
+		spacing *= 0.5f;
+	}
+
+	if (maxError > MaxSampleError)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BakeLookupTable: %s reached MinSampleSpacing with error %f above MaxSampleError."), *GetName(), maxError);
+	}
+
+	_InvSampleStep = 1.0f / _SampleStep;
+	_SampleRotations.SetNumUninitialized(samplesCount);
+	_SampleTangents.SetNumUninitialized(samplesCount);
+	for (int32 i = 0; i < samplesCount; i++)
+	{
+		float distance = i * _SampleStep;
+		_SampleRotations[i] = Path->GetQuaternionAtDistanceAlongSpline(distance, ESplineCoordinateSpace::World);
+		_SampleTangents[i] = Path->GetTangentAtDistanceAlongSpline(distance, ESplineCoordinateSpace::World);
+	}
+}
+
+/**
+ * Computes the sample index and interpolation alpha for a distance along the path.
+ * Distances outside the spline are clamped to its ends, as the spline queries do.
+ *
+ * @param Distance The distance along the spline.
+ * @param OutIndex The index of the sample before the distance.
+ * @param OutAlpha The interpolation alpha between the sample and the next one.
+ */
+void ACarPath::_GetSampleAtDistance(float Distance, int32& OutIndex, float& OutAlpha) const
+{
+	float position = FMath::Clamp(Distance, 0.0f, _SplineLength) * _InvSampleStep;
+	OutIndex = FMath::Min(FMath::FloorToInt(position), _SampleLocations.Num() - 2);
+	OutAlpha = position - OutIndex;
+}
+
+/**
+ * Gets the world location at a distance along the path.
+ * Falls back to the spline if the lookup table is not baked.
+ *
+ * @param Distance The distance along the spline.
+ * @return The interpolated world location.
+ */
+FVector ACarPath::GetLocationAtDistance(float Distance) const
+{
+	if (!IsLookupTableBaked())
+	{
+		return Path->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+	}
 
-		if (!path->IsPathRelated(this))
+	int32 index;
+	float alpha;
+	_GetSampleAtDistance(Distance, index, alpha);
+	return FMath::Lerp(_SampleLocations[index], _SampleLocations[index + 1], alpha);
+}
+
+/**
+ * Gets the world rotation at a distance along the path.
+ * Falls back to the spline if the lookup table is not baked.
+ *
+ * @param Distance The distance along the spline.
+ * @return The interpolated world rotation.
+ */
+FRotator ACarPath::GetRotationAtDistance(float Distance) const
+{
+	if (!IsLookupTableBaked())
+	{
+		return Path->GetRotationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+	}
+
+	int32 index;
+	float alpha;
+	_GetSampleAtDistance(Distance, index, alpha);
+	return FQuat::FastLerp(_SampleRotations[index], _SampleRotations[index + 1], alpha).GetNormalized().Rotator();
+}
+
+/**
+ * Gets the world tangent at a distance along the path.
+ * Falls back to the spline if the lookup table is not baked.
+ *
+ * @param Distance The distance along the spline.
+ * @return The interpolated world tangent.
+ */
+FVector ACarPath::GetTangentAtDistance(float Distance) const
+{
+	if (!IsLookupTableBaked())
+	{
+		return Path->GetTangentAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+	}
+
+	int32 index;
+	float alpha;
+	_GetSampleAtDistance(Distance, index, alpha);
+	return FMath::Lerp(_SampleTangents[index], _SampleTangents[index + 1], alpha);
+}
+
+/**
+ * Gets the world location and rotation at a distance along the path with a single table lookup.
+ * Falls back to the spline if the lookup table is not baked.
+ *
+ * @param Distance The distance along the spline.
+ * @param OutLocation The interpolated world location.
+ * @param OutRotation The interpolated world rotation.
+ */
+void ACarPath::GetTransformAtDistance(float Distance, FVector& OutLocation, FRotator& OutRotation) const
+{
+	if (!IsLookupTableBaked())
+	{
+		OutLocation = Path->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+		OutRotation = Path->GetRotationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+		return;
+	}
+
+	int32 index;
+	float alpha;
+	_GetSampleAtDistance(Distance, index, alpha);
+	OutLocation = FMath::Lerp(_SampleLocations[index], _SampleLocations[index + 1], alpha);
+	OutRotation = FQuat::FastLerp(_SampleRotations[index], _SampleRotations[index + 1], alpha).GetNormalized().Rotator();
+}
+
+/**
+ * Bakes the distance along the spline closest to a source's spawn location.
+ *
+ * @param Source The source spawning cars on this path.
+ * @param SpawnLocation The world location at which the source spawns cars.
+ */
+void ACarPath::BakeSpawnDistance(const AActor* Source, const FVector& SpawnLocation)
+{
+	if (!Source || !Path)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BakeSpawnDistance called with a null Source or Path."));
+		return;
+	}
+
+	_SpawnDistances.Add(Source, Path->GetDistanceAlongSplineAtLocation(SpawnLocation, ESplineCoordinateSpace::World));
+}
+
+/**
+ * Gets the distance along the spline at which a source spawns its cars.
+ * The distance is baked on first use if the source did not bake it yet.
+ *
+ * @param Source The source spawning cars on this path.
+ * @param SpawnLocation The world location at which the source spawns cars.
+ * @return The distance along the spline.
+ */
+float ACarPath::GetSpawnDistance(const AActor* Source, const FVector& SpawnLocation)
+{
+	if (const float* found = _SpawnDistances.Find(Source))
+	{
+		return *found;
+	}
+
+	BakeSpawnDistance(Source, SpawnLocation);
+	const float* baked = _SpawnDistances.Find(Source);
+	return baked ? *baked : 0.0f;
+}
+
+/**
+ * Finds the distance along the path at which the path first enters a box.
+ * The path is walked in steps of SampleSpacing and the entry is refined by bisection between the last sample
+ * outside and the first sample inside the box.
+ *
+ * @param Box The box to test.
+ * @param OutDistance The distance along the spline of the first point inside the box.
+ * @return True if the path enters the box, false otherwise.
+ */
+bool ACarPath::FindBoxEntryDistance(const UBoxComponent* Box, float& OutDistance) const
+{
+	if (!Box || !Path)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FindBoxEntryDistance called with a null Box or Path."));
+		return false;
+	}
+
+	const FTransform& boxTransform = Box->GetComponentTransform();
+	FVector boxExtent = Box->GetUnscaledBoxExtent();
+	float splineLength = Path->GetSplineLength();
+	float step = FMath::Max(SampleSpacing, MinSampleSpacing);
+	int32 samplesCount = FMath::CeilToInt(splineLength / step);
+
+	float outsideDistance = 0.0f;
+	for (int32 i = 0; i <= samplesCount; i++)
+	{
+		float distance = FMath::Min(i * step, splineLength);
+		if (!IsInsideBox(boxTransform, boxExtent, GetLocationAtDistance(distance)))
 		{
-			path->AddPathRelation(this);
+			outsideDistance = distance;
+			continue;
 		}
 
-		if (!IsPathRelated(path))
+		float insideDistance = distance;
+		for (int32 j = 0; j < BoxEntryRefineSteps && i > 0; j++)
 		{
-			RemovePathRelation(path);
-			path->UpdateRelations();
+			float middleDistance = 0.5f * (outsideDistance + insideDistance);
+			if (IsInsideBox(boxTransform, boxExtent, GetLocationAtDistance(middleDistance)))
+			{
+				insideDistance = middleDistance;
+			}
+			else
+			{
+				outsideDistance = middleDistance;
+			}
 		}
+
+		OutDistance = insideDistance;
+		return true;
 	}
-}
\ No newline at end of file
+
+	return false;
+}
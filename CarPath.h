@@ -43,6 +43,50 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Details")
 	TArray<ACarPath*> RelatedPaths;
 
+	// Lookup table details
+	/** Initial distance between two samples of the lookup table, in units. */
+	UPROPERTY(EditAnywhere, Category = "Path Lookup Table")
+	float SampleSpacing = 50.0f;
+
+	/** Smallest distance between two samples the table may be refined to, in units. */
+	UPROPERTY(EditAnywhere, Category = "Path Lookup Table")
+	float MinSampleSpacing = 5.0f;
+
+	/** Maximum allowed distance between an interpolated and the real spline location, in units. */
+	UPROPERTY(EditAnywhere, Category = "Path Lookup Table")
+	float MaxSampleError = 1.0f;
+
+private:
+	/** Uniformly sampled world locations along the spline. */
+	TArray<FVector> _SampleLocations;
+
+	/** Uniformly sampled world rotations along the spline. */
+	TArray<FQuat> _SampleRotations;
+
+	/** Uniformly sampled world tangents along the spline. */
+	TArray<FVector> _SampleTangents;
+
+	/** Distance between two consecutive samples. */
+	float _SampleStep = 0.0f;
+
+	/** Inverse of the distance between two consecutive samples. */
+	float _InvSampleStep = 0.0f;
+
+	/** Length of the spline at the time the table was baked. */
+	float _SplineLength = 0.0f;
+
+	/** Cached distance along the spline at which each source spawns its cars. */
+	TMap<const AActor*, float> _SpawnDistances;
+
+	/** Dense index of the path in the compiled path network, INDEX_NONE if the network was not compiled. */
+	int32 _RelationIndex = INDEX_NONE;
+
+	/** Row of the compiled relation matrix, one bit per path of the network indexed by its relation index. */
+	TBitArray<> _RelatedPathBits;
+
+	/** Number of paths related to this path in the compiled network. */
+	int32 _RelatedPathsCount = 0;
+
 protected:
 	/**
 	 * Called when the game starts or when the actor is spawned.
@@ -50,6 +94,20 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Called after the actor's components are initialized.
+	 * Registers the path with the traffic registry, which compiles the path network before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the path from the traffic registry.
+	 *
+	 * @param EndPlayReason The reason the actor is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Called when the actor is constructed or properties are changed in the editor.
 	 * Allows for dynamic updates to the actor's properties.
@@ -62,13 +120,6 @@ protected:
 	// void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 
 public:
-	/**
-	 * Called every frame to update the actor.
-	 *
-	 * @param DeltaTime The time elapsed since the last frame.
-	 */
-	virtual void Tick(float DeltaTime) override;
-
 	/**
 	 * Checks if the given path is related to this path.
 	 *
@@ -78,6 +129,41 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Path Relations")
 	bool IsPathRelated(ACarPath* OtherPath);
 
+	/**
+	 * Checks whether any path is related to this path.
+	 *
+	 * @return True if the path has related paths, false otherwise.
+	 */
+	bool HasRelatedPaths() const;
+
+	/**
+	 * Sets the relations of this path compiled by the traffic registry.
+	 *
+	 * @param RelationIndex The dense index of the path in the network, or INDEX_NONE to clear the compiled relations.
+	 * @param RelatedPathBits The row of the relation matrix of the path.
+	 */
+	void SetCompiledRelations(int32 RelationIndex, const TBitArray<>& RelatedPathBits);
+
+	/**
+	 * Gets the dense index of the path in the compiled path network.
+	 *
+	 * @return The relation index, or INDEX_NONE if the network was not compiled.
+	 */
+	FORCEINLINE int32 GetRelationIndex() const
+	{
+		return _RelationIndex;
+	}
+
+	/**
+	 * Gets the row of the compiled relation matrix of the path.
+	 *
+	 * @return One bit per path of the network, set for the related paths.
+	 */
+	FORCEINLINE const TBitArray<>& GetRelatedPathBits() const
+	{
+		return _RelatedPathBits;
+	}
+
 	/**
 	 * Adds a relation between this path and another path.
 	 *
@@ -96,8 +182,100 @@ public:
 
 	/**
 	 * Updates the relations of this path with other paths.
-	 * Ensures bidirectional relationships are maintained.
+	 * Removes invalid entries and ensures bidirectional relationships are maintained.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Path Relations")
 	void UpdateRelations();
+
+	/**
+	 * Bakes the lookup table of locations, rotations and tangents along the spline.
+	 * The sample spacing is halved until the interpolation error is within MaxSampleError.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Path Lookup Table")
+	void BakeLookupTable();
+
+	/**
+	 * Checks whether the lookup table has been baked.
+	 *
+	 * @return True if the lookup table is available, false otherwise.
+	 */
+	FORCEINLINE bool IsLookupTableBaked() const
+	{
+		return _SampleLocations.Num() > 1;
+	}
+
+	/**
+	 * Gets the world location at a distance along the path.
+	 *
+	 * @param Distance The distance along the spline.
+	 * @return The interpolated world location.
+	 */
+	FVector GetLocationAtDistance(float Distance) const;
+
+	/**
+	 * Gets the world rotation at a distance along the path.
+	 *
+	 * @param Distance The distance along the spline.
+	 * @return The interpolated world rotation.
+	 */
+	FRotator GetRotationAtDistance(float Distance) const;
+
+	/**
+	 * Gets the world tangent at a distance along the path.
+	 *
+	 * @param Distance The distance along the spline.
+	 * @return The interpolated world tangent.
+	 */
+	FVector GetTangentAtDistance(float Distance) const;
+
+	/**
+	 * Gets the world location and rotation at a distance along the path with a single table lookup.
+	 *
+	 * @param Distance The distance along the spline.
+	 * @param OutLocation The interpolated world location.
+	 * @param OutRotation The interpolated world rotation.
+	 */
+	void GetTransformAtDistance(float Distance, FVector& OutLocation, FRotator& OutRotation) const;
+
+	/**
+	 * Bakes the distance along the spline closest to a source's spawn location.
+	 *
+	 * @param Source The source spawning cars on this path.
+	 * @param SpawnLocation The world location at which the source spawns cars.
+	 */
+	void BakeSpawnDistance(const AActor* Source, const FVector& SpawnLocation);
+
+	/**
+	 * Gets the distance along the spline at which a source spawns its cars.
+	 * The distance is baked on first use if the source did not bake it yet.
+	 *
+	 * @param Source The source spawning cars on this path.
+	 * @param SpawnLocation The world location at which the source spawns cars.
+	 * @return The distance along the spline.
+	 */
+	float GetSpawnDistance(const AActor* Source, const FVector& SpawnLocation);
+
+	/**
+	 * Finds the distance along the path at which the path first enters a box.
+	 *
+	 * @param Box The box to test.
+	 * @param OutDistance The distance along the spline of the first point inside the box.
+	 * @return True if the path enters the box, false otherwise.
+	 */
+	bool FindBoxEntryDistance(const class UBoxComponent* Box, float& OutDistance) const;
+
+private:
+	/**
+	 * Computes the sample index and interpolation alpha for a distance along the path.
+	 *
+	 * @param Distance The distance along the spline.
+	 * @param OutIndex The index of the sample before the distance.
+	 * @param OutAlpha The interpolation alpha between the sample and the next one.
+	 */
+	void _GetSampleAtDistance(float Distance, int32& OutIndex, float& OutAlpha) const;
+
+	/**
+	 * Schedules a recompilation of the path network of the traffic registry if this path is part of it.
+	 */
+	void _RecompileRelations();
 };
\ No newline at end of file
@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CarSignificanceSubsystem.h"
+#include "Engine/World.h"
+#include "Camera/CameraComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "SceneManagement.h"
+#include "Camera.h"
+#include "Car.h"
+#include "TrafficManager.h"
+#include "TrafficRegistrySubsystem.h"
+#include "TSToolkit.h"
+
+DECLARE_CYCLE_STAT(TEXT("Car Significance"), STAT_CarSignificance, STATGROUP_TSToolkit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significant Cars"), STAT_SignificantCars, STATGROUP_TSToolkit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Insignificant Cars"), STAT_InsignificantCars, STATGROUP_TSToolkit);
+
+/**
+ * Enables significance, or disables it and restores every car to full quality.
+ *
+ * @param bEnabled True to apply significance, false otherwise.
+ */
+void UCarSignificanceSubsystem::SetEnabled(bool bEnabled)
+{
+	_IsEnabled = bEnabled;
+	_UpdateCountdown = 0.0f;
+
+	if (_IsEnabled)
+	{
+		UpdateSignificance();
+		return;
+	}
+
+	ATrafficManager* trafficManager = _GetTrafficManager();
+	if (trafficManager)
+	{
+		for (ACar* car : trafficManager->GetCars())
+		{
+			if (car)
+			{
+				car->SetSignificant(true);
+			}
+		}
+	}
+	_SignificantCarsCount = 0;
+	_InsignificantCarsCount = 0;
+}
+
+/**
+ * Sets the cameras whose views decide which cars are significant.
+ * Without capture cameras all cameras of the traffic registry are used.
+ *
+ * @param Cameras The capture cameras.
+ */
+void UCarSignificanceSubsystem::SetCaptureCameras(const TArray<ACamera*>& Cameras)
+{
+	_CaptureCameras.Reset(Cameras.Num());
+	for (ACamera* camera : Cameras)
+	{
+		if (camera)
+		{
+			_CaptureCameras.Add(camera);
+		}
+	}
+}
+
+/**
+ * Rebuilds the camera frusta and updates the significance of all cars.
+ * Without any capture camera all cars stay significant, so nothing is captured at reduced quality.
+ */
+void UCarSignificanceSubsystem::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CarSignificance);
+
+	ATrafficManager* trafficManager = _GetTrafficManager();
+	if (!trafficManager)
+	{
+		return;
+	}
+
+	_BuildFrusta();
+
+	_SignificantCarsCount = 0;
+	_InsignificantCarsCount = 0;
+	for (ACar* car : trafficManager->GetCars())
+	{
+		if (!car || !car->CarMeshComponent)
+		{
+			continue;
+		}
+
+		const FBoxSphereBounds& bounds = car->CarMeshComponent->Bounds;
+		bool isSignificant = _Frusta.Num() == 0 || _IsInAnyView(bounds.Origin, bounds.SphereRadius + FrustumMargin);
+		car->SetSignificant(isSignificant);
+
+		if (isSignificant)
+		{
+			_SignificantCarsCount++;
+		}
+		else
+		{
+			_InsignificantCarsCount++;
+		}
+	}
+}
+
+/**
+ * Called every frame while significance is enabled. Updates the significance periodically.
+ *
+ * @param DeltaTime The simulation time elapsed since the last frame.
+ */
+void UCarSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	_UpdateCountdown -= DeltaTime;
+	if (_UpdateCountdown <= 0.0f)
+	{
+		_UpdateCountdown = UpdateInterval;
+		UpdateSignificance();
+	}
+
+	SET_DWORD_STAT(STAT_SignificantCars, _SignificantCarsCount);
+	SET_DWORD_STAT(STAT_InsignificantCars, _InsignificantCarsCount);
+}
+
+/**
+ * Gets whether the subsystem ticks this frame.
+ *
+ * @return True while significance is enabled.
+ */
+bool UCarSignificanceSubsystem::IsTickable() const
+{
+	return _IsEnabled;
+}
+
+/**
+ * Gets the stat id used to profile the subsystem's tick.
+ *
+ * @return The stat id of the subsystem.
+ */
+TStatId UCarSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCarSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ * Rebuilds the view frustum and location of every capture camera.
+ * The frusta use the capture resolution of each camera, so they match the captured images.
+ */
+void UCarSignificanceSubsystem::_BuildFrusta()
+{
+	TArray<ACamera*, TInlineAllocator<16>> cameras;
+	for (const TWeakObjectPtr<ACamera>& camera : _CaptureCameras)
+	{
+		if (camera.IsValid())
+		{
+			cameras.Add(camera.Get());
+		}
+	}
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (cameras.Num() == 0 && registry)
+	{
+		cameras.Append(registry->GetCameras());
+	}
+
+	_Frusta.Reset(cameras.Num());
+	_CameraLocations.Reset(cameras.Num());
+	for (ACamera* camera : cameras)
+	{
+		FMatrix viewProjectionMatrix;
+		if (!camera || !camera->GetCaptureViewProjection(viewProjectionMatrix))
+		{
+			continue;
+		}
+
+		FConvexVolume& frustum = _Frusta.AddDefaulted_GetRef();
+		GetViewFrustumBounds(frustum, viewProjectionMatrix, false);
+		_CameraLocations.Add(camera->GetCameraComponent()->GetComponentLocation());
+	}
+}
+
+/**
+ * Checks whether a sphere may be seen by any capture camera.
+ *
+ * @param Origin The center of the sphere.
+ * @param Radius The radius of the sphere.
+ * @return True if the sphere intersects a camera view, false otherwise.
+ */
+bool UCarSignificanceSubsystem::_IsInAnyView(const FVector& Origin, float Radius) const
+{
+	float maxDistanceSquared = FMath::Square(MaxSignificantDistance + Radius);
+	for (int32 i = 0; i < _Frusta.Num(); i++)
+	{
+		if (MaxSignificantDistance > 0.0f && FVector::DistSquared(Origin, _CameraLocations[i]) > maxDistanceSquared)
+		{
+			continue;
+		}
+
+		if (_Frusta[i].IntersectSphere(Origin, Radius))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Gets the traffic manager of the world from the traffic registry.
+ *
+ * @return The traffic manager, or nullptr if the level has none.
+ */
+ATrafficManager* UCarSignificanceSubsystem::_GetTrafficManager() const
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	return registry ? registry->GetTrafficManager() : nullptr;
+}
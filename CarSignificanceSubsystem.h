@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ConvexVolume.h"
+#include "CarSignificanceSubsystem.generated.h"
+
+class ACamera;
+class ATrafficManager;
+
+/**
+ * UCarSignificanceSubsystem renders at full quality only the cars a capture camera may see.
+ * The view frusta of the capture cameras are rebuilt periodically, cars outside all of them are made insignificant
+ * (lowest LOD, no shadows, no spotlights, reduced tick rate). Before a capture round the capture controller forces
+ * an update, so every car in a captured frame is at full quality.
+ * The subsystem only ticks while it is enabled.
+ */
+UCLASS()
+class TSTOOLKIT_API UCarSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Time between two significance updates, in seconds. */
+	float UpdateInterval = 0.2f;
+
+	/** Distance added to the bounds of a car, so that cars about to enter a view are already significant. */
+	float FrustumMargin = 500.0f;
+
+	/** Distance from a camera beyond which cars are insignificant even inside its view, or zero for no limit. */
+	float MaxSignificantDistance = 0.0f;
+
+private:
+	/** Indicates whether significance is applied. */
+	bool _IsEnabled = false;
+
+	/** Time until the next significance update, in seconds. */
+	float _UpdateCountdown = 0.0f;
+
+	/** Cameras whose views decide which cars are significant. */
+	TArray<TWeakObjectPtr<ACamera>> _CaptureCameras;
+
+	/** View frustum of each capture camera, rebuilt on every update. */
+	TArray<FConvexVolume> _Frusta;
+
+	/** Location of each capture camera, rebuilt on every update. */
+	TArray<FVector> _CameraLocations;
+
+	/** Number of significant cars after the last update. */
+	int32 _SignificantCarsCount = 0;
+
+	/** Number of insignificant cars after the last update. */
+	int32 _InsignificantCarsCount = 0;
+
+public:
+	/**
+	 * Enables significance, or disables it and restores every car to full quality.
+	 *
+	 * @param bEnabled True to apply significance, false otherwise.
+	 */
+	void SetEnabled(bool bEnabled);
+
+	/**
+	 * Sets the cameras whose views decide which cars are significant.
+	 * Without capture cameras all cameras of the traffic registry are used.
+	 *
+	 * @param Cameras The capture cameras.
+	 */
+	void SetCaptureCameras(const TArray<ACamera*>& Cameras);
+
+	/**
+	 * Rebuilds the camera frusta and updates the significance of all cars.
+	 */
+	void UpdateSignificance();
+
+	/**
+	 * Called every frame while significance is enabled. Updates the significance periodically.
+	 *
+	 * @param DeltaTime The simulation time elapsed since the last frame.
+	 */
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Gets whether the subsystem ticks this frame.
+	 *
+	 * @return True while significance is enabled.
+	 */
+	virtual bool IsTickable() const override;
+
+	/**
+	 * Gets the stat id used to profile the subsystem's tick.
+	 *
+	 * @return The stat id of the subsystem.
+	 */
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Gets whether significance is applied.
+	 *
+	 * @return True if significance is enabled, false otherwise.
+	 */
+	FORCEINLINE bool IsEnabled() const
+	{
+		return _IsEnabled;
+	}
+
+private:
+	/**
+	 * Rebuilds the view frustum and location of every capture camera.
+	 */
+	void _BuildFrusta();
+
+	/**
+	 * Checks whether a sphere may be seen by any capture camera.
+	 *
+	 * @param Origin The center of the sphere.
+	 * @param Radius The radius of the sphere.
+	 * @return True if the sphere intersects a camera view, false otherwise.
+	 */
+	bool _IsInAnyView(const FVector& Origin, float Radius) const;
+
+	/**
+	 * Gets the traffic manager of the world from the traffic registry.
+	 *
+	 * @return The traffic manager, or nullptr if the level has none.
+	 */
+	ATrafficManager* _GetTrafficManager() const;
+};
@@ -10,8 +10,8 @@
  */
 ACarSink::ACarSink()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Initialize the sink box component
 	SinkBoxRoot = CreateDefaultSubobject<UBoxComponent>(TEXT("Source Root Box Component"));
@@ -40,19 +40,10 @@ void ACarSink::BeginPlay()
 	SinkBoxRoot->OnComponentBeginOverlap.AddDynamic(this, &ACarSink::_onCarSinkBeginOverlap);
 }
 
-/**
- * Called every frame to update the actor.
- *
- * @param DeltaTime The time elapsed since the last frame.
- */
-void ACarSink::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 /**
  * Handles the event when another actor begins overlapping with the sink box.
  * If the overlapping actor is a car, it marks the car as having reached its destination.
+ * The car is returned to its controller's pool (or destroyed) on its next update.
  *
  * @param OverlappedComponent The component that was overlapped.
  * @param OtherActor The other actor involved in the overlap.
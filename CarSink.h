@@ -35,13 +35,6 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
-	/**
-	 * Called every frame to update the actor.
-	 *
-	 * @param DeltaTime The time elapsed since the last frame.
-	 */
-	virtual void Tick(float DeltaTime) override;
-
 private:
 	/**
 	 * Handles the event when another actor begins overlapping with the sink box.
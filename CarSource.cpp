@@ -1,6 +1,5 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
-#include <numeric>
 #include "CarSource.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/BoxComponent.h"
@@ -8,6 +7,13 @@
 #include "CarPath.h"
 #include "CarSpawnController.h"
 #include "Car.h"
+#include "TrafficManager.h"
+#include "TelemetrySubsystem.h"
+#include "TSToolkit.h"
+#include "TrafficRegistrySubsystem.h"
+#include "CarLightBudgetSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Car"), STAT_SpawnCar, STATGROUP_TSToolkit);
 
 /**
  * Constructor for ACarSource.
@@ -15,8 +21,10 @@
  */
 ACarSource::ACarSource()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
+
+	_RandomStream.GenerateNewSeed();
 
 	// Set up components
 	SourceBoxRoot = CreateDefaultSubobject<UBoxComponent>(TEXT("Source Root Box Component"));
@@ -68,16 +76,48 @@ void ACarSource::BeginPlay()
 
 	// Initialize car paths
 	_InitPath();
+
+	// Bake the spawn distance of this source on every path
+	FVector spawnLocation = SpawnCheckBox->GetComponentLocation();
+	for (ACarPath* path : Paths)
+	{
+		if (path)
+		{
+			path->BakeSpawnDistance(this, spawnLocation);
+		}
+	}
 }
 
 /**
- * Called every frame to update the actor.
+ * Called after the actor's components are initialized.
+ * Registers the car source with the traffic registry before any actor begins play.
+ */
+void ACarSource::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterCarSource(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the car source from the traffic registry.
  *
- * @param DeltaTime The time elapsed since the last frame.
+ * @param EndPlayReason The reason the actor is being removed.
  */
-void ACarSource::Tick(float DeltaTime)
+void ACarSource::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterCarSource(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
@@ -116,6 +156,8 @@ void ACarSource::SpawnDefaultCar()
  */
 void ACarSource::SpawnCar(TSubclassOf<ACar> CarClass)
 {
+	SCOPE_CYCLE_COUNTER(STAT_SpawnCar);
+
 	if (!_CanSpawn)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Cannot spawn car because _CanSpawn is false."));
@@ -135,6 +177,8 @@ void ACarSource::SpawnCar(TSubclassOf<ACar> CarClass)
 		return;
 	}
 
+	FTelemetryScope telemetryScope(world, ETelemetryScopes::Spawn);
+
 	ACarPath* selectedPath = _SelectPath();
 	if (!selectedPath)
 	{
@@ -142,28 +186,97 @@ void ACarSource::SpawnCar(TSubclassOf<ACar> CarClass)
 		return;
 	}
 
-	FActorSpawnParameters spawnParams;
-	spawnParams.Owner = this;
-	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-	// Set up car spawn location and target
-	int lastNodeIndex = selectedPath->Path->GetNumberOfSplinePoints() - 1;
-	FVector carTargetLocation = selectedPath->Path->GetLocationAtSplinePoint(lastNodeIndex, ESplineCoordinateSpace::World);
+	// Set up car spawn location
 	FVector carSpawnLocation = SpawnCheckBox->GetComponentLocation();
 	FRotator carSpawnRotation = SpawnCheckBox->GetComponentRotation();
+	float initDistance = selectedPath->GetSpawnDistance(this, carSpawnLocation);
+
+	_SpawnCarAt(CarClass, selectedPath, initDistance, carSpawnLocation, carSpawnRotation);
+}
+
+/**
+ * Spawns a car of the specified class at a distance along one of the source's paths.
+ * Used to fill the paths before the simulation starts, so it ignores whether the source can spawn.
+ *
+ * @param CarClass The class of the car to spawn.
+ * @param CarPath The path the car follows.
+ * @param Distance The distance along the path at which the car is placed.
+ * @return A pointer to the spawned car, or nullptr if the car could not be spawned.
+ */
+ACar* ACarSource::SpawnCarOnPath(TSubclassOf<ACar> CarClass, ACarPath* CarPath, float Distance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnCar);
+
+	if (!CarClass || !CarPath)
+	{
+		UE_LOG(LogTemp, Error, TEXT("CarClass or CarPath is null in SpawnCarOnPath."));
+		return nullptr;
+	}
+
+	FTelemetryScope telemetryScope(GetWorld(), ETelemetryScopes::Spawn);
+
+	FVector carSpawnLocation;
+	FRotator carSpawnRotation;
+	CarPath->GetTransformAtDistance(Distance, carSpawnLocation, carSpawnRotation);
+
+	return _SpawnCarAt(CarClass, CarPath, Distance, carSpawnLocation, carSpawnRotation);
+}
+
+/**
+ * Spawns a car and initializes it to follow a path from the given distance.
+ *
+ * @param CarClass The class of the car to spawn.
+ * @param CarPath The path the car follows.
+ * @param Distance The distance along the path at which the car starts.
+ * @param Location The world location of the spawned car.
+ * @param Rotation The world rotation of the spawned car.
+ * @return A pointer to the spawned car, or nullptr if the car could not be spawned.
+ */
+ACar* ACarSource::_SpawnCarAt(TSubclassOf<ACar> CarClass, ACarPath* CarPath, float Distance, const FVector& Location, const FRotator& Rotation)
+{
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _SpawnCarAt."));
+		return nullptr;
+	}
+
+	// Set up car target
+	int lastNodeIndex = CarPath->Path->GetNumberOfSplinePoints() - 1;
+	FVector carTargetLocation = CarPath->Path->GetLocationAtSplinePoint(lastNodeIndex, ESplineCoordinateSpace::World);
+
+	// Spawn the car, reusing a pooled one if the source has a controller
+	ACar* spawnedCar = nullptr;
+	if (Controller)
+	{
+		spawnedCar = Controller->AcquireCar(CarClass, Location, Rotation, this);
+	}
+	else
+	{
+		FActorSpawnParameters spawnParams;
+		spawnParams.Owner = this;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		spawnedCar = world->SpawnActor<ACar>(CarClass, Location, Rotation, spawnParams);
+	}
 
-	// Spawn the car
-	ACar* spawnedCar = world->SpawnActor<ACar>(CarClass, carSpawnLocation, carSpawnRotation, spawnParams);
 	if (!spawnedCar)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to spawn car in SpawnCar."));
-		return;
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn car in _SpawnCarAt."));
+		return nullptr;
 	}
 
 	// Initialize car properties
+	spawnedCar->SetRandomSeed(_RandomStream.RandHelper(MAX_int32));
 	spawnedCar->SetDestination(carTargetLocation);
-	spawnedCar->SetPath(selectedPath);
+	spawnedCar->SetPath(CarPath);
 	spawnedCar->StaticSpeed = CarStaticSpeed;
+
+	// Cars start with the emissive proxy, the light budget promotes the ones near the cameras
+	UCarLightBudgetSubsystem* lightBudget = world->GetSubsystem<UCarLightBudgetSubsystem>();
+	if (lightBudget && lightBudget->IsEnabled())
+	{
+		spawnedCar->SetUseSpotLights(false);
+	}
 	if (IsNight)
 	{
 		spawnedCar->TurnLightsOn();
@@ -174,8 +287,21 @@ void ACarSource::SpawnCar(TSubclassOf<ACar> CarClass)
 	}
 
 	// Initialize distance along spline
-	float initDistance = selectedPath->Path->GetDistanceAlongSplineAtLocation(carSpawnLocation, ESplineCoordinateSpace::World);
-	spawnedCar->SetInitDistanceAlongSpline(initDistance);
+	spawnedCar->SetInitDistanceAlongSpline(Distance);
+
+	// Hand the car over to the traffic manager if the level has one
+	ATrafficManager* trafficManager = _GetTrafficManager();
+	if (trafficManager)
+	{
+		trafficManager->RegisterCar(spawnedCar);
+	}
+
+	if (UTelemetrySubsystem* telemetry = world->GetSubsystem<UTelemetrySubsystem>())
+	{
+		telemetry->CountSpawn();
+	}
+
+	return spawnedCar;
 }
 
 /**
@@ -230,60 +356,94 @@ void ACarSource::_OnSpawnCheckEndOverlap(
 	}
 
 	ACar* other = Cast<ACar>(OtherActor);
-	if (other)
+	if (!other)
+	{
+		return;
+	}
+
+	// Another car, or another component of the same car, may still be inside the box
+	TArray<AActor*> overlappingCars;
+	SpawnCheckBox->GetOverlappingActors(overlappingCars, ACar::StaticClass());
+	_CanSpawn = overlappingCars.Num() <= 0;
+
+	if (_CanSpawn)
 	{
-		_CanSpawn = true;
+		OnSpawnCleared.Broadcast(this);
 	}
 }
 
 /**
  * Selects a path for a spawned car to follow based on probabilities.
+ * Sampling the path distribution takes constant time regardless of the number of paths.
  *
- * @return A pointer to the selected car path.
+ * @return A pointer to the selected car path, or nullptr if the source has no valid path.
  */
 ACarPath* ACarSource::_SelectPath()
 {
-	float randNum = FMath::RandRange(0.0f, 1.0f);
-	float cumulative = 0.0f;
-
-	for (ACarPath* path : Paths)
+	int32 index = _PathDistribution.Sample(_RandomStream);
+	if (!Paths.IsValidIndex(index))
 	{
-		if (!path)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("_SelectPath encountered a null path in Paths."));
-			continue;
-		}
-
-		cumulative += path->Probability;
-		if (randNum <= cumulative)
-		{
-			return path;
-		}
+		UE_LOG(LogTemp, Warning, TEXT("_SelectPath failed to select a path."));
+		return nullptr;
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("_SelectPath failed to select a path."));
-	return nullptr;
+	return Paths[index];
 }
 
 /**
- * Initializes the paths for the car source by sorting them based on probabilities.
+ * Initializes the paths for the car source and builds the path distribution.
+ * Probabilities are normalized, so they only need to be proportional to each other.
+ * Null paths are never selected, and if no path has a positive probability all valid paths are equally likely.
  */
 void ACarSource::_InitPath()
 {
+	_PathDistribution.Reset();
+
 	if (Paths.Num() <= 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("_InitPath - no path assignet to the source"));
 		return;
 	}
 
-	if (FMath::Abs(std::accumulate(Paths.begin(), Paths.end(), 0.0f,
-		[](float current, ACarPath* path) {return current + path->Probability; }) - 1.0f) > KINDA_SMALL_NUMBER)
+	TArray<float> weights;
+	weights.Reserve(Paths.Num());
+	float probabilitySum = 0.0f;
+	for (ACarPath* path : Paths)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Warning! Sum of probabilities of car paths is not equal to 1.0."));
+		float weight = path ? FMath::Max(0.0f, path->Probability) : 0.0f;
+		weights.Add(weight);
+		probabilitySum += weight;
 	}
 
-	Paths.Sort([](const ACarPath& left, const ACarPath& right)
-		{
-			return left.Probability < right.Probability;
-		});
+	if (FMath::Abs(probabilitySum - 1.0f) > KINDA_SMALL_NUMBER)
+	{
+		UE_LOG(LogTemp, Log, TEXT("_InitPath: Sum of probabilities of car paths of %s is %f, normalizing."), *GetName(), probabilitySum);
+	}
+
+	if (_PathDistribution.Build(weights))
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("_InitPath: No path of %s has a positive probability, selecting paths uniformly."), *GetName());
+	for (int32 i = 0; i < Paths.Num(); i++)
+	{
+		weights[i] = Paths[i] ? 1.0f : 0.0f;
+	}
+
+	if (!_PathDistribution.Build(weights))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_InitPath: %s has no valid path."), *GetName());
+	}
+}
+
+/**
+ * Gets the traffic manager of the level from the traffic registry.
+ *
+ * @return A pointer to the traffic manager, or nullptr if the level has none.
+ */
+ATrafficManager* ACarSource::_GetTrafficManager() const
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	return registry ? registry->GetTrafficManager() : nullptr;
 }
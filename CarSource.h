@@ -6,8 +6,14 @@
 #include "GameFramework/Actor.h"
 #include "Car.h"
 #include "CarPath.h"
+#include "DiscreteDistribution.h"
 #include "CarSource.generated.h"
 
+class ACarSource;
+
+/** Delegate broadcast when a source's spawn check box no longer overlaps any car. */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnSpawnCleared, ACarSource*);
+
 /**
  * ACarSource is a class representing a source that spawns cars into the simulation.
  * It manages car spawning, path selection, and car behavior customization.
@@ -54,6 +60,13 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Source Details")
 	class ACarSpawnController* Controller = nullptr;
 
+	/** Factor applied to the controller's arrival rate at this source, used by rate-based spawn controllers. */
+	UPROPERTY(EditAnywhere, Category = "Source Details")
+	float SpawnRateMultiplier = 1.0f;
+
+	/** Broadcast when the spawn check box no longer overlaps any car. */
+	FOnSpawnCleared OnSpawnCleared;
+
 	/** Indicates whether it is night time, affecting car behavior. */
 	UPROPERTY(EditAnywhere, Category = "Source Details")
 	bool IsNight = false;
@@ -71,6 +84,12 @@ private:
 	/** Indicates whether the source can currently spawn cars. */
 	bool _CanSpawn = true;
 
+	/** Random stream used for path selection and for seeding spawned cars. */
+	FRandomStream _RandomStream;
+
+	/** Distribution over Paths weighted by the paths' probabilities, built at BeginPlay. */
+	FDiscreteDistribution _PathDistribution;
+
 protected:
 	/**
 	 * Called when the game starts or when the actor is spawned.
@@ -78,14 +97,21 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
-public:
 	/**
-	 * Called every frame to update the actor.
+	 * Called after the actor's components are initialized.
+	 * Registers the car source with the traffic registry before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the car source from the traffic registry.
 	 *
-	 * @param DeltaTime The time elapsed since the last frame.
+	 * @param EndPlayReason The reason the actor is being removed.
 	 */
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+public:
 	/**
 	 * Called when the actor is constructed or properties are changed in the editor.
 	 * Allows for dynamic updates to the actor's properties.
@@ -108,6 +134,27 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void SpawnCar(TSubclassOf<ACar> CarClass);
 
+	/**
+	 * Spawns a car of the specified class at a distance along one of the source's paths.
+	 * Used to fill the paths before the simulation starts, so it ignores whether the source can spawn.
+	 *
+	 * @param CarClass The class of the car to spawn.
+	 * @param CarPath The path the car follows.
+	 * @param Distance The distance along the path at which the car is placed.
+	 * @return A pointer to the spawned car, or nullptr if the car could not be spawned.
+	 */
+	ACar* SpawnCarOnPath(TSubclassOf<ACar> CarClass, ACarPath* CarPath, float Distance);
+
+	/**
+	 * Seeds the source's random stream.
+	 *
+	 * @param Seed The seed of the random stream.
+	 */
+	FORCEINLINE void SetRandomSeed(int32 Seed)
+	{
+		_RandomStream.Initialize(Seed);
+	}
+
 	// Getter and Setter for _CanSpawn
 	/**
 	 * Sets whether the source can spawn cars.
@@ -166,6 +213,18 @@ private:
 		int32 OtherBodyIndex
 	);
 
+	/**
+	 * Spawns a car and initializes it to follow a path from the given distance.
+	 *
+	 * @param CarClass The class of the car to spawn.
+	 * @param CarPath The path the car follows.
+	 * @param Distance The distance along the path at which the car starts.
+	 * @param Location The world location of the spawned car.
+	 * @param Rotation The world rotation of the spawned car.
+	 * @return A pointer to the spawned car, or nullptr if the car could not be spawned.
+	 */
+	ACar* _SpawnCarAt(TSubclassOf<ACar> CarClass, ACarPath* CarPath, float Distance, const FVector& Location, const FRotator& Rotation);
+
 	/**
 	 * Selects a path for a spawned car to follow.
 	 *
@@ -174,7 +233,14 @@ private:
 	ACarPath* _SelectPath();
 
 	/**
-	 * Initializes the paths for the car source.
+	 * Initializes the paths for the car source and builds the path distribution.
 	 */
 	void _InitPath();
+
+	/**
+	 * Gets the traffic manager of the level from the traffic registry.
+	 *
+	 * @return A pointer to the traffic manager, or nullptr if the level has none.
+	 */
+	class ATrafficManager* _GetTrafficManager() const;
 };
\ No newline at end of file
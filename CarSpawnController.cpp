@@ -2,18 +2,18 @@
 
 #include "CarSpawnController.h"
 #include "CarSource.h"
-#include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetMathLibrary.h"
+#include "CarPath.h"
+#include "CriticalZone.h"
+#include "Components/BoxComponent.h"
+#include "Components/SplineComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "HAL/PlatformTime.h"
+#include "TrafficRegistrySubsystem.h"
 
 // Define paths to car blueprints
 TArray<FString> ACarSpawnController::CarBpPaths
 {
-#ifndef NO_LARGE_VEHICLES
-	// Bus
-	TEXT("/Game/BP/Cars/BP_Bus.BP_Bus_C"),
-	// Delivery
-	TEXT("/Game/BP/Cars/BP_Delivery.BP_Delivery_C"),
-#endif
 	// Coupe
 	TEXT("/Game/BP/Cars/Coupe/BP_Coupe.BP_Coupe_C"),
 	TEXT("/Game/BP/Cars/Coupe/BP_RedCoupe.BP_RedCoupe_C"),
@@ -35,48 +35,381 @@ TArray<FString> ACarSpawnController::CarBpPaths
 	TEXT("/Game/BP/Cars/Van/BP_WhiteVan.BP_WhiteVan_C")
 };
 
+// Define paths to large vehicle blueprints
+TArray<FString> ACarSpawnController::LargeVehicleBpPaths
+{
+	// Bus
+	TEXT("/Game/BP/Cars/BP_Bus.BP_Bus_C"),
+	// Delivery
+	TEXT("/Game/BP/Cars/BP_Delivery.BP_Delivery_C")
+};
+
 /**
  * Constructor for ACarSpawnController.
- * Initializes the car blueprint pool by loading classes from predefined paths.
+ * Fills the car catalogue with soft references to the default car blueprints, nothing is loaded here.
  */
 ACarSpawnController::ACarSpawnController()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
 
 	for (const FString& path : CarBpPaths)
 	{
-		ConstructorHelpers::FClassFinder<ACar> classFinder(*path);
-		if (classFinder.Class)
-		{
-			CarBpPool.Add(classFinder.Class);
-		}
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("Failed to load car blueprint at path: %s"), *path);
-		}
+		CarClasses.Add(TSoftClassPtr<ACar>(FSoftObjectPath(path)));
+	}
+
+	for (const FString& path : LargeVehicleBpPaths)
+	{
+		LargeVehicleClasses.Add(TSoftClassPtr<ACar>(FSoftObjectPath(path)));
 	}
 }
 
 /**
  * Called when the game starts or when the actor is spawned.
- * Registers all car sources and sets up the initial round.
+ * Registers all car sources and starts loading the car classes, the first round is set up once they are loaded.
  */
 void ACarSpawnController::BeginPlay()
 {
 	Super::BeginPlay();
 
+	_RandomStream.Initialize(Seed);
+
 	if (bRegisterAllAtBeginPlay)
 	{
 		_RegisterAllSources();
 	}
 
+	_SeedSources();
+	SetNight(_IsNight);
+	_LoadCarClasses();
+}
+
+/**
+ * Called after the actor's components are initialized.
+ * Registers the controller with the traffic registry before any actor begins play.
+ */
+void ACarSpawnController::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterCarSpawnController(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Logs the car pool statistics.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void ACarSpawnController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bUseCarPool)
+	{
+		LogPoolStatistics();
+	}
+
+	if (_CarClassesHandle.IsValid())
+	{
+		_CarClassesHandle->CancelHandle();
+		_CarClassesHandle.Reset();
+	}
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterCarSpawnController(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * Requests an asynchronous load of the car catalogue through the streamable manager.
+ * Large vehicles are only requested if bIncludeLargeVehicles is set.
+ */
+void ACarSpawnController::_LoadCarClasses()
+{
+	TArray<FSoftObjectPath> classPaths;
+	for (const TSoftClassPtr<ACar>& carClass : CarClasses)
+	{
+		if (!carClass.IsNull())
+		{
+			classPaths.AddUnique(carClass.ToSoftObjectPath());
+		}
+	}
+
+	if (bIncludeLargeVehicles)
+	{
+		for (const TSoftClassPtr<ACar>& carClass : LargeVehicleClasses)
+		{
+			if (!carClass.IsNull())
+			{
+				classPaths.AddUnique(carClass.ToSoftObjectPath());
+			}
+		}
+	}
+
+	if (classPaths.Num() <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("_LoadCarClasses: The car catalogue is empty, no cars will be spawned."));
+		_FinishWarmUp();
+		return;
+	}
+
+	_CarClassesLoadStartSeconds = FPlatformTime::Seconds();
+	_CarClassesHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(classPaths,
+		FStreamableDelegate::CreateUObject(this, &ACarSpawnController::_OnCarClassesLoaded));
+
+	if (!_CarClassesHandle.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("_LoadCarClasses: Failed to request loading of %d car classes."), classPaths.Num());
+		_FinishWarmUp();
+	}
+}
+
+/**
+ * Called when the car catalogue finished loading.
+ * Fills CarBpPool with the loaded classes, prewarms the car pool and sets up the first round.
+ */
+void ACarSpawnController::_OnCarClassesLoaded()
+{
+	CarBpPool.Reset();
+
+	if (_CarClassesHandle.IsValid())
+	{
+		TArray<UObject*> loadedAssets;
+		_CarClassesHandle->GetLoadedAssets(loadedAssets);
+
+		for (UObject* asset : loadedAssets)
+		{
+			UClass* carClass = Cast<UClass>(asset);
+			if (carClass && carClass->IsChildOf(ACar::StaticClass()))
+			{
+				CarBpPool.Add(carClass);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("_OnCarClassesLoaded: %s is not a car class."), asset ? *asset->GetPathName() : TEXT("null"));
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("_OnCarClassesLoaded: Loaded %d car classes in %.3f s."),
+		CarBpPool.Num(), FPlatformTime::Seconds() - _CarClassesLoadStartSeconds);
+
+	if (CarBpPool.Num() <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("_OnCarClassesLoaded: No car class was loaded, no cars will be spawned."));
+		_FinishWarmUp();
+		return;
+	}
+
+	_CarClassesLoaded = true;
+	_CarClassDistribution.BuildUniform(CarBpPool.Num());
+
+	if (bUseCarPool)
+	{
+		PrewarmPool();
+	}
+
+	if (!bWarmUp)
+	{
+		_FinishWarmUp();
+	}
+	else
+	{
+		double warmUpStart = FPlatformTime::Seconds();
+		int32 placedCount = _WarmUp();
+		UE_LOG(LogTemp, Log, TEXT("_OnCarClassesLoaded: Warm-up placed %d cars in %.3f s."), placedCount, FPlatformTime::Seconds() - warmUpStart);
+
+		if (WarmUpSettleTime > 0.0f)
+		{
+			FTimerHandle timerHandle;
+			GetWorldTimerManager().SetTimer(timerHandle, this, &ACarSpawnController::_FinishWarmUp, WarmUpSettleTime, false);
+		}
+		else
+		{
+			_FinishWarmUp();
+		}
+	}
+
 	if (Sources.Num() > 0)
 	{
 		_RoundSetUp();
 	}
+}
 
-	SetNight(_IsNight);
+/**
+ * Fills the paths of all sources with cars at the target density.
+ * Every path is split into equal slots and one car is placed at a random distance within each slot,
+ * leaving at least the car length and the safe gap to the next car. The stretch right after the source,
+ * the end of the path and critical zones are left empty so that no car starts blocking a junction or a source.
+ * Paths shared by several sources are filled only once, and paths with zero probability are skipped.
+ *
+ * @return The number of placed cars.
+ */
+int32 ACarSpawnController::_WarmUp()
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!registry)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Traffic registry is null in _WarmUp."));
+		return 0;
+	}
+
+	if (WarmUpDensity <= 0.0f)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_WarmUp: WarmUpDensity is not positive, no cars are placed."));
+		return 0;
+	}
+
+	// Space every car as if it was the longest one
+	float maxCarLength = 0.0f;
+	float maxSafeReach = 0.0f;
+	for (TSubclassOf<ACar> carClass : CarBpPool)
+	{
+		const ACar* defaultCar = carClass ? carClass->GetDefaultObject<ACar>() : nullptr;
+		if (defaultCar)
+		{
+			maxCarLength = FMath::Max(maxCarLength, 2.0f * defaultCar->GetBodyHalfExtent().X);
+			maxSafeReach = FMath::Max(maxSafeReach, defaultCar->GetSafeDistanceReach());
+		}
+	}
+	float minSpacing = maxCarLength + FMath::Max(WarmUpMinGap, maxSafeReach);
+	if (minSpacing <= 0.0f)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_WarmUp: Failed to determine the car length, no cars are placed."));
+		return 0;
+	}
+
+	const TArray<ACriticalZone*>& zones = registry->GetCriticalZones();
+
+	auto isInCriticalZone = [&zones, maxCarLength](const FVector& Location)
+	{
+		for (ACriticalZone* zone : zones)
+		{
+			if (!zone || !zone->BoxComponent)
+			{
+				continue;
+			}
+
+			FVector local = zone->BoxComponent->GetComponentTransform().InverseTransformPosition(Location);
+			FVector extent = zone->BoxComponent->GetUnscaledBoxExtent();
+			FVector scale = zone->BoxComponent->GetComponentTransform().GetScale3D().GetAbs();
+			FVector padding = FVector(maxCarLength) / scale.ComponentMax(FVector(KINDA_SMALL_NUMBER));
+			if (FMath::Abs(local.X) <= extent.X + padding.X
+				&& FMath::Abs(local.Y) <= extent.Y + padding.Y
+				&& FMath::Abs(local.Z) <= extent.Z + padding.Z)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	TSet<ACarPath*> filledPaths;
+	int32 placedCount = 0;
+
+	for (ACarSource* source : Sources)
+	{
+		if (!source || !source->SpawnCheckBox)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("_WarmUp encountered a null source in Sources."));
+			continue;
+		}
+
+		FVector spawnLocation = source->SpawnCheckBox->GetComponentLocation();
+
+		for (ACarPath* path : source->Paths)
+		{
+			if (!path || !path->Path || path->Probability <= 0.0f || filledPaths.Contains(path))
+			{
+				continue;
+			}
+			filledPaths.Add(path);
+
+			float start = path->GetSpawnDistance(source, spawnLocation) + minSpacing;
+			float end = path->Path->GetSplineLength() - minSpacing;
+			float usable = end - start;
+			if (usable <= 0.0f)
+			{
+				continue;
+			}
+
+			// Density is given per 100 m, distances are in centimetres
+			int32 count = FMath::Min(FMath::FloorToInt(usable * WarmUpDensity / 10000.0f), FMath::FloorToInt(usable / minSpacing));
+			if (count <= 0)
+			{
+				continue;
+			}
+
+			float slot = usable / count;
+			for (int32 i = 0; i < count; i++)
+			{
+				float distance = start + i * slot + _RandomStream.FRandRange(0.0f, slot - minSpacing);
+				if (isInCriticalZone(path->GetLocationAtDistance(distance)))
+				{
+					continue;
+				}
+
+				TSubclassOf<ACar> carClass = _GetRandomCarClass();
+				if (carClass && source->SpawnCarOnPath(carClass, path, distance))
+				{
+					placedCount++;
+				}
+			}
+		}
+	}
+
+	return placedCount;
+}
+
+/**
+ * Marks the warm-up as complete and broadcasts OnWarmUpComplete.
+ */
+void ACarSpawnController::_FinishWarmUp()
+{
+	if (_WarmUpComplete)
+	{
+		return;
+	}
+
+	_WarmUpComplete = true;
+	OnWarmUpComplete.Broadcast();
+}
+
+/**
+ * Replaces the car catalogue with the given blueprint class paths.
+ * Must be called before BeginPlay to take effect.
+ *
+ * @param Paths The object paths of the car blueprint classes.
+ */
+void ACarSpawnController::SetCarClassPaths(const TArray<FString>& Paths)
+{
+	CarClasses.Reset();
+	LargeVehicleClasses.Reset();
+
+	for (const FString& path : Paths)
+	{
+		if (path.IsEmpty())
+		{
+			continue;
+		}
+
+		TSoftClassPtr<ACar> carClass{ FSoftObjectPath(path) };
+		if (LargeVehicleBpPaths.Contains(path))
+		{
+			LargeVehicleClasses.Add(carClass);
+		}
+		else
+		{
+			CarClasses.Add(carClass);
+		}
+	}
 }
 
 /**
@@ -84,35 +417,21 @@ void ACarSpawnController::BeginPlay()
  */
 void ACarSpawnController::_RoundSetUp()
 {
-	_TimerRunOut = false;
-
 	if (SpawnRate <= 0.0f)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("SpawnRate is invalid or zero. Timer will not be set."));
 		return;
 	}
 
-	FTimerHandle timerHandle;
-	GetWorldTimerManager().SetTimer(timerHandle, this, &ACarSpawnController::_TimerAction, SpawnRate, false);
+	GetWorldTimerManager().SetTimer(_SpawnTimerHandle, this, &ACarSpawnController::_TimerAction, SpawnRate, false);
 }
 
 /**
  * Called when the spawn timer runs out.
- * Sets the _TimerRunOut flag to true.
+ * The base controller does not spawn any cars, subclasses spawn their cars here and set up the next round.
  */
 void ACarSpawnController::_TimerAction()
 {
-	_TimerRunOut = true;
-}
-
-/**
- * Called every frame to update the actor.
- *
- * @param DeltaTime The time elapsed since the last frame.
- */
-void ACarSpawnController::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
 }
 
 /**
@@ -138,33 +457,56 @@ void ACarSpawnController::SetNight(bool State)
 }
 
 /**
- * Registers all car sources in the simulation by finding all ACarSource actors in the world.
+ * Registers all car sources in the simulation from the traffic registry.
  */
 void ACarSpawnController::_RegisterAllSources()
 {
-	UWorld* world = GetWorld();
-	if (!world)
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!registry)
 	{
-		UE_LOG(LogTemp, Error, TEXT("World is null in _RegisterAllSources."));
+		UE_LOG(LogTemp, Error, TEXT("Traffic registry is null in _RegisterAllSources."));
 		return;
 	}
 
 	Sources.Empty();
 
-	TArray<AActor*> foundActors;
-	UGameplayStatics::GetAllActorsOfClass(world, ACarSource::StaticClass(), foundActors);
-
-	for (AActor* actor : foundActors)
+	for (ACarSource* source : registry->GetCarSources())
 	{
-		ACarSource* source = Cast<ACarSource>(actor);
 		if (source)
 		{
+			source->Controller = this;
 			Sources.Add(source);
 		}
 		else
 		{
-			UE_LOG(LogTemp, Warning, TEXT("_RegisterAllSources encountered a non-ACarSource actor."));
+			UE_LOG(LogTemp, Warning, TEXT("_RegisterAllSources encountered a null source in the registry."));
+		}
+	}
+
+	// Actor iteration order is not stable between runs, sort to keep source selection reproducible
+	Sources.Sort([](const ACarSource& left, const ACarSource& right)
+		{
+			return left.GetName() < right.GetName();
+		});
+}
+
+/**
+ * Seeds the random stream of every source from Seed and the source's name and makes this the source's controller.
+ * Deriving the seed from the name keeps each source's stream independent of the registration order.
+ * Sources assigned in the editor get their controller here too, so they spawn from the car pool.
+ */
+void ACarSpawnController::_SeedSources()
+{
+	for (ACarSource* source : Sources)
+	{
+		if (!source)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("_SeedSources encountered a null source in Sources."));
+			continue;
 		}
+
+		source->Controller = this;
+		source->SetRandomSeed(static_cast<int32>(HashCombine(static_cast<uint32>(Seed), GetTypeHash(source->GetName()))));
 	}
 }
 
@@ -205,13 +547,24 @@ bool ACarSpawnController::_CanSourcesSpawn()
  */
 TSubclassOf<ACar> ACarSpawnController::_GetRandomCarClass()
 {
+	if (!_CarClassesLoaded)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_GetRandomCarClass called before the car classes were loaded."));
+		return nullptr;
+	}
+
 	if (CarBpPool.Num() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("_GetRandomCarClass called but CarBpPool is empty."));
 		return nullptr;
 	}
 
-	int randomIndex = UKismetMathLibrary::RandomInteger(CarBpPool.Num());
+	if (_CarClassDistribution.Num() != CarBpPool.Num())
+	{
+		_CarClassDistribution.BuildUniform(CarBpPool.Num());
+	}
+
+	int randomIndex = _CarClassDistribution.Sample(_RandomStream);
 
 	if (CarBpPool.IsValidIndex(randomIndex))
 	{
@@ -221,3 +574,159 @@ TSubclassOf<ACar> ACarSpawnController::_GetRandomCarClass()
 	UE_LOG(LogTemp, Warning, TEXT("_GetRandomCarClass failed to retrieve a valid car class."));
 	return nullptr;
 }
+
+/**
+ * Acquires a car of the given class, reusing an inactive car from the pool if possible.
+ * Every acquired car gets a new identifier, so reused actors are told apart in the annotations.
+ *
+ * @param CarClass The class of the car to acquire.
+ * @param Location The world location to place the car at.
+ * @param Rotation The world rotation to place the car with.
+ * @param Owner The actor owning a newly spawned car.
+ * @return A pointer to the active car, or nullptr if the car could not be spawned.
+ */
+ACar* ACarSpawnController::AcquireCar(TSubclassOf<ACar> CarClass, const FVector& Location, const FRotator& Rotation, AActor* Owner)
+{
+	if (!CarClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("AcquireCar called with a null CarClass."));
+		return nullptr;
+	}
+
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in AcquireCar."));
+		return nullptr;
+	}
+
+	ACar* car = nullptr;
+	FCarPoolBucket* bucket = bUseCarPool ? _CarPool.Find(CarClass.Get()) : nullptr;
+	while (bucket && bucket->Cars.Num() > 0 && !car)
+	{
+		car = bucket->Cars.Pop(false);
+		if (!IsValid(car))
+		{
+			car = nullptr;
+		}
+	}
+
+	if (car)
+	{
+		_PoolHits++;
+		car->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+		car->ActivateFromPool();
+	}
+	else
+	{
+		_PoolMisses++;
+
+		FActorSpawnParameters spawnParams;
+		spawnParams.Owner = Owner;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		car = world->SpawnActor<ACar>(CarClass, Location, Rotation, spawnParams);
+		if (!car)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to spawn car in AcquireCar."));
+			return nullptr;
+		}
+	}
+
+	car->SetSpawnController(this);
+	car->SetCarId(_NextCarId++);
+	_ActiveCarsCount++;
+	_PeakActiveCarsCount = FMath::Max(_PeakActiveCarsCount, _ActiveCarsCount);
+	return car;
+}
+
+/**
+ * Returns a car to the pool by hiding it and disabling its collision.
+ * The car is destroyed if pooling is disabled.
+ *
+ * @param Car The car to release.
+ */
+void ACarSpawnController::ReleaseCar(ACar* Car)
+{
+	if (!Car)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ReleaseCar called with a null Car."));
+		return;
+	}
+
+	_ActiveCarsCount = FMath::Max(0, _ActiveCarsCount - 1);
+
+	if (!bUseCarPool)
+	{
+		Car->K2_DestroyActor();
+		return;
+	}
+
+	Car->DeactivateToPool();
+	_CarPool.FindOrAdd(Car->GetClass()).Cars.Add(Car);
+	_PoolReleases++;
+}
+
+/**
+ * Spawns PoolPrewarmCount inactive cars for each class in CarBpPool.
+ * Cars are spawned deferred so they never become visible or collide before being pooled.
+ */
+void ACarSpawnController::PrewarmPool()
+{
+	if (PoolPrewarmCount <= 0)
+	{
+		return;
+	}
+
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in PrewarmPool."));
+		return;
+	}
+
+	FTransform spawnTransform = GetActorTransform();
+	for (TSubclassOf<ACar> carClass : CarBpPool)
+	{
+		if (!carClass)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("PrewarmPool encountered a null class in CarBpPool."));
+			continue;
+		}
+
+		FCarPoolBucket& bucket = _CarPool.FindOrAdd(carClass.Get());
+		for (int i = 0; i < PoolPrewarmCount; i++)
+		{
+			ACar* car = world->SpawnActorDeferred<ACar>(carClass, spawnTransform, this, nullptr,
+				ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+			if (!car)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Failed to spawn car in PrewarmPool."));
+				break;
+			}
+
+			car->SetActorHiddenInGame(true);
+			car->SetActorEnableCollision(false);
+			car->FinishSpawning(spawnTransform);
+			car->DeactivateToPool();
+			bucket.Cars.Add(car);
+		}
+	}
+}
+
+/**
+ * Logs the hit, miss and release counts of the car pool.
+ */
+void ACarSpawnController::LogPoolStatistics() const
+{
+	int32 pooledCount = 0;
+	for (const TPair<UClass*, FCarPoolBucket>& pair : _CarPool)
+	{
+		pooledCount += pair.Value.Cars.Num();
+	}
+
+	int32 requests = _PoolHits + _PoolMisses;
+	float hitRate = (requests > 0) ? static_cast<float>(_PoolHits) / requests : 0.0f;
+	UE_LOG(LogTemp, Log, TEXT("Car pool: %d hits, %d misses (hit rate %.2f), %d releases, peak %d active cars, %d pooled cars."),
+		_PoolHits, _PoolMisses, hitRate, _PoolReleases, _PeakActiveCarsCount, pooledCount);
+}
@@ -5,10 +5,28 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Car.h"
+#include "DiscreteDistribution.h"
+#include "Engine/StreamableManager.h"
 #include "CarSpawnController.generated.h"
 
 class ACarSource;
 
+/** Delegate broadcast once the warm-up filled the paths and the simulation is ready for capture. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnWarmUpComplete);
+
+/**
+ * FCarPoolBucket holds the inactive cars of a single car class.
+ */
+USTRUCT()
+struct FCarPoolBucket
+{
+	GENERATED_BODY()
+
+	/** Inactive cars ready to be reused. */
+	UPROPERTY()
+	TArray<ACar*> Cars;
+};
+
 /**
  * ACarSpawnController is responsible for managing car spawning in the simulation.
  * It controls multiple car sources, handles spawn rates, and manages car blueprints.
@@ -37,19 +55,110 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Controller Details")
 	float SpawnRate = 10.0f;
 
-	/** Pool of car blueprints available for spawning. */
+	/** Seed of the controller's random stream, from which the random streams of all sources are derived. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	int32 Seed = 0;
+
+	/** Pool of car blueprints available for spawning, filled once the car catalogue is loaded. */
 	UPROPERTY(VisibleAnywhere, Category = "Controller Details")
 	TArray<TSubclassOf<ACar>> CarBpPool;
 
-	/** Static array of paths to car blueprints. */
+	// Car catalogue details
+	/** Car blueprints loaded at BeginPlay. */
+	UPROPERTY(EditAnywhere, Category = "Car Catalogue Details")
+	TArray<TSoftClassPtr<ACar>> CarClasses;
+
+	/** Large vehicle blueprints, loaded at BeginPlay only if bIncludeLargeVehicles is set. */
+	UPROPERTY(EditAnywhere, Category = "Car Catalogue Details")
+	TArray<TSoftClassPtr<ACar>> LargeVehicleClasses;
+
+	/** Whether large vehicles are spawned. */
+	UPROPERTY(EditAnywhere, Category = "Car Catalogue Details")
+	bool bIncludeLargeVehicles = true;
+
+	/** Static array of paths to the default car blueprints. */
 	static TArray<FString> CarBpPaths;
 
+	/** Static array of paths to the default large vehicle blueprints. */
+	static TArray<FString> LargeVehicleBpPaths;
+
+	// Car pool details
+	/** Whether cars are reused from a pool instead of being spawned and destroyed. */
+	UPROPERTY(EditAnywhere, Category = "Car Pool Details")
+	bool bUseCarPool = true;
+
+	/** Number of inactive cars spawned for each class in CarBpPool at BeginPlay. */
+	UPROPERTY(EditAnywhere, Category = "Car Pool Details")
+	int PoolPrewarmCount = 0;
+
+	// Warm-up details
+	/** Whether the paths are filled with cars before the first spawn round. */
+	UPROPERTY(EditAnywhere, Category = "Warm-up Details")
+	bool bWarmUp = false;
+
+	/** Target number of cars per 100 m of path placed by the warm-up. */
+	UPROPERTY(EditAnywhere, Category = "Warm-up Details")
+	float WarmUpDensity = 2.0f;
+
+	/** Minimum free space kept in front of every car placed by the warm-up, in units. */
+	UPROPERTY(EditAnywhere, Category = "Warm-up Details")
+	float WarmUpMinGap = 300.0f;
+
+	/** Time the simulation runs after the paths are filled before the warm-up is complete, in seconds. */
+	UPROPERTY(EditAnywhere, Category = "Warm-up Details")
+	float WarmUpSettleTime = 0.0f;
+
+	/** Broadcast once the warm-up is complete, or right after the car classes are loaded if warm-up is disabled. */
+	UPROPERTY(BlueprintAssignable, Category = "Warm-up Details")
+	FOnWarmUpComplete OnWarmUpComplete;
+
 protected:
 	/** Indicates whether it is currently night time in the simulation. */
 	bool _IsNight = false;
 
-	/** Indicates whether the spawn timer has run out. */
-	bool _TimerRunOut = false;
+	/** Random stream used for car class and source selection. */
+	FRandomStream _RandomStream;
+
+	/** Distribution over CarBpPool, built once the car catalogue is loaded. */
+	FDiscreteDistribution _CarClassDistribution;
+
+	/** Indicates whether the car catalogue is loaded and cars can be spawned. */
+	bool _CarClassesLoaded = false;
+
+	/** Indicates whether the warm-up is complete. */
+	bool _WarmUpComplete = false;
+
+	/** Handle of the spawn timer armed by _RoundSetUp. */
+	FTimerHandle _SpawnTimerHandle;
+
+private:
+	/** Handle of the asynchronous car catalogue load, keeps the loaded classes referenced. */
+	TSharedPtr<FStreamableHandle> _CarClassesHandle;
+
+	/** Time at which the car catalogue load was requested. */
+	double _CarClassesLoadStartSeconds = 0.0;
+
+	/** Inactive cars per car class. */
+	UPROPERTY()
+	TMap<UClass*, FCarPoolBucket> _CarPool;
+
+	/** Number of cars acquired from the pool. */
+	int32 _PoolHits = 0;
+
+	/** Number of cars that had to be spawned because the pool was empty. */
+	int32 _PoolMisses = 0;
+
+	/** Number of cars returned to the pool. */
+	int32 _PoolReleases = 0;
+
+	/** Number of cars currently acquired and not yet released. */
+	int32 _ActiveCarsCount = 0;
+
+	/** Highest number of cars acquired at the same time. */
+	int32 _PeakActiveCarsCount = 0;
+
+	/** Identifier given to the next acquired car. */
+	int32 _NextCarId = 0;
 
 protected:
 	/**
@@ -58,6 +167,20 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Called after the actor's components are initialized.
+	 * Registers the controller with the traffic registry before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Logs the car pool statistics.
+	 *
+	 * @param EndPlayReason The reason the actor is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Sets up the round by initializing necessary components or states.
 	 */
@@ -65,6 +188,7 @@ protected:
 
 	/**
 	 * Handles actions to be performed when the spawn timer runs out.
+	 * Subclasses spawn their cars here and set up the next round.
 	 */
 	virtual void _TimerAction();
 
@@ -83,13 +207,6 @@ protected:
 	TSubclassOf<ACar> _GetRandomCarClass();
 
 public:
-	/**
-	 * Called every frame to update the actor.
-	 *
-	 * @param DeltaTime The time elapsed since the last frame.
-	 */
-	virtual void Tick(float DeltaTime) override;
-
 	/**
 	 * Checks whether it is currently night time in the simulation.
 	 *
@@ -109,9 +226,115 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void SetNight(bool State);
 
+	/**
+	 * Acquires a car of the given class, reusing an inactive car from the pool if possible.
+	 *
+	 * @param CarClass The class of the car to acquire.
+	 * @param Location The world location to place the car at.
+	 * @param Rotation The world rotation to place the car with.
+	 * @param Owner The actor owning a newly spawned car.
+	 * @return A pointer to the active car, or nullptr if the car could not be spawned.
+	 */
+	ACar* AcquireCar(TSubclassOf<ACar> CarClass, const FVector& Location, const FRotator& Rotation, AActor* Owner);
+
+	/**
+	 * Returns a car to the pool by hiding it and disabling its collision.
+	 * The car is destroyed if pooling is disabled.
+	 *
+	 * @param Car The car to release.
+	 */
+	void ReleaseCar(ACar* Car);
+
+	/**
+	 * Spawns PoolPrewarmCount inactive cars for each class in CarBpPool.
+	 */
+	void PrewarmPool();
+
+	/**
+	 * Replaces the car catalogue with the given blueprint class paths.
+	 * Must be called before BeginPlay to take effect.
+	 *
+	 * @param Paths The object paths of the car blueprint classes.
+	 */
+	void SetCarClassPaths(const TArray<FString>& Paths);
+
+	/**
+	 * Checks whether the car catalogue is loaded and cars can be spawned.
+	 *
+	 * @return True if the car classes are loaded, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool AreCarClassesLoaded() const
+	{
+		return _CarClassesLoaded;
+	}
+
+	/**
+	 * Checks whether the warm-up is complete.
+	 *
+	 * @return True if the warm-up is complete, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool IsWarmUpComplete() const
+	{
+		return _WarmUpComplete;
+	}
+
+	/**
+	 * Logs the hit, miss and release counts of the car pool.
+	 */
+	void LogPoolStatistics() const;
+
+	/**
+	 * Gets the number of cars acquired from the pool.
+	 *
+	 * @return The number of pool hits.
+	 */
+	FORCEINLINE int32 GetPoolHits() const
+	{
+		return _PoolHits;
+	}
+
+	/**
+	 * Gets the number of cars that had to be spawned because the pool was empty.
+	 *
+	 * @return The number of pool misses.
+	 */
+	FORCEINLINE int32 GetPoolMisses() const
+	{
+		return _PoolMisses;
+	}
+
 private:
 	/**
 	 * Registers all car sources in the simulation.
 	 */
 	void _RegisterAllSources();
+
+	/**
+	 * Seeds the random stream of every source from Seed and the source's name and makes this the source's controller.
+	 */
+	void _SeedSources();
+
+	/**
+	 * Requests an asynchronous load of the car catalogue.
+	 */
+	void _LoadCarClasses();
+
+	/**
+	 * Called when the car catalogue finished loading. Sets up the first round.
+	 */
+	void _OnCarClassesLoaded();
+
+	/**
+	 * Fills the paths of all sources with cars at the target density.
+	 *
+	 * @return The number of placed cars.
+	 */
+	int32 _WarmUp();
+
+	/**
+	 * Marks the warm-up as complete and broadcasts OnWarmUpComplete.
+	 */
+	void _FinishWarmUp();
 };
@@ -4,6 +4,11 @@
 #include "Components/BoxComponent.h"
 #include "CarPath.h"
 #include "Car.h"
+#include "TelemetrySubsystem.h"
+#include "TSToolkit.h"
+#include "TrafficRegistrySubsystem.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Reserved Critical Zones"), STAT_ReservedCriticalZones, STATGROUP_TSToolkit);
 
 /**
  * Constructor for ACriticalZone.
@@ -11,8 +16,8 @@
  */
 ACriticalZone::ACriticalZone()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// The zone is driven by the cars entering and leaving it and does not need to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Initialize the box component
 	BoxComponent = CreateDefaultSubobject<UBoxComponent>(TEXT("Critical Zone Box Component"));
@@ -38,26 +43,134 @@ void ACriticalZone::BeginPlay()
 }
 
 /**
- * Called every frame to update the actor.
+ * Called after the actor's components are initialized.
+ * Registers the critical zone with the traffic registry before any actor begins play.
+ */
+void ACriticalZone::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterCriticalZone(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the critical zone from the traffic registry.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void ACriticalZone::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterCriticalZone(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * Checks if a car path may enter the critical zone, that is if it is related to every occupying path.
+ * A path of the compiled network reads its conflict count while no uncompiled path occupies the zone,
+ * otherwise the occupying paths are checked one by one.
+ *
+ * @param Path The car path to check.
+ * @return True if the zone is free or shared only by paths compatible with the path, false otherwise.
+ */
+bool ACriticalZone::CanPathEnter(ACarPath* Path) const
+{
+	if (!Path)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("CanPathEnter called with a null Path."));
+		return false;
+	}
+
+	if (_OccupyingPaths.Num() <= 0)
+	{
+		return true;
+	}
+
+	int32 relationIndex = Path->GetRelationIndex();
+	if (_UncompiledOccupyingCount <= 0 && _ConflictCounts.IsValidIndex(relationIndex))
+	{
+		return _ConflictCounts[relationIndex] <= 0;
+	}
+
+	for (const TPair<ACarPath*, int32>& occupyingPath : _OccupyingPaths)
+	{
+		if (occupyingPath.Key != Path && !occupyingPath.Key->IsPathRelated(Path))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Adds a reference of a car path to the critical zone if the path may enter it.
+ * Reservations are made on the game thread only, from the overlaps of the cars entering the zone.
+ *
+ * @param Path The car path requesting the reservation.
+ * @return True if the path holds the zone, false if a conflicting path occupies it.
+ */
+bool ACriticalZone::TryReserve(ACarPath* Path)
+{
+	if (!Path)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TryReserve called with a null Path."));
+		return false;
+	}
+
+	if (!CanPathEnter(Path))
+	{
+		return false;
+	}
+
+	bool becameReserved = _OccupyingPaths.Num() <= 0;
+	_AddPathReference(Path);
+
+	if (becameReserved)
+	{
+		_ReportReservationChange(true);
+	}
+	return true;
+}
+
+/**
+ * Sets the reservation for the critical zone to a specific car path, replacing any previous reservation.
+ * The admitted cars are dropped from the zone, they no longer hold it when they leave.
+ * Changes of the reserved state are reported to the stat group and the telemetry.
  *
- * @param DeltaTime The time elapsed since the last frame.
+ * @param Path The car path reserving the critical zone, or nullptr to release it.
  */
-void ACriticalZone::Tick(float DeltaTime)
+void ACriticalZone::SetReserved(ACarPath* Path)
 {
-	Super::Tick(DeltaTime);
+	_Occupants.Reset();
 
-	// Debug message to display whether the critical zone is reserved
-	if (GEngine)
+	bool wasReserved = _OccupyingPaths.Num() > 0;
+	_ClearPathReferences();
+	if (Path)
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, FString::Printf(TEXT("IsReserved: %d"), IsReserved()));
+		_AddPathReference(Path);
+	}
+
+	bool isReserved = Path != nullptr;
+	if (wasReserved != isReserved)
+	{
+		_ReportReservationChange(isReserved);
 	}
 }
 
 /**
- * Checks if the critical zone is reserved for a specific car path.
+ * Checks if the critical zone is reserved and may be shared by a specific car path.
  *
  * @param Path The car path to check.
- * @return True if the critical zone is reserved for the specified path, false otherwise.
+ * @return True if the critical zone is reserved and compatible with the specified path, false otherwise.
  */
 bool ACriticalZone::IsReservedForPath(ACarPath* Path)
 {
@@ -67,62 +180,248 @@ bool ACriticalZone::IsReservedForPath(ACarPath* Path)
 		return false;
 	}
 
-	if (!_CurrentPath)
+	return _OccupyingPaths.Num() > 0 && CanPathEnter(Path);
+}
+
+/**
+ * Attempts to end the reservation of the critical zone.
+ * The reservation is released if no admitted car is left in the zone, and the waiting cars are admitted.
+ */
+void ACriticalZone::TryEndReservation()
+{
+	if (!IsReserved())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TryEndReservation called but the zone is not reserved."));
+		return;
+	}
+
+	if (_Occupants.Num() > 0)
 	{
+		return;
+	}
+
+	SetReserved(nullptr);
+	_AdmitWaitingCars();
+}
+
+/**
+ * Admits a car into the zone if its path may enter it.
+ * A car that cannot be admitted is queued and notified once the conflicting paths left.
+ *
+ * @param Car The car entering the zone.
+ * @return True if the car was admitted, false if it has to wait.
+ */
+bool ACriticalZone::TryEnter(ACar* Car)
+{
+	if (!Car)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TryEnter called with a null Car."));
 		return false;
 	}
 
-	if (_CurrentPath == Path)
+	if (_Occupants.Contains(Car))
 	{
 		return true;
 	}
 
-	for (ACarPath* relatedPath : _CurrentPath->RelatedPaths)
+	// The path is kept with the car, the car may move on to the next path before it leaves the zone
+	ACarPath* path = Car->GetPath();
+	if (!TryReserve(path))
 	{
-		if (relatedPath == Path)
-		{
-			return true;
-		}
+		_WaitingCars.AddUnique(Car);
+		return false;
 	}
 
-	return false;
+	_Occupants.Add(Car, path);
+	return true;
 }
 
 /**
- * Attempts to end the reservation of the critical zone.
- * If no cars are overlapping the critical zone, the reservation is released.
+ * Removes a car from the zone's occupants or waiting cars.
+ * Admits the waiting cars once the last car of a path left, since they may no longer conflict with the zone.
+ *
+ * @param Car The car leaving the zone.
  */
-void ACriticalZone::TryEndReservation()
+void ACriticalZone::Leave(ACar* Car)
 {
-	if (!_CurrentPath)
+	_WaitingCars.Remove(Car);
+
+	ACarPath* path = nullptr;
+	if (!_Occupants.RemoveAndCopyValue(Car, path))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("TryEndReservation called but _CurrentPath is null."));
 		return;
 	}
 
-	TArray<AActor*> overlappingActors;
-	GetOverlappingActors(overlappingActors, ACar::StaticClass());
+	bool pathLeft = _RemovePathReference(path);
+	if (pathLeft && _OccupyingPaths.Num() <= 0)
+	{
+		_ReportReservationChange(false);
+	}
+
+	if (_Occupants.Num() <= 0 && IsReserved())
+	{
+		TryEndReservation();
+	}
+	else if (pathLeft)
+	{
+		_AdmitWaitingCars();
+	}
+}
+
+/**
+ * Recounts the conflicts of the occupying paths after the path network was compiled.
+ *
+ * @param PathsCount The number of paths of the compiled network.
+ */
+void ACriticalZone::RebuildPathConflicts(int32 PathsCount)
+{
+	_ConflictCounts.Init(0, FMath::Max(PathsCount, 0));
+	_UncompiledOccupyingCount = 0;
+	for (const TPair<ACarPath*, int32>& occupyingPath : _OccupyingPaths)
+	{
+		_UpdateConflictCounts(occupyingPath.Key, 1);
+	}
+}
 
-	if (overlappingActors.Num() <= 0)
+/**
+ * Admits every waiting car whose path may enter the zone.
+ * Cars that still have to wait keep their order.
+ */
+void ACriticalZone::_AdmitWaitingCars()
+{
+	if (_WaitingCars.Num() <= 0)
 	{
-		_CurrentPath = nullptr;
 		return;
 	}
 
-	for (AActor* actor : overlappingActors)
+	// The list is swapped out first because admitted cars are notified while it is rebuilt
+	TArray<ACar*> waitingCars = MoveTemp(_WaitingCars);
+	_WaitingCars.Reset();
+
+	for (ACar* car : waitingCars)
 	{
-		if (!actor)
+		if (!car)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("TryEndReservation encountered a null actor in overlappingActors."));
+			UE_LOG(LogTemp, Warning, TEXT("_AdmitWaitingCars encountered a null car."));
 			continue;
 		}
 
-		ACar* car = Cast<ACar>(actor);
-		if (car && car->GetPath() == _CurrentPath)
+		if (TryEnter(car))
+		{
+			car->AdmitToCriticalZone(this);
+		}
+	}
+}
+
+/**
+ * Adds a reference of a car path to the zone.
+ * The conflict counts change only when the path starts occupying the zone.
+ *
+ * @param Path The car path occupying the zone.
+ */
+void ACriticalZone::_AddPathReference(ACarPath* Path)
+{
+	int32& referencesCount = _OccupyingPaths.FindOrAdd(Path, 0);
+	referencesCount++;
+	if (referencesCount == 1)
+	{
+		_UpdateConflictCounts(Path, 1);
+	}
+}
+
+/**
+ * Removes a reference of a car path from the zone.
+ * References dropped by a forced reservation are ignored.
+ *
+ * @param Path The car path leaving the zone.
+ * @return True if the last reference of the path was removed, false otherwise.
+ */
+bool ACriticalZone::_RemovePathReference(ACarPath* Path)
+{
+	int32* referencesCount = _OccupyingPaths.Find(Path);
+	if (!referencesCount)
+	{
+		return false;
+	}
+
+	(*referencesCount)--;
+	if (*referencesCount > 0)
+	{
+		return false;
+	}
+
+	_OccupyingPaths.Remove(Path);
+	_UpdateConflictCounts(Path, -1);
+	return true;
+}
+
+/**
+ * Removes every occupying path from the zone.
+ */
+void ACriticalZone::_ClearPathReferences()
+{
+	_OccupyingPaths.Reset();
+	for (int32& conflictsCount : _ConflictCounts)
+	{
+		conflictsCount = 0;
+	}
+	_UncompiledOccupyingCount = 0;
+}
+
+/**
+ * Adds an occupying path to or removes it from the conflict counts.
+ * Every path of the network that is neither the occupying path nor related to it conflicts with it.
+ * A path outside the compiled network is only counted, paths are then checked one by one.
+ *
+ * @param Path The occupying path.
+ * @param Delta One when the path starts occupying the zone, minus one when it stops.
+ */
+void ACriticalZone::_UpdateConflictCounts(ACarPath* Path, int32 Delta)
+{
+	int32 relationIndex = Path->GetRelationIndex();
+	const TBitArray<>& relatedPathBits = Path->GetRelatedPathBits();
+	if (relationIndex == INDEX_NONE)
+	{
+		_UncompiledOccupyingCount += Delta;
+		return;
+	}
+
+	// Zones spawned after the network was compiled size their counts on first use
+	if (_ConflictCounts.Num() < relatedPathBits.Num())
+	{
+		_ConflictCounts.SetNumZeroed(relatedPathBits.Num());
+	}
+
+	for (int32 i = 0; i < relatedPathBits.Num(); i++)
+	{
+		if (i != relationIndex && !relatedPathBits[i])
 		{
-			return;
+			_ConflictCounts[i] += Delta;
 		}
 	}
+}
 
-	_CurrentPath = nullptr;
+/**
+ * Reports a change of the reserved state to the stat group and the telemetry.
+ *
+ * @param bReserved True if the zone became reserved, false if it was released.
+ */
+void ACriticalZone::_ReportReservationChange(bool bReserved)
+{
+	int32 delta = 1;
+	if (bReserved)
+	{
+		INC_DWORD_STAT(STAT_ReservedCriticalZones);
+	}
+	else
+	{
+		DEC_DWORD_STAT(STAT_ReservedCriticalZones);
+		delta = -1;
+	}
+
+	UWorld* world = GetWorld();
+	if (UTelemetrySubsystem* telemetry = world ? world->GetSubsystem<UTelemetrySubsystem>() : nullptr)
+	{
+		telemetry->AddReservedZones(delta);
+	}
 }
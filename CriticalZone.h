@@ -7,9 +7,16 @@
 #include "CarPath.h"
 #include "CriticalZone.generated.h"
 
+class ACar;
+
 /**
  * ACriticalZone represents a critical zone in the simulation where cars may need to wait
  * or reserve access to ensure safe and orderly movement.
+ * The zone is shared by every occupying path that is related to all other occupying paths.
+ * Occupying paths are reference counted and each path of the compiled network keeps a count of the occupying paths
+ * it conflicts with, so checking whether a path may enter takes constant time.
+ * Reservations are made on the game thread from the overlaps of the cars. The traffic manager snapshots
+ * the zones before its parallel phase, so worker threads never touch a zone.
  */
 UCLASS()
 class TSTOOLKIT_API ACriticalZone : public AActor
@@ -34,18 +41,39 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
-private:
-	/** The car path currently reserving this critical zone. */
-	class ACarPath* _CurrentPath;
+	/**
+	 * Called after the actor's components are initialized.
+	 * Registers the critical zone with the traffic registry before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
 
-public:
 	/**
-	 * Called every frame to update the actor.
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the critical zone from the traffic registry.
 	 *
-	 * @param DeltaTime The time elapsed since the last frame.
+	 * @param EndPlayReason The reason the actor is being removed.
 	 */
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/** Paths occupying the zone, mapped to the number of admitted cars and reservations holding each of them. */
+	TMap<ACarPath*, int32> _OccupyingPaths;
+
+	/** Number of occupying paths each path of the compiled network conflicts with, indexed by relation index. */
+	TArray<int32> _ConflictCounts;
+
+	/** Number of occupying paths that are not part of the compiled network. */
+	int32 _UncompiledOccupyingCount = 0;
 
+	/** Cars admitted into the zone that have not left it yet, mapped to the path they were admitted on. */
+	UPROPERTY()
+	TMap<ACar*, ACarPath*> _Occupants;
+
+	/** Cars waiting for the zone to be released, in order of arrival. */
+	UPROPERTY()
+	TArray<ACar*> _WaitingCars;
+
+public:
 	/**
 	 * Checks if the critical zone is currently reserved.
 	 *
@@ -54,33 +82,133 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Critical Zone")
 	FORCEINLINE bool IsReserved() const
 	{
-		return _CurrentPath != nullptr;
+		return _OccupyingPaths.Num() > 0;
 	}
 
 	/**
-	 * Sets the reservation for the critical zone to a specific car path.
+	 * Checks if a car path may enter the critical zone, that is if it is related to every occupying path.
+	 *
+	 * @param Path The car path to check.
+	 * @return True if the zone is free or shared only by paths compatible with the path, false otherwise.
+	 */
+	bool CanPathEnter(ACarPath* Path) const;
+
+	/**
+	 * Adds a reference of a car path to the critical zone if the path may enter it.
+	 *
+	 * @param Path The car path requesting the reservation.
+	 * @return True if the path holds the zone, false if a conflicting path occupies it.
+	 */
+	bool TryReserve(ACarPath* Path);
+
+	/**
+	 * Sets the reservation for the critical zone to a specific car path, replacing any previous reservation.
+	 * The admitted cars are dropped from the zone.
 	 *
 	 * @param Path The car path reserving the critical zone.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Critical Zone")
-	FORCEINLINE void SetReserved(ACarPath* Path)
-	{
-		_CurrentPath = Path;
-	}
+	void SetReserved(ACarPath* Path);
 
 	/**
-	 * Checks if the critical zone is reserved for a specific car path.
+	 * Checks if the critical zone is reserved and may be shared by a specific car path.
 	 *
 	 * @param Path The car path to check.
-	 * @return True if the critical zone is reserved for the specified path, false otherwise.
+	 * @return True if the critical zone is reserved and compatible with the specified path, false otherwise.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Critical Zone")
 	bool IsReservedForPath(ACarPath* Path);
 
 	/**
 	 * Attempts to end the reservation of the critical zone.
-	 * If the critical zone is reserved, it will release the reservation.
+	 * The reservation is released if no admitted car is left in the zone.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Critical Zone")
 	void TryEndReservation();
+
+	/**
+	 * Admits a car into the zone if its path may enter it.
+	 * A car that cannot be admitted is queued and notified once the conflicting paths left.
+	 *
+	 * @param Car The car entering the zone.
+	 * @return True if the car was admitted, false if it has to wait.
+	 */
+	bool TryEnter(ACar* Car);
+
+	/**
+	 * Removes a car from the zone's occupants or waiting cars.
+	 * Admits the waiting cars once the last car of a path left.
+	 *
+	 * @param Car The car leaving the zone.
+	 */
+	void Leave(ACar* Car);
+
+	/**
+	 * Recounts the conflicts of the occupying paths after the path network was compiled.
+	 *
+	 * @param PathsCount The number of paths of the compiled network.
+	 */
+	void RebuildPathConflicts(int32 PathsCount);
+
+	/**
+	 * Gets the number of cars admitted into the zone.
+	 *
+	 * @return The number of occupants.
+	 */
+	FORCEINLINE int32 GetOccupantsCount() const
+	{
+		return _Occupants.Num();
+	}
+
+	/**
+	 * Gets the number of cars waiting for the zone.
+	 *
+	 * @return The number of waiting cars.
+	 */
+	FORCEINLINE int32 GetWaitingCarsCount() const
+	{
+		return _WaitingCars.Num();
+	}
+
+private:
+	/**
+	 * Admits every waiting car whose path may enter the zone.
+	 * Cars that still have to wait keep their order.
+	 */
+	void _AdmitWaitingCars();
+
+	/**
+	 * Adds a reference of a car path to the zone.
+	 *
+	 * @param Path The car path occupying the zone.
+	 */
+	void _AddPathReference(ACarPath* Path);
+
+	/**
+	 * Removes a reference of a car path from the zone.
+	 *
+	 * @param Path The car path leaving the zone.
+	 * @return True if the last reference of the path was removed, false otherwise.
+	 */
+	bool _RemovePathReference(ACarPath* Path);
+
+	/**
+	 * Removes every occupying path from the zone.
+	 */
+	void _ClearPathReferences();
+
+	/**
+	 * Adds an occupying path to or removes it from the conflict counts.
+	 *
+	 * @param Path The occupying path.
+	 * @param Delta One when the path starts occupying the zone, minus one when it stops.
+	 */
+	void _UpdateConflictCounts(ACarPath* Path, int32 Delta);
+
+	/**
+	 * Reports a change of the reserved state to the stat group and the telemetry.
+	 *
+	 * @param bReserved True if the zone became reserved, false if it was released.
+	 */
+	void _ReportReservationChange(bool bReserved);
 };
@@ -1,12 +1,151 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
-
 #include "DiscreteDistribution.h"
 
-DiscreteDistribution::DiscreteDistribution()
+/**
+ * Builds the alias table from the given weights.
+ * Every column is split between its own index and one alias, so sampling needs a single column draw
+ * and a single coin flip regardless of the number of indices.
+ *
+ * @param Weights The weight of each index.
+ * @return True if the distribution can be sampled, false if no weight is positive.
+ */
+bool FDiscreteDistribution::Build(const TArray<float>& Weights)
 {
+	Reset();
+
+	const int32 count = Weights.Num();
+	double total = 0.0;
+	for (float weight : Weights)
+	{
+		if (FMath::IsFinite(weight) && weight > 0.0f)
+		{
+			total += weight;
+		}
+	}
+
+	if (count <= 0 || total <= 0.0)
+	{
+		return false;
+	}
+
+	_Probabilities.SetNumUninitialized(count);
+	_Aliases.SetNumUninitialized(count);
+	_Normalized.SetNumUninitialized(count);
+
+	TArray<double> scaled;
+	scaled.SetNumUninitialized(count);
+	TArray<int32> small;
+	TArray<int32> large;
+	small.Reserve(count);
+	large.Reserve(count);
+
+	for (int32 i = 0; i < count; i++)
+	{
+		double weight = (FMath::IsFinite(Weights[i]) && Weights[i] > 0.0f) ? Weights[i] : 0.0;
+		_Normalized[i] = (float)(weight / total);
+		scaled[i] = weight * count / total;
+		_Aliases[i] = i;
+
+		if (scaled[i] < 1.0)
+		{
+			small.Add(i);
+		}
+		else
+		{
+			large.Add(i);
+		}
+	}
+
+	while (small.Num() > 0 && large.Num() > 0)
+	{
+		int32 less = small.Pop(false);
+		int32 more = large.Pop(false);
+
+		_Probabilities[less] = (float)scaled[less];
+		_Aliases[less] = more;
+
+		scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+		if (scaled[more] < 1.0)
+		{
+			small.Add(more);
+		}
+		else
+		{
+			large.Add(more);
+		}
+	}
+
+	// Whatever is left is 1 up to rounding error, except zero weights which must never be kept
+	int32 heaviest = 0;
+	for (int32 i = 1; i < count; i++)
+	{
+		if (_Normalized[i] > _Normalized[heaviest])
+		{
+			heaviest = i;
+		}
+	}
+
+	for (int32 index : large)
+	{
+		_Probabilities[index] = 1.0f;
+	}
+	for (int32 index : small)
+	{
+		_Probabilities[index] = (_Normalized[index] > 0.0f) ? 1.0f : 0.0f;
+		_Aliases[index] = (_Normalized[index] > 0.0f) ? index : heaviest;
+	}
+
+	return true;
+}
+
+/**
+ * Builds a uniform distribution over the given number of indices.
+ *
+ * @param Count The number of indices.
+ * @return True if the distribution can be sampled, false if Count is not positive.
+ */
+bool FDiscreteDistribution::BuildUniform(int32 Count)
+{
+	TArray<float> weights;
+	weights.Init(1.0f, FMath::Max(0, Count));
+	return Build(weights);
+}
+
+/**
+ * Removes all indices from the distribution.
+ */
+void FDiscreteDistribution::Reset()
+{
+	_Probabilities.Reset();
+	_Aliases.Reset();
+	_Normalized.Reset();
+}
+
+/**
+ * Samples an index from the distribution.
+ *
+ * @param Stream The random stream to draw from.
+ * @return The sampled index, or INDEX_NONE if the distribution is empty.
+ */
+int32 FDiscreteDistribution::Sample(FRandomStream& Stream) const
+{
+	if (_Probabilities.Num() <= 0)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 column = Stream.RandHelper(_Probabilities.Num());
+	return (Stream.GetFraction() < _Probabilities[column]) ? column : _Aliases[column];
 }
 
-DiscreteDistribution::~DiscreteDistribution()
+/**
+ * Gets the normalized probability of an index.
+ *
+ * @param Index The index to look up.
+ * @return The probability of the index, or 0 if the index is out of range.
+ */
+float FDiscreteDistribution::GetProbability(int32 Index) const
 {
+	return _Normalized.IsValidIndex(Index) ? _Normalized[Index] : 0.0f;
 }
@@ -1,12 +1,83 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #pragma once
-#include "UObject/NoExportTypes.h"
+
 #include "CoreMinimal.h"
 
-class TSTOOLKIT_API DiscreteDistribution : public UObject
+/**
+ * FDiscreteDistribution samples indices from a discrete probability distribution in constant time.
+ * The distribution is built once from a set of non-negative weights using Vose's alias method,
+ * the weights are normalized automatically and do not need to sum to 1.
+ * Sampling draws from a caller-provided random stream, so results are reproducible for a given seed.
+ */
+class TSTOOLKIT_API FDiscreteDistribution
 {
 public:
-	DiscreteDistribution();
-	~DiscreteDistribution();
+	/**
+	 * Builds the alias table from the given weights.
+	 * Negative and non-finite weights are treated as zero, an index with zero weight is never sampled.
+	 *
+	 * @param Weights The weight of each index.
+	 * @return True if the distribution can be sampled, false if no weight is positive.
+	 */
+	bool Build(const TArray<float>& Weights);
+
+	/**
+	 * Builds a uniform distribution over the given number of indices.
+	 *
+	 * @param Count The number of indices.
+	 * @return True if the distribution can be sampled, false if Count is not positive.
+	 */
+	bool BuildUniform(int32 Count);
+
+	/**
+	 * Removes all indices from the distribution.
+	 */
+	void Reset();
+
+	/**
+	 * Samples an index from the distribution.
+	 *
+	 * @param Stream The random stream to draw from.
+	 * @return The sampled index, or INDEX_NONE if the distribution is empty.
+	 */
+	int32 Sample(FRandomStream& Stream) const;
+
+	/**
+	 * Gets the normalized probability of an index.
+	 *
+	 * @param Index The index to look up.
+	 * @return The probability of the index, or 0 if the index is out of range.
+	 */
+	float GetProbability(int32 Index) const;
+
+	/**
+	 * Gets the number of indices in the distribution.
+	 *
+	 * @return The number of indices.
+	 */
+	FORCEINLINE int32 Num() const
+	{
+		return _Probabilities.Num();
+	}
+
+	/**
+	 * Checks whether the distribution can be sampled.
+	 *
+	 * @return True if the distribution has at least one index with a positive weight.
+	 */
+	FORCEINLINE bool IsValid() const
+	{
+		return _Probabilities.Num() > 0;
+	}
+
+private:
+	/** Probability of keeping the drawn column instead of taking its alias. */
+	TArray<float> _Probabilities;
+
+	/** Alias index of each column. */
+	TArray<int32> _Aliases;
+
+	/** Normalized weight of each index. */
+	TArray<float> _Normalized;
 };
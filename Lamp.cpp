@@ -3,6 +3,7 @@
 #include "Lamp.h"
 #include "WeatherController.h"
 #include "Components/SpotLightComponent.h"
+#include "TrafficRegistrySubsystem.h"
 
 /**
  * Constructor for ALamp.
@@ -56,6 +57,38 @@ void ALamp::BeginPlay()
 	}
 }
 
+/**
+ * Called after the actor's components are initialized.
+ * Registers the lamp with the traffic registry before any actor begins play.
+ */
+void ALamp::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterLamp(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the lamp from the traffic registry.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void ALamp::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterLamp(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 /**
  * Turns the lamp on by enabling the spotlight component and setting its intensity.
  */
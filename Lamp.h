@@ -45,6 +45,20 @@ public:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Called after the actor's components are initialized.
+	 * Registers the lamp with the traffic registry before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the lamp from the traffic registry.
+	 *
+	 * @param EndPlayReason The reason the actor is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Turns the lamp on by enabling the spotlight component.
 	 */
@@ -63,6 +63,50 @@ public:
 		return _SimConfig->SimulationDuration;
 	}
 
+	/**
+	 * Gets whether the simulation uses the configured seed.
+	 *
+	 * @return True if the simulation is seeded, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsSeeded() const
+	{
+		return _SimConfig->bIsSeeded;
+	}
+
+	/**
+	 * Gets the seed of the simulation.
+	 *
+	 * @return The seed of all random streams of the simulation.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE int32 GetSeed() const
+	{
+		return _SimConfig->Seed;
+	}
+
+	/**
+	 * Gets the fixed simulation time step.
+	 *
+	 * @return The fixed time step in seconds, or zero if the frame time is used.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE float GetFixedTimeStep() const
+	{
+		return _SimConfig->FixedTimeStep;
+	}
+
+	/**
+	 * Gets whether cars move with the car following model.
+	 *
+	 * @return True if the car following model is enabled, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsCarFollowingModelEnabled() const
+	{
+		return _SimConfig->bIsCarFollowingModelEnabled;
+	}
+
 	/**
 	 * Gets the car spawn controller class name.
 	 *
@@ -96,6 +140,83 @@ public:
 		return _SimConfig->CarsSpawnRate;
 	}
 
+	/**
+	 * Gets the demand schedule of the Poisson controller.
+	 *
+	 * @return The demand schedule periods.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE TArray<FDemandPeriod> GetDemandSchedule() const
+	{
+		return _SimConfig->DemandSchedule;
+	}
+
+	/**
+	 * Gets the maximum number of arrivals waiting at a blocked source with the Poisson controller.
+	 *
+	 * @return The maximum spawn backlog.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE int32 GetMaxSpawnBacklog() const
+	{
+		return _SimConfig->MaxSpawnBacklog;
+	}
+
+	/**
+	 * Gets the object paths of the car blueprint classes to spawn.
+	 *
+	 * @return The car class paths, empty if the default car catalogue is used.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE TArray<FString> GetCarClassPaths() const
+	{
+		return _SimConfig->CarClassPaths;
+	}
+
+	/**
+	 * Checks if large vehicles are spawned.
+	 *
+	 * @return True if large vehicles are spawned, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsLargeVehiclesIncluded() const
+	{
+		return _SimConfig->bIsLargeVehiclesIncluded;
+	}
+
+	/**
+	 * Checks if the paths are filled with cars before the first screenshot round.
+	 *
+	 * @return True if the warm-up is enabled, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsWarmUpEnabled() const
+	{
+		return _SimConfig->bIsWarmUpEnabled;
+	}
+
+	/**
+	 * Gets the target number of cars per 100 m of path placed by the warm-up.
+	 *
+	 * @return The warm-up density.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE float GetWarmUpDensity() const
+	{
+		return _SimConfig->WarmUpDensity;
+	}
+
+	/**
+	 * Gets the time the simulation runs after the warm-up before screenshots start.
+	 *
+	 * @return The warm-up settle time in seconds.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE float GetWarmUpSettleTime() const
+	{
+		return _SimConfig->WarmUpSettleTime;
+	}
+
 	/**
 	 * Gets the screenshot interval.
 	 *
@@ -118,6 +239,39 @@ public:
 		return _SimConfig->DelayBetweenScreenshots;
 	}
 
+	/**
+	 * Checks if the simulation runs in accelerated time between screenshot rounds.
+	 *
+	 * @return True if accelerated time is enabled, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsAcceleratedTime() const
+	{
+		return _SimConfig->bIsAcceleratedTime;
+	}
+
+	/**
+	 * Gets the speed-up factor used between screenshot rounds.
+	 *
+	 * @return The accelerated time dilation.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE float GetAcceleratedTimeDilation() const
+	{
+		return _SimConfig->AcceleratedTimeDilation;
+	}
+
+	/**
+	 * Gets the maximum number of screenshots written in the background at the same time.
+	 *
+	 * @return The screenshot queue depth.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE int32 GetScreenshotQueueDepth() const
+	{
+		return _SimConfig->ScreenshotQueueDepth;
+	}
+
 	/**
 	 * Checks if the simulation starts at night.
 	 *
@@ -151,6 +305,105 @@ public:
 		return _SimConfig->bIsRain;
 	}
 
+	/**
+	 * Gets the cloudiness the simulation starts with.
+	 *
+	 * @return The cloudiness, 0 for a clear sky and 1 for an overcast sky.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE float GetCloudiness() const
+	{
+		return _SimConfig->Cloudiness;
+	}
+
+	/**
+	 * Gets the rain intensity the simulation starts with.
+	 *
+	 * @return The rain intensity, 0 for no rain and 1 for full rain.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE float GetRainIntensity() const
+	{
+		return _SimConfig->RainIntensity;
+	}
+
+	/**
+	 * Gets the duration of weather transitions.
+	 *
+	 * @return The transition duration, in seconds.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE float GetWeatherTransitionDuration() const
+	{
+		return _SimConfig->WeatherTransitionDuration;
+	}
+
+	/**
+	 * Checks if only the cars closest to the capture cameras render their headlights with spotlights.
+	 *
+	 * @return True if the light budget is enabled, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsLightBudgetEnabled() const
+	{
+		return _SimConfig->bIsLightBudgetEnabled;
+	}
+
+	/**
+	 * Gets the maximum number of cars rendering their headlights with spotlights.
+	 *
+	 * @return The maximum number of cars with spotlights.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE int32 GetMaxSpotLightCars() const
+	{
+		return _SimConfig->MaxSpotLightCars;
+	}
+
+	/**
+	 * Gets the frame time the light budget adapts to.
+	 *
+	 * @return The target frame time, in milliseconds.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE float GetLightBudgetTargetFrameTime() const
+	{
+		return _SimConfig->LightBudgetTargetFrameTime;
+	}
+
+	/**
+	 * Checks if cars no capture camera sees are rendered at reduced quality between captures.
+	 *
+	 * @return True if car significance is enabled, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsCarSignificanceEnabled() const
+	{
+		return _SimConfig->bIsCarSignificanceEnabled;
+	}
+
+	/**
+	 * Checks if cars no capture camera sees are drawn through instanced meshes.
+	 *
+	 * @return True if instanced rendering is enabled, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsInstancedRenderingEnabled() const
+	{
+		return _SimConfig->bIsInstancedRenderingEnabled;
+	}
+
+	/**
+	 * Checks if every screenshot is accompanied by a ground truth annotation record.
+	 *
+	 * @return True if annotations are written, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsAnnotationEnabled() const
+	{
+		return _SimConfig->bIsAnnotationEnabled;
+	}
+
 	/**
 	 * Checks if the simulation changes day and night dynamically.
 	 *
@@ -217,6 +470,17 @@ public:
 		return _SimConfig->ChangeRainRate;
 	}
 
+	/**
+	 * Checks if performance telemetry is recorded for the run.
+	 *
+	 * @return True if telemetry is recorded, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool GetIsTelemetryEnabled() const
+	{
+		return _SimConfig->bIsTelemetryEnabled;
+	}
+
 	// Setters
 
 	/**
@@ -241,6 +505,50 @@ public:
 		_SimConfig->SimulationDuration = Value;
 	}
 
+	/**
+	 * Sets whether the simulation uses the configured seed.
+	 *
+	 * @param Value True if the simulation is seeded, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsSeeded(bool Value)
+	{
+		_SimConfig->bIsSeeded = Value;
+	}
+
+	/**
+	 * Sets the seed of the simulation.
+	 *
+	 * @param Value The seed of all random streams of the simulation.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetSeed(int32 Value)
+	{
+		_SimConfig->Seed = Value;
+	}
+
+	/**
+	 * Sets the fixed simulation time step.
+	 *
+	 * @param Value The fixed time step in seconds, or zero to use the frame time.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetFixedTimeStep(float Value)
+	{
+		_SimConfig->FixedTimeStep = FMath::Max(0.0f, Value);
+	}
+
+	/**
+	 * Sets whether cars move with the car following model.
+	 *
+	 * @param Value True to enable the car following model, false to stop cars instantly.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsCarFollowingModelEnabled(bool Value)
+	{
+		_SimConfig->bIsCarFollowingModelEnabled = Value;
+	}
+
 	/**
 	 * Sets the car spawn controller class name.
 	 *
@@ -274,6 +582,83 @@ public:
 		_SimConfig->CarsSpawnRate = Value;
 	}
 
+	/**
+	 * Sets the demand schedule of the Poisson controller.
+	 *
+	 * @param Value The demand schedule periods.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetDemandSchedule(const TArray<FDemandPeriod>& Value)
+	{
+		_SimConfig->DemandSchedule = Value;
+	}
+
+	/**
+	 * Sets the maximum number of arrivals waiting at a blocked source with the Poisson controller.
+	 *
+	 * @param Value The maximum spawn backlog, at least 0.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetMaxSpawnBacklog(int32 Value)
+	{
+		_SimConfig->MaxSpawnBacklog = FMath::Max(0, Value);
+	}
+
+	/**
+	 * Sets the object paths of the car blueprint classes to spawn.
+	 *
+	 * @param Value The car class paths, or an empty array to use the default car catalogue.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetCarClassPaths(const TArray<FString>& Value)
+	{
+		_SimConfig->CarClassPaths = Value;
+	}
+
+	/**
+	 * Sets whether large vehicles are spawned.
+	 *
+	 * @param Value True to spawn large vehicles, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsLargeVehiclesIncluded(bool Value)
+	{
+		_SimConfig->bIsLargeVehiclesIncluded = Value;
+	}
+
+	/**
+	 * Sets whether the paths are filled with cars before the first screenshot round.
+	 *
+	 * @param Value True to enable the warm-up, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsWarmUpEnabled(bool Value)
+	{
+		_SimConfig->bIsWarmUpEnabled = Value;
+	}
+
+	/**
+	 * Sets the target number of cars per 100 m of path placed by the warm-up.
+	 *
+	 * @param Value The warm-up density, at least 0.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetWarmUpDensity(float Value)
+	{
+		_SimConfig->WarmUpDensity = FMath::Max(0.0f, Value);
+	}
+
+	/**
+	 * Sets the time the simulation runs after the warm-up before screenshots start.
+	 *
+	 * @param Value The warm-up settle time in seconds, at least 0.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetWarmUpSettleTime(float Value)
+	{
+		_SimConfig->WarmUpSettleTime = FMath::Max(0.0f, Value);
+	}
+
 	/**
 	 * Sets the screenshot interval.
 	 *
@@ -296,6 +681,39 @@ public:
 		_SimConfig->DelayBetweenScreenshots = Value;
 	}
 
+	/**
+	 * Sets whether the simulation runs in accelerated time between screenshot rounds.
+	 *
+	 * @param Value True to enable accelerated time, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsAcceleratedTime(bool Value)
+	{
+		_SimConfig->bIsAcceleratedTime = Value;
+	}
+
+	/**
+	 * Sets the speed-up factor used between screenshot rounds.
+	 *
+	 * @param Value The accelerated time dilation, at least 1.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetAcceleratedTimeDilation(float Value)
+	{
+		_SimConfig->AcceleratedTimeDilation = FMath::Max(1.0f, Value);
+	}
+
+	/**
+	 * Sets the maximum number of screenshots written in the background at the same time.
+	 *
+	 * @param Value The screenshot queue depth, at least 1.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetScreenshotQueueDepth(int32 Value)
+	{
+		_SimConfig->ScreenshotQueueDepth = FMath::Max(1, Value);
+	}
+
 	/**
 	 * Sets whether the simulation starts at night.
 	 *
@@ -316,6 +734,7 @@ public:
 	FORCEINLINE void SetIsOvercast(bool Value)
 	{
 		_SimConfig->bIsOvercast = Value;
+		_SimConfig->Cloudiness = Value ? 1.0f : 0.0f;
 	}
 
 	/**
@@ -327,6 +746,108 @@ public:
 	FORCEINLINE void SetIsRain(bool Value)
 	{
 		_SimConfig->bIsRain = Value;
+		_SimConfig->RainIntensity = Value ? 1.0f : 0.0f;
+	}
+
+	/**
+	 * Sets the cloudiness the simulation starts with, also updating the overcast flag.
+	 *
+	 * @param Value The cloudiness, clamped to 0..1.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetCloudiness(float Value)
+	{
+		_SimConfig->Cloudiness = FMath::Clamp(Value, 0.0f, 1.0f);
+		_SimConfig->bIsOvercast = _SimConfig->Cloudiness >= 0.5f;
+	}
+
+	/**
+	 * Sets the rain intensity the simulation starts with, also updating the rain flag.
+	 *
+	 * @param Value The rain intensity, clamped to 0..1.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetRainIntensity(float Value)
+	{
+		_SimConfig->RainIntensity = FMath::Clamp(Value, 0.0f, 1.0f);
+		_SimConfig->bIsRain = _SimConfig->RainIntensity >= 0.5f;
+	}
+
+	/**
+	 * Sets the duration of weather transitions.
+	 *
+	 * @param Value The transition duration, in seconds. Zero switches the weather immediately.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetWeatherTransitionDuration(float Value)
+	{
+		_SimConfig->WeatherTransitionDuration = FMath::Max(0.0f, Value);
+	}
+
+	/**
+	 * Sets whether only the cars closest to the capture cameras render their headlights with spotlights.
+	 *
+	 * @param Value True to enable the light budget, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsLightBudgetEnabled(bool Value)
+	{
+		_SimConfig->bIsLightBudgetEnabled = Value;
+	}
+
+	/**
+	 * Sets the maximum number of cars rendering their headlights with spotlights.
+	 *
+	 * @param Value The maximum number of cars with spotlights.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetMaxSpotLightCars(int32 Value)
+	{
+		_SimConfig->MaxSpotLightCars = FMath::Max(0, Value);
+	}
+
+	/**
+	 * Sets the frame time the light budget adapts to.
+	 *
+	 * @param Value The target frame time, in milliseconds. Zero keeps the budget at the maximum.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetLightBudgetTargetFrameTime(float Value)
+	{
+		_SimConfig->LightBudgetTargetFrameTime = FMath::Max(0.0f, Value);
+	}
+
+	/**
+	 * Sets whether cars no capture camera sees are rendered at reduced quality between captures.
+	 *
+	 * @param Value True to enable car significance, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsCarSignificanceEnabled(bool Value)
+	{
+		_SimConfig->bIsCarSignificanceEnabled = Value;
+	}
+
+	/**
+	 * Sets whether cars no capture camera sees are drawn through instanced meshes.
+	 *
+	 * @param Value True to enable instanced rendering, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsInstancedRenderingEnabled(bool Value)
+	{
+		_SimConfig->bIsInstancedRenderingEnabled = Value;
+	}
+
+	/**
+	 * Sets whether every screenshot is accompanied by a ground truth annotation record.
+	 *
+	 * @param Value True to write annotations, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsAnnotationEnabled(bool Value)
+	{
+		_SimConfig->bIsAnnotationEnabled = Value;
 	}
 
 	/**
@@ -395,6 +916,17 @@ public:
 		_SimConfig->ChangeRainRate = Value;
 	}
 
+	/**
+	 * Sets whether performance telemetry is recorded for the run.
+	 *
+	 * @param Value True to record telemetry, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE void SetIsTelemetryEnabled(bool Value)
+	{
+		_SimConfig->bIsTelemetryEnabled = Value;
+	}
+
 	// Additional functions
 
 	/**
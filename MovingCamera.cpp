@@ -2,6 +2,10 @@
 
 #include "MovingCamera.h"
 #include "Camera/CameraComponent.h"
+#include "TSToolkit.h"
+
+DECLARE_CYCLE_STAT(TEXT("Moving Camera"), STAT_MovingCamera, STATGROUP_TSToolkit);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Moving Camera Distance"), STAT_MovingCameraDistance, STATGROUP_TSToolkit);
 
 /**
  * Constructor for AMovingCamera.
@@ -84,6 +88,8 @@ void AMovingCamera::OnConstruction(const FTransform& Transform)
  */
 void AMovingCamera::_MoveAlongSpline(float Speed, float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_MovingCamera);
+
 	if (!CameraPath)
 	{
 		UE_LOG(LogTemp, Error, TEXT("CameraPath is null in _MoveAlongSpline."));
@@ -93,10 +99,7 @@ void AMovingCamera::_MoveAlongSpline(float Speed, float DeltaTime)
 	_CurrentDistance += (_DistanceDirection * (Speed * DeltaTime));
 	_SetLocationOnSpline(_CurrentDistance);
 
-	if (GEngine)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, FString::Printf(TEXT("Distance: %f, Target: %f"), _CurrentDistance, _CurrentTargetDistance));
-	}
+	SET_FLOAT_STAT(STAT_MovingCameraDistance, _CurrentDistance);
 
 	if (!FMath::IsNearlyEqual(_CurrentDistance, _CurrentTargetDistance, _DistanceTolerance))
 	{
@@ -112,10 +115,7 @@ void AMovingCamera::_MoveAlongSpline(float Speed, float DeltaTime)
 		_ReverseMovement();
 	}
 
-	if (GEngine)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, FString::Printf(TEXT("Switch: %f, Target: %f"), _CurrentDistance, _CurrentTargetDistance));
-	}
+	UE_LOG(LogTemp, Verbose, TEXT("_MoveAlongSpline: Switched at %f, target %f."), _CurrentDistance, _CurrentTargetDistance);
 }
 
 /**
@@ -144,10 +144,7 @@ void AMovingCamera::_ReverseMovement()
 		return;
 	}
 
-	if (GEngine)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, TEXT("Reverse movement"));
-	}
+	UE_LOG(LogTemp, Verbose, TEXT("_ReverseMovement: Reversing movement of %s."), *CameraName);
 
 	_DistanceDirection *= -1;
 	_CurrentTargetDistance = (_DistanceDirection < 0)
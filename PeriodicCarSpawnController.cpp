@@ -22,21 +22,11 @@ void APeriodicCarSpawnController::BeginPlay()
 }
 
 /**
- * Called every frame to update the actor.
- * Handles periodic car spawning logic.
- *
- * @param DeltaTime The time elapsed since the last frame.
+ * Called when the spawn timer runs out.
+ * Handles periodic car spawning logic and sets up the next round.
  */
-void APeriodicCarSpawnController::Tick(float DeltaTime)
+void APeriodicCarSpawnController::_TimerAction()
 {
-	Super::Tick(DeltaTime);
-
-	// Check if the timer has run out
-	if (!_TimerRunOut)
-	{
-		return;
-	}
-
 	// Spawn cars at all sources and reset the round
 	_SpawnAtAllSources();
 	_RoundSetUp();
@@ -25,19 +25,16 @@ public:
 
 protected:
 	/**
-	 * Called when the game starts or when the actor is spawned.
-	 * Used for initialization logic specific to periodic car spawning.
+	 * Called when the spawn timer runs out.
+	 * Handles periodic car spawning logic and sets up the next round.
 	 */
-	virtual void BeginPlay() override;
+	virtual void _TimerAction() override;
 
-public:
 	/**
-	 * Called every frame to update the actor.
-	 * Handles periodic car spawning logic.
-	 *
-	 * @param DeltaTime The time elapsed since the last frame.
+	 * Called when the game starts or when the actor is spawned.
+	 * Used for initialization logic specific to periodic car spawning.
 	 */
-	virtual void Tick(float DeltaTime) override;
+	virtual void BeginPlay() override;
 
 private:
 	/**
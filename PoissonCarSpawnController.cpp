@@ -0,0 +1,280 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PoissonCarSpawnController.h"
+#include "CarSource.h"
+
+/**
+ * Orders pending arrivals by time, then by source so that equal times pop in a reproducible order.
+ */
+static bool ArrivalIsEarlier(float LeftTime, int32 LeftSource, float RightTime, int32 RightSource)
+{
+	return (LeftTime != RightTime) ? LeftTime < RightTime : LeftSource < RightSource;
+}
+
+/**
+ * Constructor for APoissonCarSpawnController.
+ * The controller is driven by its arrival timer and does not tick.
+ */
+APoissonCarSpawnController::APoissonCarSpawnController()
+	: Super()
+{
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Logs the arrival statistics.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void APoissonCarSpawnController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	int32 backlogCount = 0;
+	for (int32 backlog : _Backlogs)
+	{
+		backlogCount += backlog;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Poisson spawn controller: %d arrivals spawned, %d dropped, %d still waiting."),
+		_SpawnedCount, _DroppedCount, backlogCount);
+
+	for (ACarSource* source : Sources)
+	{
+		if (source)
+		{
+			source->OnSpawnCleared.RemoveAll(this);
+		}
+	}
+
+	GetWorldTimerManager().ClearTimer(_ArrivalTimer);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * Schedules the first arrival of every source and binds to the sources' spawn cleared events.
+ * The rate bound of each source is the highest rate the demand schedule can reach.
+ */
+void APoissonCarSpawnController::_RoundSetUp()
+{
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _RoundSetUp."));
+		return;
+	}
+
+	if (SpawnRate <= 0.0f)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SpawnRate is invalid or zero. No arrivals will be scheduled."));
+		return;
+	}
+
+	DemandSchedule.Sort([](const FDemandPeriod& left, const FDemandPeriod& right)
+		{
+			return left.StartTime < right.StartTime;
+		});
+
+	float maxMultiplier = (DemandSchedule.Num() > 0 && DemandSchedule[0].StartTime <= 0.0f) ? 0.0f : 1.0f;
+	for (const FDemandPeriod& period : DemandSchedule)
+	{
+		maxMultiplier = FMath::Max(maxMultiplier, period.RateMultiplier);
+	}
+
+	_Arrivals.Reset();
+	_Backlogs.Init(0, Sources.Num());
+	_MaxRates.Init(0.0f, Sources.Num());
+
+	float now = world->GetTimeSeconds();
+	for (int32 i = 0; i < Sources.Num(); i++)
+	{
+		ACarSource* source = Sources[i];
+		if (!source)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("_RoundSetUp encountered a null source in Sources."));
+			continue;
+		}
+
+		source->OnSpawnCleared.RemoveAll(this);
+		source->OnSpawnCleared.AddUObject(this, &APoissonCarSpawnController::_OnSourceCleared);
+
+		_MaxRates[i] = FMath::Max(0.0f, source->SpawnRateMultiplier) * maxMultiplier / SpawnRate;
+		_ScheduleArrival(i, now);
+	}
+
+	_ArmTimer();
+}
+
+/**
+ * Gets the arrival rate multiplier of the demand schedule at a simulation time.
+ *
+ * @param Time The simulation time, in seconds.
+ * @return The rate multiplier of the period containing the time, or 1 before the first period.
+ */
+float APoissonCarSpawnController::GetDemandMultiplier(float Time) const
+{
+	float multiplier = 1.0f;
+	for (const FDemandPeriod& period : DemandSchedule)
+	{
+		if (period.StartTime > Time)
+		{
+			break;
+		}
+
+		multiplier = FMath::Max(0.0f, period.RateMultiplier);
+	}
+
+	return multiplier;
+}
+
+/**
+ * Gets the arrival rate of a source at a simulation time.
+ *
+ * @param SourceIndex The index of the source in Sources.
+ * @param Time The simulation time, in seconds.
+ * @return The arrival rate, in cars per second.
+ */
+float APoissonCarSpawnController::_GetRate(int32 SourceIndex, float Time) const
+{
+	const ACarSource* source = Sources.IsValidIndex(SourceIndex) ? Sources[SourceIndex] : nullptr;
+	if (!source || SpawnRate <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return FMath::Max(0.0f, source->SpawnRateMultiplier) * GetDemandMultiplier(Time) / SpawnRate;
+}
+
+/**
+ * Schedules the next candidate arrival of a source after a given time.
+ * Candidates are drawn at the source's rate bound; whether a candidate becomes an arrival is decided
+ * when it is due, which makes the process follow the time-varying rate exactly (thinning).
+ *
+ * @param SourceIndex The index of the source in Sources.
+ * @param Time The simulation time after which the arrival is scheduled, in seconds.
+ */
+void APoissonCarSpawnController::_ScheduleArrival(int32 SourceIndex, float Time)
+{
+	if (!_MaxRates.IsValidIndex(SourceIndex) || _MaxRates[SourceIndex] <= 0.0f)
+	{
+		return;
+	}
+
+	// 1 - GetFraction() lies in (0, 1], so the logarithm is finite
+	float interval = -FMath::Loge(1.0f - _RandomStream.GetFraction()) / _MaxRates[SourceIndex];
+	FPendingArrival arrival{ Time + interval, SourceIndex };
+	_Arrivals.HeapPush(arrival, [](const FPendingArrival& left, const FPendingArrival& right)
+		{
+			return ArrivalIsEarlier(left.Time, left.SourceIndex, right.Time, right.SourceIndex);
+		});
+}
+
+/**
+ * Arms the arrival timer for the earliest candidate arrival.
+ */
+void APoissonCarSpawnController::_ArmTimer()
+{
+	UWorld* world = GetWorld();
+	if (!world || _Arrivals.Num() <= 0)
+	{
+		return;
+	}
+
+	float delay = FMath::Max(KINDA_SMALL_NUMBER, _Arrivals.HeapTop().Time - world->GetTimeSeconds());
+	GetWorldTimerManager().SetTimer(_ArrivalTimer, this, &APoissonCarSpawnController::_OnArrivalTimer, delay, false);
+}
+
+/**
+ * Handles all candidate arrivals that are due, spawning the accepted ones.
+ * Every handled candidate schedules the next candidate of its source, so each source always has one in the queue.
+ */
+void APoissonCarSpawnController::_OnArrivalTimer()
+{
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _OnArrivalTimer."));
+		return;
+	}
+
+	auto predicate = [](const FPendingArrival& left, const FPendingArrival& right)
+		{
+			return ArrivalIsEarlier(left.Time, left.SourceIndex, right.Time, right.SourceIndex);
+		};
+
+	float now = world->GetTimeSeconds();
+	while (_Arrivals.Num() > 0 && _Arrivals.HeapTop().Time <= now)
+	{
+		FPendingArrival arrival;
+		_Arrivals.HeapPop(arrival, predicate, false);
+
+		int32 index = arrival.SourceIndex;
+		_ScheduleArrival(index, arrival.Time);
+
+		// Thinning, accept the candidate with the ratio of the current rate to the bound
+		if (_RandomStream.GetFraction() * _MaxRates[index] >= _GetRate(index, arrival.Time))
+		{
+			continue;
+		}
+
+		if (_Backlogs[index] >= MaxBacklog)
+		{
+			_DroppedCount++;
+			UE_LOG(LogTemp, Verbose, TEXT("_OnArrivalTimer: Backlog of %s is full, dropping an arrival."), *Sources[index]->GetName());
+			continue;
+		}
+
+		_Backlogs[index]++;
+		_SpawnBacklog(index);
+	}
+
+	_ArmTimer();
+}
+
+/**
+ * Spawns the next car waiting at a source if the source is clear.
+ * Only one car is spawned per call because the spawned car blocks the spawn check box,
+ * the rest of the backlog is spawned from the following clear events.
+ *
+ * @param SourceIndex The index of the source in Sources.
+ */
+void APoissonCarSpawnController::_SpawnBacklog(int32 SourceIndex)
+{
+	ACarSource* source = Sources.IsValidIndex(SourceIndex) ? Sources[SourceIndex] : nullptr;
+	if (!source || !_Backlogs.IsValidIndex(SourceIndex))
+	{
+		return;
+	}
+
+	if (_Backlogs[SourceIndex] <= 0 || !source->GetCanSpawn())
+	{
+		return;
+	}
+
+	TSubclassOf<ACar> carClass = _GetRandomCarClass();
+	if (!carClass)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_SpawnBacklog failed to get a valid car class."));
+		return;
+	}
+
+	_Backlogs[SourceIndex]--;
+	_SpawnedCount++;
+	source->SpawnCar(carClass);
+}
+
+/**
+ * Called when a source's spawn check box no longer overlaps any car.
+ *
+ * @param Source The source that cleared.
+ */
+void APoissonCarSpawnController::_OnSourceCleared(ACarSource* Source)
+{
+	int32 index = Sources.Find(Source);
+	if (index == INDEX_NONE)
+	{
+		return;
+	}
+
+	_SpawnBacklog(index);
+}
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CarSpawnController.h"
+#include "PoissonCarSpawnController.generated.h"
+
+/**
+ * FDemandPeriod is a single period of a piecewise constant demand schedule.
+ * The period lasts from its start time until the start time of the next period.
+ */
+USTRUCT(BlueprintType)
+struct FDemandPeriod
+{
+	GENERATED_BODY()
+
+	/** Simulation time at which the period starts, in seconds. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Demand")
+	float StartTime = 0.0f;
+
+	/** Factor applied to the arrival rate of every source during the period. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Demand")
+	float RateMultiplier = 1.0f;
+};
+
+/**
+ * APoissonCarSpawnController spawns cars at every source as an independent Poisson process.
+ * The mean time between arrivals at a source is SpawnRate divided by the source's rate multiplier,
+ * and the rate of all sources varies over time according to DemandSchedule.
+ * Arrivals that find the source blocked are kept in a bounded backlog and spawned once the source clears.
+ * All scheduled arrivals are kept in a single priority queue driving a single timer.
+ */
+UCLASS()
+class TSTOOLKIT_API APoissonCarSpawnController : public ACarSpawnController
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Default constructor for APoissonCarSpawnController.
+	 * The controller is driven by its arrival timer and does not tick.
+	 */
+	APoissonCarSpawnController();
+
+	/** Piecewise constant demand schedule, sorted by start time at BeginPlay. An empty schedule keeps the base rate. */
+	UPROPERTY(EditAnywhere, Category = "Poisson Details")
+	TArray<FDemandPeriod> DemandSchedule;
+
+	/** Maximum number of arrivals waiting at a blocked source. Further arrivals are dropped. */
+	UPROPERTY(EditAnywhere, Category = "Poisson Details")
+	int32 MaxBacklog = 5;
+
+private:
+	/**
+	 * FPendingArrival is a candidate arrival at a source.
+	 */
+	struct FPendingArrival
+	{
+		/** Simulation time of the arrival, in seconds. */
+		float Time;
+
+		/** Index of the source in Sources. */
+		int32 SourceIndex;
+	};
+
+	/** Candidate arrivals of all sources, kept as a min-heap on time. */
+	TArray<FPendingArrival> _Arrivals;
+
+	/** Number of arrivals waiting at each source. */
+	TArray<int32> _Backlogs;
+
+	/** Upper bound of the arrival rate of each source, used for thinning. */
+	TArray<float> _MaxRates;
+
+	/** Timer firing at the earliest candidate arrival. */
+	FTimerHandle _ArrivalTimer;
+
+	/** Number of arrivals spawned. */
+	int32 _SpawnedCount = 0;
+
+	/** Number of arrivals dropped because the backlog was full. */
+	int32 _DroppedCount = 0;
+
+protected:
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Logs the arrival statistics.
+	 *
+	 * @param EndPlayReason The reason the actor is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/**
+	 * Schedules the first arrival of every source and binds to the sources' spawn cleared events.
+	 */
+	virtual void _RoundSetUp() override;
+
+public:
+	/**
+	 * Gets the arrival rate multiplier of the demand schedule at a simulation time.
+	 *
+	 * @param Time The simulation time, in seconds.
+	 * @return The rate multiplier of the period containing the time, or 1 before the first period.
+	 */
+	float GetDemandMultiplier(float Time) const;
+
+private:
+	/**
+	 * Gets the arrival rate of a source at a simulation time.
+	 *
+	 * @param SourceIndex The index of the source in Sources.
+	 * @param Time The simulation time, in seconds.
+	 * @return The arrival rate, in cars per second.
+	 */
+	float _GetRate(int32 SourceIndex, float Time) const;
+
+	/**
+	 * Schedules the next candidate arrival of a source after a given time.
+	 *
+	 * @param SourceIndex The index of the source in Sources.
+	 * @param Time The simulation time after which the arrival is scheduled, in seconds.
+	 */
+	void _ScheduleArrival(int32 SourceIndex, float Time);
+
+	/**
+	 * Arms the arrival timer for the earliest candidate arrival.
+	 */
+	void _ArmTimer();
+
+	/**
+	 * Handles all candidate arrivals that are due, spawning the accepted ones.
+	 */
+	void _OnArrivalTimer();
+
+	/**
+	 * Spawns the next car waiting at a source if the source is clear.
+	 *
+	 * @param SourceIndex The index of the source in Sources.
+	 */
+	void _SpawnBacklog(int32 SourceIndex);
+
+	/**
+	 * Called when a source's spawn check box no longer overlaps any car.
+	 *
+	 * @param Source The source that cleared.
+	 */
+	void _OnSourceCleared(ACarSource* Source);
+};
@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Puddle.h"
+#include "TrafficRegistrySubsystem.h"
 
 /**
  * Constructor for APuddle.
@@ -21,6 +22,38 @@ void APuddle::BeginPlay()
 	Super::BeginPlay();
 }
 
+/**
+ * Called after the actor's components are initialized.
+ * Registers the puddle with the traffic registry before any actor begins play.
+ */
+void APuddle::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterPuddle(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the puddle from the traffic registry.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void APuddle::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterPuddle(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 /**
  * Called every frame to update the actor.
  *
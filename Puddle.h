@@ -31,6 +31,20 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Called after the actor's components are initialized.
+	 * Registers the puddle with the traffic registry before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the puddle from the traffic registry.
+	 *
+	 * @param EndPlayReason The reason the actor is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	/**
 	 * Called every frame to update the actor.
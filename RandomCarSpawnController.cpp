@@ -5,21 +5,11 @@
 #include "Engine/Engine.h"
 
 /**
- * Called every frame to update the actor.
- * Handles random car spawning logic.
- *
- * @param DeltaTime The time elapsed since the last frame.
+ * Called when the spawn timer runs out.
+ * Handles random car spawning logic and sets up the next round.
  */
-void ARandomCarSpawnController::Tick(float DeltaTime)
+void ARandomCarSpawnController::_TimerAction()
 {
-	Super::Tick(DeltaTime);
-
-	// Check if the timer has run out
-	if (!_TimerRunOut)
-	{
-		return;
-	}
-
 	// Spawn a car at a random source and reset the round
 	_SpawnCar();
 	_RoundSetUp();
@@ -32,6 +22,8 @@ void ARandomCarSpawnController::Tick(float DeltaTime)
 void ARandomCarSpawnController::BeginPlay()
 {
 	Super::BeginPlay();
+
+	_SourceDistribution.BuildUniform(Sources.Num());
 }
 
 /**
@@ -47,7 +39,18 @@ ACarSource* ARandomCarSpawnController::_GetRandomSource()
 		return nullptr;
 	}
 
-	int index = FMath::RandRange(0, Sources.Num() - 1);
+	if (_SourceDistribution.Num() != Sources.Num())
+	{
+		_SourceDistribution.BuildUniform(Sources.Num());
+	}
+
+	int index = _SourceDistribution.Sample(_RandomStream);
+	if (!Sources.IsValidIndex(index))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_GetRandomSource failed to select a source."));
+		return nullptr;
+	}
+
 	ACarSource* randomSource = Sources[index];
 	if (!randomSource)
 	{
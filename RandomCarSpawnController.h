@@ -25,16 +25,16 @@ public:
 	{
 	}
 
-public:
+protected:
+	/** Distribution over Sources, built at BeginPlay. */
+	FDiscreteDistribution _SourceDistribution;
+
 	/**
-	 * Called every frame to update the actor.
-	 * Handles random car spawning logic.
-	 *
-	 * @param DeltaTime The time elapsed since the last frame.
+	 * Called when the spawn timer runs out.
+	 * Handles random car spawning logic and sets up the next round.
 	 */
-	virtual void Tick(float DeltaTime) override;
+	virtual void _TimerAction() override;
 
-protected:
 	/**
 	 * Called when the game starts or when the actor is spawned.
 	 * Used for initialization logic specific to random car spawning.
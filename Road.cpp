@@ -11,8 +11,8 @@
  */
 ARoad::ARoad()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Create and attach the spline component
 	RoadSpline = CreateDefaultSubobject<USplineComponent>(TEXT("RoadSpline"));
@@ -44,16 +44,6 @@ void ARoad::BeginPlay()
 	}
 }
 
-/**
- * Called every frame to update the actor.
- *
- * @param DeltaTime The time elapsed since the last frame.
- */
-void ARoad::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 /**
  * Called when the actor is constructed or properties are changed in the editor.
  * Sets up the road's mesh based on the spline and other properties.
@@ -54,13 +54,6 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
-	/**
-	 * Called every frame to update the actor.
-	 *
-	 * @param DeltaTime The time elapsed since the last frame.
-	 */
-	virtual void Tick(float DeltaTime) override;
-
 	/**
 	 * Called when the actor is constructed or properties are changed in the editor.
 	 * Sets up the road's mesh based on the spline and other properties.
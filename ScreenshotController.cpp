@@ -4,7 +4,43 @@
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "Engine/GameEngine.h"
+#include "Engine/GameViewportClient.h"
+#include "GameFramework/WorldSettings.h"
+#include "UnrealClient.h"
+#include "Misc/Paths.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
 #include "Camera.h"
+#include "Car.h"
+#include "CarPath.h"
+#include "Components/BoxComponent.h"
+#include "TrafficLights.h"
+#include "TrafficManager.h"
+#include "WeatherController.h"
+#include "TelemetrySubsystem.h"
+#include "TrafficRegistrySubsystem.h"
+#include "CarLightBudgetSubsystem.h"
+#include "CarSignificanceSubsystem.h"
+#include "CaptureManifestSubsystem.h"
+#include "TSToolkit.h"
+
+DECLARE_CYCLE_STAT(TEXT("Screenshot Capture"), STAT_ScreenshotCapture, STATGROUP_TSToolkit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Screenshot Queue Depth"), STAT_ScreenshotQueueDepth, STATGROUP_TSToolkit);
+
+/** Clip space W of the near plane the annotated car boxes are clipped against, in units in front of the camera. */
+static const float AnnotationNearClipW = 1.0f;
+
+/**
+ * Projects a clip space point in front of the camera to normalized image coordinates.
+ *
+ * @param ClipPoint The point in clip space.
+ * @return The point in the image, with the origin in the top left corner and [0, 1] covering the image.
+ */
+static FVector2D ProjectClipPoint(const FVector4& ClipPoint)
+{
+	return FVector2D(0.5f + 0.5f * ClipPoint.X / ClipPoint.W, 0.5f - 0.5f * ClipPoint.Y / ClipPoint.W);
+}
 
 /**
  * Constructor for AScreenshotController.
@@ -29,10 +65,91 @@ void AScreenshotController::BeginPlay()
 		_RegisterAllCameras();
 	}
 
+	UCarSignificanceSubsystem* significance = GetWorld()->GetSubsystem<UCarSignificanceSubsystem>();
+	if (significance)
+	{
+		significance->SetCaptureCameras(Cameras);
+	}
+
+	// Render target captures are always written by the writer, viewport screenshots only in async mode
+	if (bAsyncScreenshots || bUseRenderTargetCapture)
+	{
+		_ScreenshotWriter = MakeUnique<FAsyncScreenshotWriter>(MaxScreenshotQueueDepth);
+	}
+
+	if (bWriteAnnotations)
+	{
+		_AnnotationWriter = MakeUnique<FAsyncAnnotationWriter>();
+	}
+
+	// Take over encoding and writing of viewport screenshots
+	if (bAsyncScreenshots)
+	{
+		_ScreenshotCapturedHandle = UGameViewportClient::OnScreenshotCaptured().AddUObject(this, &AScreenshotController::_OnScreenshotCaptured);
+	}
+
+	if (bStartCaptureAtBeginPlay)
+	{
+		StartCapture();
+	}
+}
+
+/**
+ * Starts the screenshot timer. Does nothing if capturing has already started.
+ * Used to hold the first screenshot round back until the simulation is warmed up.
+ */
+void AScreenshotController::StartCapture()
+{
+	if (_CaptureStarted)
+	{
+		return;
+	}
+
+	_CaptureStarted = true;
 	_ResetScreenshotValues();
 	_ResetTimer();
 }
 
+/**
+ * Called when the actor is being removed from the level.
+ * Restores real time and world rendering and waits for the queued screenshots.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void AScreenshotController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	_SetAccelerated(false);
+
+	if (_ScreenshotCapturedHandle.IsValid())
+	{
+		UGameViewportClient::OnScreenshotCaptured().Remove(_ScreenshotCapturedHandle);
+		_ScreenshotCapturedHandle.Reset();
+	}
+
+	// Finish the capture round in flight so its screenshots are not lost
+	if (_PendingReadbacks.IsValid())
+	{
+		_ReadbackFence.Wait();
+		_CompleteReadback();
+	}
+
+	if (_ScreenshotWriter)
+	{
+		_ScreenshotWriter->Flush();
+		_ScreenshotWriter->LogStatistics();
+		_ScreenshotWriter.Reset();
+	}
+
+	if (_AnnotationWriter)
+	{
+		_AnnotationWriter->Flush();
+		_AnnotationWriter->LogStatistics();
+		_AnnotationWriter.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 /**
  * Resets internal values related to screenshot tracking.
  */
@@ -46,15 +163,24 @@ void AScreenshotController::_ResetScreenshotValues()
 
 /**
  * Handles actions to be performed when the screenshot timer runs out.
- * Sets the _TimerRunOut flag to true.
+ * Sets the _TimerRunOut flag to true and returns to real time so the capture frames are rendered.
+ * Cars seen by the capture cameras are promoted to full quality a frame before the first capture.
  */
 void AScreenshotController::_TimerAction()
 {
 	_TimerRunOut = true;
+	_SetAccelerated(false);
+
+	UCarSignificanceSubsystem* significance = GetWorld()->GetSubsystem<UCarSignificanceSubsystem>();
+	if (significance && significance->IsEnabled())
+	{
+		significance->UpdateSignificance();
+	}
 }
 
 /**
- * Resets the screenshot timer to the configured interval.
+ * Resets the screenshot timer to the configured interval and appends the manifest rows of the finished round.
+ * The interval is measured in simulation time, so in accelerated time it passes faster than real time.
  */
 void AScreenshotController::_ResetTimer()
 {
@@ -65,9 +191,21 @@ void AScreenshotController::_ResetTimer()
 		return;
 	}
 
+	// Index the finished round, so an interrupted run loses at most the round in progress
+	UCaptureManifestSubsystem* manifest = world->GetSubsystem<UCaptureManifestSubsystem>();
+	if (manifest)
+	{
+		manifest->Flush();
+	}
+
 	FTimerHandle timerHandle;
 	_TimerRunOut = false;
 	GetWorldTimerManager().SetTimer(timerHandle, this, &AScreenshotController::_TimerAction, ScreenshotInterval, false);
+
+	if (bAcceleratedTime)
+	{
+		_SetAccelerated(true);
+	}
 }
 
 /**
@@ -80,44 +218,87 @@ void AScreenshotController::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (_ScreenshotWriter)
+	{
+		_ScreenshotWriter->CollectCompleted();
+
+		const FAsyncScreenshotStats& stats = _ScreenshotWriter->GetStats();
+		if (stats.FrameCompletedCount > 0)
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("Screenshot writer: %d written this frame, encode %.2f ms, %lld bytes, queue depth %d."),
+				stats.FrameCompletedCount, stats.FrameEncodeSeconds * 1000.0, stats.FrameBytesWritten, stats.QueueDepth);
+		}
+
+		SET_DWORD_STAT(STAT_ScreenshotQueueDepth, stats.QueueDepth);
+		UWorld* world = GetWorld();
+		if (UTelemetrySubsystem* telemetry = world ? world->GetSubsystem<UTelemetrySubsystem>() : nullptr)
+		{
+			telemetry->SetScreenshotQueueDepth(stats.QueueDepth);
+		}
+	}
+
 	if (Cameras.Num() <= 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("No cameras registered in Tick."));
 		return;
 	}
 
-	if (_TimerRunOut)
+	if (!_TimerRunOut)
 	{
-		_CurrentCameraCountdown -= DeltaTime;
+		return;
+	}
 
-		if (_ScreenshotsTakenCount == Cameras.Num())
-		{
-			_ResetScreenshotValues();
-			_ResetTimer();
-			return;
-		}
+	SCOPE_CYCLE_COUNTER(STAT_ScreenshotCapture);
+	FTelemetryScope telemetryScope(GetWorld(), ETelemetryScopes::Capture);
+
+	if (bUseRenderTargetCapture)
+	{
+		_TickRenderTargetCapture();
+		return;
+	}
+
+	_CurrentCameraCountdown -= DeltaTime;
+
+	if (_ScreenshotsTakenCount == Cameras.Num())
+	{
+		_ResetScreenshotValues();
+		_ResetTimer();
+		return;
+	}
 
-		if (_CurrentCameraCountdown <= 0)
+	if (_CurrentCameraCountdown <= 0)
+	{
+		_CurrentCameraIndex++;
+		if (Cameras.IsValidIndex(_CurrentCameraIndex))
 		{
-			_CurrentCameraIndex++;
-			if (Cameras.IsValidIndex(_CurrentCameraIndex))
+			_CurrentCamera = Cameras[_CurrentCameraIndex];
+			if (!_CurrentCamera)
 			{
-				_CurrentCamera = Cameras[_CurrentCameraIndex];
-				if (!_CurrentCamera)
-				{
-					UE_LOG(LogTemp, Warning, TEXT("Current camera is null in Tick."));
-					return;
-				}
-
-				_CurrentCameraCountdown = DelayBetweenScreenshots;
-				_CurrentCamera->TakeScreenshot();
-				_ScreenshotsTakenCount++;
+				UE_LOG(LogTemp, Warning, TEXT("Current camera is null in Tick."));
+				return;
 			}
-			else
+
+			_CurrentCameraCountdown = DelayBetweenScreenshots;
+			_FocusLightBudget({ _CurrentCamera });
+			_CurrentCamera->TakeScreenshot();
+			_ScreenshotsTakenCount++;
+
+			if (_AnnotationWriter)
 			{
-				UE_LOG(LogTemp, Warning, TEXT("Invalid camera index in Tick."));
+				FCaptureAnnotation sceneAnnotation;
+				_CollectSceneAnnotation(sceneAnnotation);
+
+				TArray<FCaptureAnnotation> annotations;
+				if (_CreateAnnotation(_CurrentCamera, _CurrentCamera->GetLastScreenshotFilepath(), sceneAnnotation, annotations.AddDefaulted_GetRef()))
+				{
+					_AnnotationWriter->Enqueue(MoveTemp(annotations));
+				}
 			}
 		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Invalid camera index in Tick."));
+		}
 	}
 }
 
@@ -127,34 +308,417 @@ void AScreenshotController::Tick(float DeltaTime)
  */
 void AScreenshotController::_RegisterAllCameras()
 {
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!registry)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Traffic registry is null in _RegisterAllCameras."));
+		return;
+	}
+
+	Cameras.Empty();
+
+	for (ACamera* camera : registry->GetCameras())
+	{
+		if (!camera)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Null camera found in _RegisterAllCameras."));
+			continue;
+		}
+
+		Cameras.Add(camera);
+	}
+}
+
+/**
+ * Switches between accelerated time with world rendering disabled and real time with rendering enabled.
+ * The game viewport is missing when running with -nullrhi, in which case only the time dilation changes.
+ *
+ * @param bAccelerated True to speed the simulation up, false to return to real time.
+ */
+void AScreenshotController::_SetAccelerated(bool bAccelerated)
+{
+	if (_IsAccelerated == bAccelerated)
+	{
+		return;
+	}
+
 	UWorld* world = GetWorld();
 	if (!world)
 	{
-		UE_LOG(LogTemp, Error, TEXT("World is null in _RegisterAllCameras."));
+		UE_LOG(LogTemp, Error, TEXT("World is null in _SetAccelerated."));
 		return;
 	}
 
-	Cameras.Empty();
+	AWorldSettings* worldSettings = world->GetWorldSettings();
+	if (!worldSettings)
+	{
+		UE_LOG(LogTemp, Error, TEXT("WorldSettings is null in _SetAccelerated."));
+		return;
+	}
+
+	float dilation = bAccelerated ? FMath::Max(1.0f, AcceleratedTimeDilation) : 1.0f;
+	worldSettings->MaxGlobalTimeDilation = FMath::Max(worldSettings->MaxGlobalTimeDilation, dilation);
+	UGameplayStatics::SetGlobalTimeDilation(world, dilation);
+
+	// The world clamps the dilation to its limits, report the value that is actually used
+	float effectiveDilation = worldSettings->TimeDilation;
+	if (!FMath::IsNearlyEqual(effectiveDilation, dilation))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_SetAccelerated: Time dilation %f was clamped to %f by the world settings."), dilation, effectiveDilation);
+	}
+	else if (bAccelerated)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("_SetAccelerated: Using time dilation %f."), effectiveDilation);
+	}
+
+	UGameViewportClient* viewport = world->GetGameViewport();
+	if (viewport)
+	{
+		viewport->bDisableWorldRendering = bAccelerated;
+	}
 
-	TArray<AActor*> found;
-	UGameplayStatics::GetAllActorsOfClass(world, ACamera::StaticClass(), found);
+	_IsAccelerated = bAccelerated;
+}
+
+/**
+ * Hands a captured viewport frame to the screenshot writer.
+ * The viewport reads the frame back and broadcasts it instead of saving it when the delegate is bound,
+ * the requested file name is still available at that point.
+ *
+ * @param Width The width of the frame, in pixels.
+ * @param Height The height of the frame, in pixels.
+ * @param Colors The pixels of the frame.
+ */
+void AScreenshotController::_OnScreenshotCaptured(int32 Width, int32 Height, const TArray<FColor>& Colors)
+{
+	if (!_ScreenshotWriter)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ScreenshotWriter is null in _OnScreenshotCaptured."));
+		return;
+	}
 
-	for (AActor* actor : found)
+	FString filepath = FScreenshotRequest::GetFilename();
+	if (filepath.IsEmpty())
 	{
-		if (!actor)
+		UE_LOG(LogTemp, Warning, TEXT("_OnScreenshotCaptured: Captured frame has no file name."));
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ScreenshotCapture);
+	FTelemetryScope telemetryScope(GetWorld(), ETelemetryScopes::Capture);
+
+	TArray<FColor> pixels = Colors;
+	_ScreenshotWriter->Enqueue(filepath, Width, Height, MoveTemp(pixels));
+}
+
+/**
+ * Advances a render target capture round.
+ * The first tick captures all cameras, later ticks wait for the readback fence without blocking the game thread.
+ * Once the pixels are available they are handed to the writer and the next round is scheduled.
+ */
+void AScreenshotController::_TickRenderTargetCapture()
+{
+	if (!_PendingReadbacks.IsValid())
+	{
+		_FocusLightBudget(TArray<AActor*>(Cameras));
+		if (!_CaptureAllCameras())
+		{
+			_ResetScreenshotValues();
+			_ResetTimer();
+		}
+		return;
+	}
+
+	if (!_ReadbackFence.IsFenceComplete())
+	{
+		return;
+	}
+
+	_CompleteReadback();
+	_ResetScreenshotValues();
+	_ResetTimer();
+}
+
+/**
+ * Gives the car spotlights to the cars closest to the cameras about to be captured.
+ * Does nothing unless the light budget is enabled.
+ *
+ * @param FocusCameras The cameras about to be captured.
+ */
+void AScreenshotController::_FocusLightBudget(const TArray<AActor*>& FocusCameras)
+{
+	UWorld* world = GetWorld();
+	UCarLightBudgetSubsystem* lightBudget = world ? world->GetSubsystem<UCarLightBudgetSubsystem>() : nullptr;
+	if (lightBudget && lightBudget->IsEnabled())
+	{
+		lightBudget->SetFocusActors(FocusCameras);
+	}
+}
+
+/**
+ * Collects the weather and traffic light state shared by all annotations of a frame.
+ *
+ * @param OutAnnotation The annotation to fill.
+ */
+void AScreenshotController::_CollectSceneAnnotation(FCaptureAnnotation& OutAnnotation)
+{
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _CollectSceneAnnotation."));
+		return;
+	}
+
+	OutAnnotation.FrameNumber = GFrameCounter;
+	OutAnnotation.SimTime = world->GetTimeSeconds();
+
+	if (!_WeatherController.IsValid())
+	{
+		_WeatherController = Cast<AWeatherController>(UGameplayStatics::GetActorOfClass(world, AWeatherController::StaticClass()));
+	}
+	if (_WeatherController.IsValid())
+	{
+		OutAnnotation.Daylight = _WeatherController->Daylight;
+		OutAnnotation.Cloudiness = _WeatherController->Cloudiness;
+		OutAnnotation.RainIntensity = _WeatherController->RainIntensity;
+	}
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!registry)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Traffic registry is null in _CollectSceneAnnotation."));
+		return;
+	}
+
+	UEnum* statesEnum = StaticEnum<ETrafficLightsStates>();
+	OutAnnotation.TrafficLights.Reserve(registry->GetTrafficLights().Num());
+	for (ATrafficLights* trafficLights : registry->GetTrafficLights())
+	{
+		if (trafficLights)
+		{
+			FTrafficLightsAnnotation& trafficLightsAnnotation = OutAnnotation.TrafficLights.AddDefaulted_GetRef();
+			trafficLightsAnnotation.Id = trafficLights->GetName();
+			trafficLightsAnnotation.State = statesEnum->GetNameStringByValue((int64)trafficLights->CurrentState);
+		}
+	}
+}
+
+/**
+ * Creates the annotation of a single captured image from the shared scene state and the cars the camera sees.
+ * A car is annotated if the projection of its body box overlaps the image. Occlusion by other objects is not tested,
+ * and corners behind the camera are left out of the 2D box of cars that are only partially in front of it.
+ *
+ * @param Camera The camera that captured the image.
+ * @param ImageFilepath The path of the captured image.
+ * @param SceneAnnotation The scene state shared by all annotations of the frame.
+ * @param OutAnnotation The annotation to fill.
+ * @return True if the annotation was created, false otherwise.
+ */
+bool AScreenshotController::_CreateAnnotation(ACamera* Camera, const FString& ImageFilepath, const FCaptureAnnotation& SceneAnnotation, FCaptureAnnotation& OutAnnotation)
+{
+	FMatrix viewProjectionMatrix;
+	if (!Camera || !Camera->GetCaptureViewProjection(viewProjectionMatrix))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_CreateAnnotation: Camera view is not available."));
+		return false;
+	}
+
+	OutAnnotation = SceneAnnotation;
+	OutAnnotation.AnnotationFilepath = FPaths::Combine(Camera->SaveDirectory, AnnotationFilename);
+	OutAnnotation.ImageFilename = FPaths::GetCleanFilename(ImageFilepath);
+	OutAnnotation.CameraName = Camera->CameraName;
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	ATrafficManager* trafficManager = registry ? registry->GetTrafficManager() : nullptr;
+	if (!trafficManager)
+	{
+		return true;
+	}
+
+	for (ACar* car : trafficManager->GetCars())
+	{
+		if (!car || !car->CarBoxRoot || car->IsHidden())
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Null actor found in _RegisterAllCameras."));
 			continue;
 		}
 
-		ACamera* camera = Cast<ACamera>(actor);
-		if (camera)
+		FVector extent = car->CarBoxRoot->GetScaledBoxExtent();
+		FVector center = car->CarBoxRoot->GetComponentLocation();
+		FQuat rotation = car->CarBoxRoot->GetComponentQuat();
+
+		FVector4 corners[8];
+		for (int32 corner = 0; corner < 8; corner++)
 		{
-			Cameras.Add(camera);
+			FVector offset(
+				(corner & 1) ? extent.X : -extent.X,
+				(corner & 2) ? extent.Y : -extent.Y,
+				(corner & 4) ? extent.Z : -extent.Z);
+			corners[corner] = viewProjectionMatrix.TransformFVector4(FVector4(center + rotation.RotateVector(offset), 1.0f));
 		}
-		else
+
+		// Corners behind the camera are replaced by the points where the box edges cross the near plane,
+		// so a car reaching past the camera extends its box to the image border instead of shrinking it
+		FBox2D screenBox(ForceInit);
+		for (int32 corner = 0; corner < 8; corner++)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Failed to cast actor to ACamera in _RegisterAllCameras."));
+			if (corners[corner].W >= AnnotationNearClipW)
+			{
+				screenBox += ProjectClipPoint(corners[corner]);
+			}
+
+			for (int32 axis = 1; axis < 8; axis <<= 1)
+			{
+				if (corner & axis)
+				{
+					continue;
+				}
+
+				const FVector4& start = corners[corner];
+				const FVector4& end = corners[corner | axis];
+				if ((start.W >= AnnotationNearClipW) != (end.W >= AnnotationNearClipW))
+				{
+					float alpha = (AnnotationNearClipW - start.W) / (end.W - start.W);
+					screenBox += ProjectClipPoint(start + (end - start) * alpha);
+				}
+			}
+		}
+
+		if (!screenBox.bIsValid)
+		{
+			continue;
+		}
+
+		screenBox.Min = screenBox.Min.ClampAxes(0.0f, 1.0f);
+		screenBox.Max = screenBox.Max.ClampAxes(0.0f, 1.0f);
+		if (screenBox.Min.X >= screenBox.Max.X || screenBox.Min.Y >= screenBox.Max.Y)
+		{
+			continue;
+		}
+
+		FCarAnnotation& carAnnotation = OutAnnotation.Cars.AddDefaulted_GetRef();
+		carAnnotation.Id = (car->GetCarId() != INDEX_NONE) ? FString::FromInt(car->GetCarId()) : car->GetName();
+		carAnnotation.ClassName = car->GetClass()->GetName();
+		carAnnotation.PathName = car->GetPath() ? car->GetPath()->GetName() : FString();
+		carAnnotation.ScreenBox = screenBox;
+		carAnnotation.Center = center;
+		carAnnotation.Extent = extent;
+		carAnnotation.Rotation = rotation.Rotator();
+		carAnnotation.Speed = car->GetTrafficIndex() != INDEX_NONE ? trafficManager->GetCarSpeed(car->GetTrafficIndex()) : 0.0f;
+		carAnnotation.bCanMove = !car->IsStopped();
+		carAnnotation.bLightsOn = car->GetLightsOn();
+	}
+
+	return true;
+}
+
+/**
+ * Captures all cameras into their render targets and reads them back in a single render command.
+ * All captures are queued in the same frame, so every view shows the same simulation state.
+ *
+ * @return True if at least one camera was captured, false otherwise.
+ */
+bool AScreenshotController::_CaptureAllCameras()
+{
+	TSharedPtr<TArray<FCameraCaptureReadback>, ESPMode::ThreadSafe> readbacks = MakeShared<TArray<FCameraCaptureReadback>, ESPMode::ThreadSafe>();
+	readbacks->Reserve(Cameras.Num());
+
+	// Annotations are collected in the capture frame, so they describe exactly the captured state
+	FCaptureAnnotation sceneAnnotation;
+	TArray<FCaptureAnnotation> annotations;
+	if (_AnnotationWriter)
+	{
+		_CollectSceneAnnotation(sceneAnnotation);
+		annotations.Reserve(Cameras.Num());
+	}
+
+	for (ACamera* camera : Cameras)
+	{
+		if (!camera)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("_CaptureAllCameras encountered a null camera in Cameras."));
+			continue;
+		}
+
+		if (!camera->CaptureToRenderTarget())
+		{
+			continue;
+		}
+
+		UTextureRenderTarget2D* renderTarget = camera->GetRenderTarget();
+		FTextureRenderTargetResource* resource = renderTarget ? renderTarget->GameThread_GetRenderTargetResource() : nullptr;
+		if (!resource)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("_CaptureAllCameras: Render target resource of camera %s is null."), *camera->CameraName);
+			continue;
+		}
+
+		FCameraCaptureReadback& readback = readbacks->AddDefaulted_GetRef();
+		readback.Filepath = camera->CreateScreenshotFilepath();
+		readback.Resource = resource;
+		readback.Width = renderTarget->SizeX;
+		readback.Height = renderTarget->SizeY;
+
+		if (_AnnotationWriter && !_CreateAnnotation(camera, readback.Filepath, sceneAnnotation, annotations.AddDefaulted_GetRef()))
+		{
+			annotations.Pop(false);
+		}
+	}
+
+	if (readbacks->Num() <= 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_CaptureAllCameras: No camera was captured."));
+		return false;
+	}
+
+	// Read every render target back in one command, after all captures of this frame were rendered
+	ENQUEUE_RENDER_COMMAND(TSToolkitReadCameraCaptures)(
+		[readbacks](FRHICommandListImmediate& RHICmdList)
+		{
+			for (FCameraCaptureReadback& readback : *readbacks)
+			{
+				FIntRect rect(0, 0, readback.Width, readback.Height);
+				RHICmdList.ReadSurfaceData(readback.Resource->GetRenderTargetTexture(), rect, readback.Pixels, FReadSurfaceDataFlags(RCM_UNorm));
+			}
+		});
+
+	if (_AnnotationWriter)
+	{
+		_AnnotationWriter->Enqueue(MoveTemp(annotations));
+	}
+
+	_ReadbackFence.BeginFence();
+	_PendingReadbacks = readbacks;
+	_ScreenshotsTakenCount = readbacks->Num();
+	return true;
+}
+
+/**
+ * Hands the pixels of a completed readback to the screenshot writer.
+ * The alpha channel of the scene capture is not meaningful and is made opaque.
+ */
+void AScreenshotController::_CompleteReadback()
+{
+	TSharedPtr<TArray<FCameraCaptureReadback>, ESPMode::ThreadSafe> readbacks = MoveTemp(_PendingReadbacks);
+	_PendingReadbacks.Reset();
+
+	if (!readbacks.IsValid())
+	{
+		return;
+	}
+
+	if (!_ScreenshotWriter)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ScreenshotWriter is null in _CompleteReadback."));
+		return;
+	}
+
+	for (FCameraCaptureReadback& readback : *readbacks)
+	{
+		for (FColor& color : readback.Pixels)
+		{
+			color.A = 255;
 		}
+
+		_ScreenshotWriter->Enqueue(readback.Filepath, readback.Width, readback.Height, MoveTemp(readback.Pixels));
 	}
 }
@@ -4,9 +4,36 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "AsyncScreenshotWriter.h"
+#include "AsyncAnnotationWriter.h"
+#include "RenderCommandFence.h"
 #include "ScreenshotController.generated.h"
 
 class ACamera;
+class ATrafficManager;
+class AWeatherController;
+class FTextureRenderTargetResource;
+
+/**
+ * FCameraCaptureReadback holds the pixels read back from the render target of a single camera.
+ */
+struct FCameraCaptureReadback
+{
+	/** Path of the screenshot file. */
+	FString Filepath;
+
+	/** Render target resource the camera captured into. */
+	FTextureRenderTargetResource* Resource = nullptr;
+
+	/** Width of the capture, in pixels. */
+	int32 Width = 0;
+
+	/** Height of the capture, in pixels. */
+	int32 Height = 0;
+
+	/** Pixels read back on the render thread. */
+	TArray<FColor> Pixels;
+};
 
 /**
  * AScreenshotController is responsible for managing cameras and taking periodic screenshots.
@@ -40,6 +67,38 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Controller Details")
 	float DelayBetweenScreenshots = 0.1f;
 
+	/** Whether the simulation runs faster than real time with rendering disabled between screenshot rounds. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	bool bAcceleratedTime = false;
+
+	/** Factor by which the simulation is sped up between screenshot rounds. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	float AcceleratedTimeDilation = 10.0f;
+
+	/** Whether captured screenshots are encoded and written on worker threads instead of the game thread. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	bool bAsyncScreenshots = true;
+
+	/** Maximum number of screenshots encoded and written in the background at the same time. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	int MaxScreenshotQueueDepth = 4;
+
+	/** Whether all cameras capture into their render targets in the same frame instead of switching the view target. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	bool bUseRenderTargetCapture = true;
+
+	/** Whether the screenshot timer starts at BeginPlay. If false, capturing starts with StartCapture. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	bool bStartCaptureAtBeginPlay = true;
+
+	/** Whether every capture also appends a ground truth annotation record to the camera's annotation file. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	bool bWriteAnnotations = false;
+
+	/** Name of the JSON lines file the annotations of a camera are appended to, in the camera's save directory. */
+	UPROPERTY(EditAnywhere, Category = "Controller Details")
+	FString AnnotationFilename = TEXT("Annotations.jsonl");
+
 private:
 	/** Countdown timer for the current camera's screenshot interval. */
 	float _CurrentCameraCountdown;
@@ -56,6 +115,30 @@ private:
 	/** Indicates whether the screenshot timer has run out. */
 	bool _TimerRunOut = false;
 
+	/** Indicates whether the screenshot timer has been started. */
+	bool _CaptureStarted = false;
+
+	/** Indicates whether the simulation currently runs in accelerated time. */
+	bool _IsAccelerated = false;
+
+	/** Writer encoding and saving captured screenshots in the background. */
+	TUniquePtr<FAsyncScreenshotWriter> _ScreenshotWriter;
+
+	/** Writer serializing and saving annotation records in the background. */
+	TUniquePtr<FAsyncAnnotationWriter> _AnnotationWriter;
+
+	/** Weather controller providing the annotated weather state, found on first use. */
+	TWeakObjectPtr<AWeatherController> _WeatherController;
+
+	/** Handle of the binding to the viewport's screenshot captured delegate. */
+	FDelegateHandle _ScreenshotCapturedHandle;
+
+	/** Readbacks of the capture round in flight, shared with the render thread. */
+	TSharedPtr<TArray<FCameraCaptureReadback>, ESPMode::ThreadSafe> _PendingReadbacks;
+
+	/** Fence signalled once the render thread has read back all captures of the round. */
+	FRenderCommandFence _ReadbackFence;
+
 protected:
 	/**
 	 * Called when the game starts or when the actor is spawned.
@@ -63,13 +146,21 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Restores real time and world rendering and waits for the queued screenshots.
+	 *
+	 * @param EndPlayReason The reason the actor is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Handles actions to be performed when the screenshot timer runs out.
 	 */
 	virtual void _TimerAction();
 
 	/**
-	 * Resets the screenshot timer to the configured interval.
+	 * Resets the screenshot timer to the configured interval and appends the manifest rows of the finished round.
 	 */
 	virtual void _ResetTimer();
 
@@ -86,10 +177,74 @@ public:
 	 */
 	virtual void Tick(float DeltaTime) override;
 
+	/**
+	 * Starts the screenshot timer. Does nothing if capturing has already started.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void StartCapture();
+
 private:
 	/**
 	 * Registers all cameras in the simulation.
 	 * This method is called if bRegisterAllAtBeginPlay is true.
 	 */
 	void _RegisterAllCameras();
+
+	/**
+	 * Switches between accelerated time with world rendering disabled and real time with rendering enabled.
+	 *
+	 * @param bAccelerated True to speed the simulation up, false to return to real time.
+	 */
+	void _SetAccelerated(bool bAccelerated);
+
+	/**
+	 * Hands a captured viewport frame to the screenshot writer.
+	 *
+	 * @param Width The width of the frame, in pixels.
+	 * @param Height The height of the frame, in pixels.
+	 * @param Colors The pixels of the frame.
+	 */
+	void _OnScreenshotCaptured(int32 Width, int32 Height, const TArray<FColor>& Colors);
+
+	/**
+	 * Advances a render target capture round, capturing all cameras first and collecting the readback once it completes.
+	 */
+	void _TickRenderTargetCapture();
+
+	/**
+	 * Captures all cameras into their render targets and reads them back in a single render command.
+	 *
+	 * @return True if at least one camera was captured, false otherwise.
+	 */
+	bool _CaptureAllCameras();
+
+	/**
+	 * Gives the car spotlights to the cars closest to the cameras about to be captured.
+	 *
+	 * @param FocusCameras The cameras about to be captured.
+	 */
+	void _FocusLightBudget(const TArray<AActor*>& FocusCameras);
+
+	/**
+	 * Collects the weather and traffic light state shared by all annotations of a frame.
+	 *
+	 * @param OutAnnotation The annotation to fill.
+	 */
+	void _CollectSceneAnnotation(FCaptureAnnotation& OutAnnotation);
+
+	/**
+	 * Creates the annotation of a single captured image from the shared scene state and the cars the camera sees.
+	 *
+	 * @param Camera The camera that captured the image.
+	 * @param ImageFilepath The path of the captured image.
+	 * @param SceneAnnotation The scene state shared by all annotations of the frame.
+	 * @param OutAnnotation The annotation to fill.
+	 * @return True if the annotation was created, false otherwise.
+	 */
+	bool _CreateAnnotation(ACamera* Camera, const FString& ImageFilepath, const FCaptureAnnotation& SceneAnnotation, FCaptureAnnotation& OutAnnotation);
+
+	/**
+	 * Hands the pixels of a completed readback to the screenshot writer.
+	 */
+	void _CompleteReadback();
 };
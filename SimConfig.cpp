@@ -23,18 +23,40 @@ USimConfig::USimConfig()
 	RelativeLevelPath = "TCross_1.TCross_1";
 	ControllerClassName = ECarSpawnControllerClasses::Random;
 	SimulationDuration = 360.0f;
+	bIsSeeded = false;
+	Seed = 0;
+	FixedTimeStep = 0.0f;
+	bIsCarFollowingModelEnabled = true;
 	CarsSpawnRate = 5.0f;
+	bIsLargeVehiclesIncluded = true;
+	MaxSpawnBacklog = 5;
+	bIsWarmUpEnabled = false;
+	WarmUpDensity = 2.0f;
+	WarmUpSettleTime = 0.0f;
 	ScreenshotInterval = 10.0f;
 	DelayBetweenScreenshots = 0.2f;
+	bIsAcceleratedTime = false;
+	AcceleratedTimeDilation = 10.0f;
+	ScreenshotQueueDepth = 4;
 	bIsNight = false;
 	bIsOvercast = false;
 	bIsRain = false;
+	Cloudiness = 0.0f;
+	RainIntensity = 0.0f;
+	WeatherTransitionDuration = 10.0f;
+	bIsLightBudgetEnabled = false;
+	MaxSpotLightCars = 16;
+	LightBudgetTargetFrameTime = 0.0f;
+	bIsCarSignificanceEnabled = false;
+	bIsInstancedRenderingEnabled = false;
+	bIsAnnotationEnabled = false;
 	bIsChangeDayTime = false;
 	ChangeDayTimeRate = 60.0f;
 	bIsChangeOvercast = false;
 	ChangeOvercastRate = 60.0f;
 	bIsChangeRain = false;
 	ChangeRainRate = 60.0f;
+	bIsTelemetryEnabled = false;
 }
 
 /**
@@ -85,7 +107,7 @@ TArray<FString> USimConfig::GetLevelNames()
  */
 TArray<FString> USimConfig::GetCarSpawnControllerClassesNames()
 {
-	return { "Random", "Periodic" };
+	return { "Random", "Periodic", "Poisson" };
 }
 
 /**
@@ -105,6 +127,10 @@ ECarSpawnControllerClasses USimConfig::GetCarSpawnControllerClassByName(FString
 	{
 		return ECarSpawnControllerClasses::Periodic;
 	}
+	else if (name == "Poisson")
+	{
+		return ECarSpawnControllerClasses::Poisson;
+	}
 
 	UE_LOG(LogTemp, Error, TEXT("Invalid CarSpawnController class name: %s"), *name);
 	throw "Invalid CarSpawnController class name";
@@ -127,6 +153,10 @@ FString USimConfig::GetCarSpawnControllerClassString(ECarSpawnControllerClasses
 	{
 		return "Periodic";
 	}
+	else if (className == ECarSpawnControllerClasses::Poisson)
+	{
+		return "Poisson";
+	}
 
 	UE_LOG(LogTemp, Error, TEXT("Invalid CarSpawnController class enum value."));
 	throw "Invalid CarSpawnController class enum value";
@@ -136,37 +166,102 @@ FString USimConfig::GetCarSpawnControllerClassString(ECarSpawnControllerClasses
  * Saves the current simulation configuration to a JSON file.
  */
 void USimConfig::SaveConfig()
+{
+	FString jsonString;
+	if (!ToJsonString(jsonString))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to serialize simulation configuration to JSON."));
+		return;
+	}
+
+	FString saveFilePath = ConfigDirPath + ConfigFileName;
+	if (!FFileHelper::SaveStringToFile(jsonString, *saveFilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to save simulation configuration to file: %s"), *saveFilePath);
+	}
+}
+
+/**
+ * Serializes the simulation configuration to a JSON string.
+ *
+ * @param OutJsonString The serialized configuration.
+ * @return True if the configuration was serialized, false otherwise.
+ */
+bool USimConfig::ToJsonString(FString& OutJsonString) const
 {
 	TSharedPtr<FJsonObject> jsonObject = MakeShareable(new FJsonObject());
 	jsonObject->SetStringField(TEXT("RelativeLevelPath"), RelativeLevelPath);
 	jsonObject->SetNumberField(TEXT("SimulationDuration"), SimulationDuration);
+	jsonObject->SetBoolField(TEXT("IsSeeded"), bIsSeeded);
+	jsonObject->SetNumberField(TEXT("Seed"), Seed);
+	jsonObject->SetNumberField(TEXT("FixedTimeStep"), FixedTimeStep);
+	jsonObject->SetBoolField(TEXT("IsCarFollowingModelEnabled"), bIsCarFollowingModelEnabled);
 	jsonObject->SetStringField(TEXT("ControllerClassName"), GetCarSpawnControllerClassString(ControllerClassName));
 	jsonObject->SetNumberField(TEXT("CarsSpawnRate"), CarsSpawnRate);
+	TArray<TSharedPtr<FJsonValue>> demandScheduleValues;
+	for (const FDemandPeriod& period : DemandSchedule)
+	{
+		TSharedPtr<FJsonObject> periodObject = MakeShareable(new FJsonObject());
+		periodObject->SetNumberField(TEXT("StartTime"), period.StartTime);
+		periodObject->SetNumberField(TEXT("RateMultiplier"), period.RateMultiplier);
+		demandScheduleValues.Add(MakeShareable(new FJsonValueObject(periodObject)));
+	}
+	jsonObject->SetArrayField(TEXT("DemandSchedule"), demandScheduleValues);
+	jsonObject->SetNumberField(TEXT("MaxSpawnBacklog"), MaxSpawnBacklog);
+	TArray<TSharedPtr<FJsonValue>> carClassPathValues;
+	for (const FString& carClassPath : CarClassPaths)
+	{
+		carClassPathValues.Add(MakeShareable(new FJsonValueString(carClassPath)));
+	}
+	jsonObject->SetArrayField(TEXT("CarClassPaths"), carClassPathValues);
+	jsonObject->SetBoolField(TEXT("IsLargeVehiclesIncluded"), bIsLargeVehiclesIncluded);
+	jsonObject->SetBoolField(TEXT("IsWarmUpEnabled"), bIsWarmUpEnabled);
+	jsonObject->SetNumberField(TEXT("WarmUpDensity"), WarmUpDensity);
+	jsonObject->SetNumberField(TEXT("WarmUpSettleTime"), WarmUpSettleTime);
 	jsonObject->SetNumberField(TEXT("ScreenshotInterval"), ScreenshotInterval);
 	jsonObject->SetNumberField(TEXT("DelayBetweenScreenshots"), DelayBetweenScreenshots);
+	jsonObject->SetBoolField(TEXT("IsAcceleratedTime"), bIsAcceleratedTime);
+	jsonObject->SetNumberField(TEXT("AcceleratedTimeDilation"), AcceleratedTimeDilation);
+	jsonObject->SetNumberField(TEXT("ScreenshotQueueDepth"), ScreenshotQueueDepth);
 	jsonObject->SetBoolField(TEXT("IsNight"), bIsNight);
 	jsonObject->SetBoolField(TEXT("IsOvercast"), bIsOvercast);
 	jsonObject->SetBoolField(TEXT("IsRain"), bIsRain);
+	jsonObject->SetNumberField(TEXT("Cloudiness"), Cloudiness);
+	jsonObject->SetNumberField(TEXT("RainIntensity"), RainIntensity);
+	jsonObject->SetNumberField(TEXT("WeatherTransitionDuration"), WeatherTransitionDuration);
+	jsonObject->SetBoolField(TEXT("IsLightBudgetEnabled"), bIsLightBudgetEnabled);
+	jsonObject->SetNumberField(TEXT("MaxSpotLightCars"), MaxSpotLightCars);
+	jsonObject->SetNumberField(TEXT("LightBudgetTargetFrameTime"), LightBudgetTargetFrameTime);
+	jsonObject->SetBoolField(TEXT("IsCarSignificanceEnabled"), bIsCarSignificanceEnabled);
+	jsonObject->SetBoolField(TEXT("IsInstancedRenderingEnabled"), bIsInstancedRenderingEnabled);
+	jsonObject->SetBoolField(TEXT("IsAnnotationEnabled"), bIsAnnotationEnabled);
 	jsonObject->SetBoolField(TEXT("IsChangeDayTime"), bIsChangeDayTime);
 	jsonObject->SetNumberField(TEXT("ChangeDayTimeRate"), ChangeDayTimeRate);
 	jsonObject->SetBoolField(TEXT("IsChangeOvercast"), bIsChangeOvercast);
 	jsonObject->SetNumberField(TEXT("ChangeOvercastRate"), ChangeOvercastRate);
 	jsonObject->SetBoolField(TEXT("IsChangeRain"), bIsChangeRain);
 	jsonObject->SetNumberField(TEXT("ChangeRainRate"), ChangeRainRate);
+	jsonObject->SetBoolField(TEXT("IsTelemetryEnabled"), bIsTelemetryEnabled);
+
+	TSharedRef<TJsonWriter<TCHAR>> jsonWriter = TJsonWriterFactory<>::Create(&OutJsonString);
+	return FJsonSerializer::Serialize(jsonObject.ToSharedRef(), jsonWriter);
+}
 
+/**
+ * Gets a hash of the simulation configuration, used to tell apart captures made with different settings.
+ *
+ * @return The CRC of the serialized configuration, or zero if it could not be serialized.
+ */
+uint32 USimConfig::GetConfigHash() const
+{
 	FString jsonString;
-	TSharedRef<TJsonWriter<TCHAR>> jsonWriter = TJsonWriterFactory<>::Create(&jsonString);
-	if (!FJsonSerializer::Serialize(jsonObject.ToSharedRef(), jsonWriter))
+	if (!ToJsonString(jsonString))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to serialize simulation configuration to JSON."));
-		return;
+		UE_LOG(LogTemp, Error, TEXT("Failed to serialize simulation configuration in GetConfigHash."));
+		return 0;
 	}
 
-	FString saveFilePath = ConfigDirPath + ConfigFileName;
-	if (!FFileHelper::SaveStringToFile(jsonString, *saveFilePath))
-	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to save simulation configuration to file: %s"), *saveFilePath);
-	}
+	return FCrc::StrCrc32(*jsonString);
 }
 
 /**
@@ -195,17 +290,122 @@ void USimConfig::LoadConfig(FString filename)
 
 	RelativeLevelPath = jsonObject->GetStringField(TEXT("RelativeLevelPath"));
 	SimulationDuration = jsonObject->GetNumberField(TEXT("SimulationDuration"));
+
+	// Determinism fields are optional so that older configuration files still load
+	jsonObject->TryGetBoolField(TEXT("IsSeeded"), bIsSeeded);
+	jsonObject->TryGetNumberField(TEXT("Seed"), Seed);
+	double fixedTimeStep = 0.0;
+	if (jsonObject->TryGetNumberField(TEXT("FixedTimeStep"), fixedTimeStep))
+	{
+		FixedTimeStep = FMath::Max(0.0f, (float)fixedTimeStep);
+	}
+	jsonObject->TryGetBoolField(TEXT("IsCarFollowingModelEnabled"), bIsCarFollowingModelEnabled);
+
 	ControllerClassName = GetCarSpawnControllerClassByName(jsonObject->GetStringField(TEXT("ControllerClassName")));
 	CarsSpawnRate = jsonObject->GetNumberField(TEXT("CarsSpawnRate"));
+	DemandSchedule.Reset();
+	const TArray<TSharedPtr<FJsonValue>>* demandScheduleValues = nullptr;
+	if (jsonObject->TryGetArrayField(TEXT("DemandSchedule"), demandScheduleValues))
+	{
+		for (const TSharedPtr<FJsonValue>& value : *demandScheduleValues)
+		{
+			const TSharedPtr<FJsonObject>* periodObject = nullptr;
+			if (!value.IsValid() || !value->TryGetObject(periodObject))
+			{
+				continue;
+			}
+
+			FDemandPeriod period;
+			double startTime = 0.0;
+			double rateMultiplier = 1.0;
+			(*periodObject)->TryGetNumberField(TEXT("StartTime"), startTime);
+			(*periodObject)->TryGetNumberField(TEXT("RateMultiplier"), rateMultiplier);
+			period.StartTime = (float)startTime;
+			period.RateMultiplier = FMath::Max(0.0f, (float)rateMultiplier);
+			DemandSchedule.Add(period);
+		}
+	}
+	if (jsonObject->TryGetNumberField(TEXT("MaxSpawnBacklog"), MaxSpawnBacklog))
+	{
+		MaxSpawnBacklog = FMath::Max(0, MaxSpawnBacklog);
+	}
+	CarClassPaths.Reset();
+	const TArray<TSharedPtr<FJsonValue>>* carClassPathValues = nullptr;
+	if (jsonObject->TryGetArrayField(TEXT("CarClassPaths"), carClassPathValues))
+	{
+		for (const TSharedPtr<FJsonValue>& value : *carClassPathValues)
+		{
+			FString carClassPath;
+			if (value.IsValid() && value->TryGetString(carClassPath))
+			{
+				CarClassPaths.Add(carClassPath);
+			}
+		}
+	}
+	jsonObject->TryGetBoolField(TEXT("IsLargeVehiclesIncluded"), bIsLargeVehiclesIncluded);
+	jsonObject->TryGetBoolField(TEXT("IsWarmUpEnabled"), bIsWarmUpEnabled);
+	double warmUpDensity = 0.0;
+	if (jsonObject->TryGetNumberField(TEXT("WarmUpDensity"), warmUpDensity))
+	{
+		WarmUpDensity = FMath::Max(0.0f, (float)warmUpDensity);
+	}
+	double warmUpSettleTime = 0.0;
+	if (jsonObject->TryGetNumberField(TEXT("WarmUpSettleTime"), warmUpSettleTime))
+	{
+		WarmUpSettleTime = FMath::Max(0.0f, (float)warmUpSettleTime);
+	}
 	ScreenshotInterval = jsonObject->GetNumberField(TEXT("ScreenshotInterval"));
 	DelayBetweenScreenshots = jsonObject->GetNumberField(TEXT("DelayBetweenScreenshots"));
+	jsonObject->TryGetBoolField(TEXT("IsAcceleratedTime"), bIsAcceleratedTime);
+	double acceleratedTimeDilation = 0.0;
+	if (jsonObject->TryGetNumberField(TEXT("AcceleratedTimeDilation"), acceleratedTimeDilation))
+	{
+		AcceleratedTimeDilation = FMath::Max(1.0f, (float)acceleratedTimeDilation);
+	}
+	if (jsonObject->TryGetNumberField(TEXT("ScreenshotQueueDepth"), ScreenshotQueueDepth))
+	{
+		ScreenshotQueueDepth = FMath::Max(1, ScreenshotQueueDepth);
+	}
 	bIsNight = jsonObject->GetBoolField(TEXT("IsNight"));
 	bIsOvercast = jsonObject->GetBoolField(TEXT("IsOvercast"));
 	bIsRain = jsonObject->GetBoolField(TEXT("IsRain"));
+
+	// Configs saved before the continuous weather parameters fall back to the weather flags
+	double cloudiness = 0.0;
+	Cloudiness = jsonObject->TryGetNumberField(TEXT("Cloudiness"), cloudiness) ? (float)cloudiness : (bIsOvercast ? 1.0f : 0.0f);
+	Cloudiness = FMath::Clamp(Cloudiness, 0.0f, 1.0f);
+	double rainIntensity = 0.0;
+	RainIntensity = jsonObject->TryGetNumberField(TEXT("RainIntensity"), rainIntensity) ? (float)rainIntensity : (bIsRain ? 1.0f : 0.0f);
+	RainIntensity = FMath::Clamp(RainIntensity, 0.0f, 1.0f);
+	double weatherTransitionDuration = 0.0;
+	if (jsonObject->TryGetNumberField(TEXT("WeatherTransitionDuration"), weatherTransitionDuration))
+	{
+		WeatherTransitionDuration = FMath::Max(0.0f, (float)weatherTransitionDuration);
+	}
+	jsonObject->TryGetBoolField(TEXT("IsLightBudgetEnabled"), bIsLightBudgetEnabled);
+	if (jsonObject->TryGetNumberField(TEXT("MaxSpotLightCars"), MaxSpotLightCars))
+	{
+		MaxSpotLightCars = FMath::Max(0, MaxSpotLightCars);
+	}
+	double lightBudgetTargetFrameTime = 0.0;
+	if (jsonObject->TryGetNumberField(TEXT("LightBudgetTargetFrameTime"), lightBudgetTargetFrameTime))
+	{
+		LightBudgetTargetFrameTime = FMath::Max(0.0f, (float)lightBudgetTargetFrameTime);
+	}
+	jsonObject->TryGetBoolField(TEXT("IsCarSignificanceEnabled"), bIsCarSignificanceEnabled);
+	jsonObject->TryGetBoolField(TEXT("IsInstancedRenderingEnabled"), bIsInstancedRenderingEnabled);
+	jsonObject->TryGetBoolField(TEXT("IsAnnotationEnabled"), bIsAnnotationEnabled);
 	bIsChangeDayTime = jsonObject->GetBoolField(TEXT("IsChangeDayTime"));
 	ChangeDayTimeRate = jsonObject->GetNumberField(TEXT("ChangeDayTimeRate"));
 	bIsChangeOvercast = jsonObject->GetBoolField(TEXT("IsChangeOvercast"));
 	ChangeOvercastRate = jsonObject->GetNumberField(TEXT("ChangeOvercastRate"));
 	bIsChangeRain = jsonObject->GetBoolField(TEXT("IsChangeRain"));
 	ChangeRainRate = jsonObject->GetNumberField(TEXT("ChangeRainRate"));
+	jsonObject->TryGetBoolField(TEXT("IsTelemetryEnabled"), bIsTelemetryEnabled);
+
+	if (!bIsSeeded)
+	{
+		Seed = FMath::Rand();
+		UE_LOG(LogTemp, Log, TEXT("LoadConfig: No seed configured, using random seed %d."), Seed);
+	}
 }
@@ -5,18 +5,21 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "CarSpawnController.h"
+#include "PoissonCarSpawnController.h"
 #include "SimConfig.generated.h"
 
 /**
  * Enum representing the available car spawn controller classes.
  * - Random: Spawns cars at random intervals and locations.
  * - Periodic: Spawns cars at fixed intervals.
+ * - Poisson: Spawns cars at every source as a Poisson process with time-varying demand.
  */
 UENUM()
 enum class ECarSpawnControllerClasses
 {
 	Random,
-	Periodic
+	Periodic,
+	Poisson
 };
 
 /**
@@ -60,6 +63,22 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Simulation Details")
 	float SimulationDuration;
 
+	/** Whether the simulation uses Seed, making runs of the same configuration reproducible. */
+	UPROPERTY(EditAnywhere, Category = "Simulation Details")
+	bool bIsSeeded;
+
+	/** Seed of all random streams of the simulation, used when bIsSeeded is true. */
+	UPROPERTY(EditAnywhere, Category = "Simulation Details")
+	int32 Seed;
+
+	/** Fixed simulation time step in seconds, or zero to advance the simulation by the frame time. */
+	UPROPERTY(EditAnywhere, Category = "Simulation Details")
+	float FixedTimeStep;
+
+	/** Whether cars accelerate and brake smoothly with the car following model instead of stopping instantly. */
+	UPROPERTY(EditAnywhere, Category = "Simulation Details")
+	bool bIsCarFollowingModelEnabled;
+
 	// Car spawn details
 	/** Class name of the car spawn controller. */
 	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
@@ -69,6 +88,34 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
 	float CarsSpawnRate;
 
+	/** Piecewise constant demand schedule applied to the arrival rate of the Poisson controller. */
+	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
+	TArray<FDemandPeriod> DemandSchedule;
+
+	/** Maximum number of arrivals waiting at a blocked source with the Poisson controller. */
+	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
+	int32 MaxSpawnBacklog;
+
+	/** Object paths of the car blueprint classes to spawn, or empty to use the default car catalogue. */
+	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
+	TArray<FString> CarClassPaths;
+
+	/** Whether large vehicles such as buses and delivery trucks are spawned. */
+	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
+	bool bIsLargeVehiclesIncluded;
+
+	/** Whether the paths are filled with cars before the first screenshot round. */
+	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
+	bool bIsWarmUpEnabled;
+
+	/** Target number of cars per 100 m of path placed by the warm-up. */
+	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
+	float WarmUpDensity;
+
+	/** Time the simulation runs after the warm-up filled the paths before screenshots start, in seconds. */
+	UPROPERTY(EditAnywhere, Category = "Car Spawning Details")
+	float WarmUpSettleTime;
+
 	// Screenshot details
 	/** Interval between screenshots, in seconds. */
 	UPROPERTY(EditAnywhere, Category = "Screenshot Details")
@@ -78,6 +125,30 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Screenshot Details")
 	float DelayBetweenScreenshots;
 
+	/** Whether the simulation runs faster than real time with rendering disabled between screenshot rounds. */
+	UPROPERTY(EditAnywhere, Category = "Screenshot Details")
+	bool bIsAcceleratedTime;
+
+	/** Factor by which the simulation is sped up between screenshot rounds. */
+	UPROPERTY(EditAnywhere, Category = "Screenshot Details")
+	float AcceleratedTimeDilation;
+
+	/** Maximum number of screenshots encoded and written in the background at the same time. */
+	UPROPERTY(EditAnywhere, Category = "Screenshot Details")
+	int32 ScreenshotQueueDepth;
+
+	/** Whether cars no capture camera sees are rendered at reduced quality between captures. */
+	UPROPERTY(EditAnywhere, Category = "Screenshot Details")
+	bool bIsCarSignificanceEnabled;
+
+	/** Whether cars no capture camera sees are drawn through instanced meshes, requires car significance. */
+	UPROPERTY(EditAnywhere, Category = "Screenshot Details")
+	bool bIsInstancedRenderingEnabled;
+
+	/** Whether every screenshot is accompanied by a ground truth annotation record. */
+	UPROPERTY(EditAnywhere, Category = "Screenshot Details")
+	bool bIsAnnotationEnabled;
+
 	// Weather details
 	/** Whether the simulation starts at night. */
 	UPROPERTY(EditAnywhere, Category = "Weather Details")
@@ -91,6 +162,30 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Weather Details")
 	bool bIsRain;
 
+	/** Cloudiness the simulation starts with, 0 for a clear sky and 1 for an overcast sky. */
+	UPROPERTY(EditAnywhere, Category = "Weather Details")
+	float Cloudiness;
+
+	/** Rain intensity the simulation starts with, 0 for no rain and 1 for full rain. */
+	UPROPERTY(EditAnywhere, Category = "Weather Details")
+	float RainIntensity;
+
+	/** Duration of weather transitions, in seconds. Zero switches the weather immediately. */
+	UPROPERTY(EditAnywhere, Category = "Weather Change Details")
+	float WeatherTransitionDuration;
+
+	/** Whether only the cars closest to the capture cameras render their headlights with spotlights. */
+	UPROPERTY(EditAnywhere, Category = "Weather Details")
+	bool bIsLightBudgetEnabled;
+
+	/** Maximum number of cars rendering their headlights with spotlights when the light budget is enabled. */
+	UPROPERTY(EditAnywhere, Category = "Weather Details")
+	int32 MaxSpotLightCars;
+
+	/** Frame time the light budget adapts to, in milliseconds. Zero keeps the budget at MaxSpotLightCars. */
+	UPROPERTY(EditAnywhere, Category = "Weather Details")
+	float LightBudgetTargetFrameTime;
+
 	// Weather change details
 	/** Whether the simulation dynamically changes day and night. */
 	UPROPERTY(EditAnywhere, Category = "Weather Change Details")
@@ -116,6 +211,11 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Weather Change Settings")
 	float ChangeRainRate;
 
+	// Telemetry details
+	/** Whether per-frame performance telemetry is recorded for the run. */
+	UPROPERTY(EditAnywhere, Category = "Telemetry Details")
+	bool bIsTelemetryEnabled;
+
 	// Static methods
 public:
 	/**
@@ -173,4 +273,19 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable)
 	void LoadConfig(FString filename);
+
+	/**
+	 * Serializes the simulation configuration to a JSON string.
+	 *
+	 * @param OutJsonString The serialized configuration.
+	 * @return True if the configuration was serialized, false otherwise.
+	 */
+	bool ToJsonString(FString& OutJsonString) const;
+
+	/**
+	 * Gets a hash of the simulation configuration.
+	 *
+	 * @return The CRC of the serialized configuration.
+	 */
+	uint32 GetConfigHash() const;
 };
@@ -6,8 +6,8 @@
 // Sets default values
 ASpawnCheckBox::ASpawnCheckBox()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
 
 }
 
@@ -17,11 +17,3 @@ void ASpawnCheckBox::BeginPlay()
 	Super::BeginPlay();
 	
 }
-
-// Called every frame
-void ASpawnCheckBox::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
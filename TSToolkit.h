@@ -4,3 +4,7 @@
 
 #include "CoreMinimal.h"
 
+#include "Stats/Stats.h"
+
+/** Stat group of the simulation, shown with the "stat TSToolkit" console command. */
+DECLARE_STATS_GROUP(TEXT("TSToolkit"), STATGROUP_TSToolkit, STATCAT_Advanced);
@@ -3,12 +3,24 @@
 #include "TSToolkitGameMode.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/World.h"
+#include "EngineUtils.h"
 #include "SimConfig.h"
 #include "MainMenu.h"
 #include "CarSpawnController.h"
 #include "PeriodicCarSpawnController.h"
 #include "RandomCarSpawnController.h"
+#include "PoissonCarSpawnController.h"
 #include "ScreenshotController.h"
+#include "TrafficManager.h"
+#include "TelemetrySubsystem.h"
+#include "CarLightBudgetSubsystem.h"
+#include "CarSignificanceSubsystem.h"
+#include "CaptureManifestSubsystem.h"
+#include "Misc/App.h"
+#include "GameFramework/WorldSettings.h"
+
+// Simulation step used by the traffic manager in accelerated time when no fixed time step is configured
+#define ACCELERATED_TIME_SUB_STEP (1.0f / 30.0f)
 
 // Delete macro if testing of level isn't needed
 // #define TESTING
@@ -21,8 +33,7 @@ typedef UGameplayStatics GS;
  */
 ATSToolkitGameMode::ATSToolkitGameMode()
 {
-	PrimaryActorTick.bStartWithTickEnabled = true;
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	ConstructorHelpers::FClassFinder<UUserWidget> mainMenuWidgetClass(TEXT("WidgetBlueprint'/Game/BP/UI/BP_MainMenu.BP_MainMenu_C'"));
 	ConstructorHelpers::FClassFinder<AWeatherController> weatherControllerClass(TEXT("Blueprint'/Game/BP/BP_WeatherController.BP_WeatherController_C'"));
@@ -81,7 +92,28 @@ void ATSToolkitGameMode::BeginPlay()
 
 		world->EnsureCollisionTreeIsBuilt();
 #endif
+
+		// Tick functions are registered during BeginPlay, so the audit runs once every actor has begun play
+		GetWorldTimerManager().SetTimerForNextTick(this, &ATSToolkitGameMode::_LogTickAudit);
+	}
+}
+
+/**
+ * Called when the game mode is being removed from the level.
+ * The fixed time step is process-wide, so it is restored to keep the editor from running fixed after a PIE session.
+ *
+ * @param EndPlayReason The reason the game mode is being removed.
+ */
+void ATSToolkitGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (_HasChangedTimeStep)
+	{
+		FApp::SetUseFixedTimeStep(_PreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(_PreviousFixedDeltaTime);
+		_HasChangedTimeStep = false;
 	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
@@ -96,17 +128,63 @@ void ATSToolkitGameMode::_EndLevel()
 		return;
 	}
 
+	UTelemetrySubsystem* telemetry = world->GetSubsystem<UTelemetrySubsystem>();
+	if (telemetry)
+	{
+		telemetry->EndRun();
+	}
+
 	UKismetSystemLibrary::QuitGame(world, world->GetFirstPlayerController(), EQuitPreference::Quit, true);
 }
 
 /**
- * Called every frame to update the game mode.
- *
- * @param DeltaTime The time elapsed since the last frame.
+ * Logs the actors and components with an enabled tick function, grouped by class.
+ * Only these are walked by the tick manager every frame, so every entry should be an actor that does work.
  */
-void ATSToolkitGameMode::Tick(float DeltaTime)
+void ATSToolkitGameMode::_LogTickAudit()
 {
-	Super::Tick(DeltaTime);
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _LogTickAudit."));
+		return;
+	}
+
+	TMap<FString, int32> tickingClasses;
+	int32 actorsCount = 0;
+	int32 tickingActorsCount = 0;
+	int32 tickingComponentsCount = 0;
+
+	for (TActorIterator<AActor> it(world); it; ++it)
+	{
+		AActor* actor = *it;
+		actorsCount++;
+
+		if (actor->PrimaryActorTick.IsTickFunctionRegistered() && actor->PrimaryActorTick.IsTickFunctionEnabled())
+		{
+			tickingActorsCount++;
+			tickingClasses.FindOrAdd(actor->GetClass()->GetName())++;
+		}
+
+		for (UActorComponent* component : actor->GetComponents())
+		{
+			if (component && component->PrimaryComponentTick.IsTickFunctionRegistered()
+				&& component->PrimaryComponentTick.IsTickFunctionEnabled())
+			{
+				tickingComponentsCount++;
+				tickingClasses.FindOrAdd(component->GetClass()->GetName())++;
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Tick audit: %d of %d actors and %d components tick every frame."),
+		tickingActorsCount, actorsCount, tickingComponentsCount);
+
+	tickingClasses.ValueSort(TGreater<int32>());
+	for (const TPair<FString, int32>& tickingClass : tickingClasses)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Tick audit: %4d x %s"), tickingClass.Value, *tickingClass.Key);
+	}
 }
 
 /**
@@ -238,13 +316,255 @@ void ATSToolkitGameMode::_SetUpLevel(USimConfig* Config)
 		return;
 	}
 
+	_SetUpTimeStep(Config);
+	_SetUpTelemetry(Config);
+	_SetUpTrafficManager(Config);
+	_SetUpLightBudget(Config);
+	_SetUpCarSignificance(Config);
 	_SetUpCarSpawnController(Config);
 	_SetUpScreenshotController(Config);
 	_SetUpWeatherController(Config);
 
-	// End timer setup
-	FTimerHandle TimerHandle;
-	GetWorldTimerManager().SetTimer(TimerHandle, this, &ATSToolkitGameMode::_EndLevel, Config->SimulationDuration, false);
+	_SimulationDuration = Config->SimulationDuration;
+	_StartSimulationClockWhenCarsReady();
+}
+
+/**
+ * Starts the capture clock and the end timer once the car spawn controller loaded its cars
+ * and finished the warm-up. The cars load asynchronously, so starting the clocks at BeginPlay
+ * would shift the spawn times against the captures by the load time of each run.
+ */
+void ATSToolkitGameMode::_StartSimulationClockWhenCarsReady()
+{
+	ACarSpawnController* carSpawnController = Cast<ACarSpawnController>(GS::GetActorOfClass(this, ACarSpawnController::StaticClass()));
+	if (!carSpawnController)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("_StartSimulationClockWhenCarsReady: No car spawn controller to wait for, starting the clock."));
+		_StartSimulationClock();
+	}
+	else if (carSpawnController->IsWarmUpComplete())
+	{
+		_StartSimulationClock();
+	}
+	else
+	{
+		carSpawnController->OnWarmUpComplete.AddDynamic(this, &ATSToolkitGameMode::_StartSimulationClock);
+	}
+}
+
+/**
+ * Starts the screenshot capture and the timer ending the level. Does nothing if the clock has already started.
+ */
+void ATSToolkitGameMode::_StartSimulationClock()
+{
+	if (GetWorldTimerManager().TimerExists(_EndTimerHandle))
+	{
+		return;
+	}
+
+	if (_ScreenshotController)
+	{
+		_ScreenshotController->StartCapture();
+	}
+
+	GetWorldTimerManager().SetTimer(_EndTimerHandle, this, &ATSToolkitGameMode::_EndLevel, _SimulationDuration, false);
+}
+
+/**
+ * Sets up a fixed engine time step if the configuration requests one.
+ * With a fixed time step every frame advances the world by the same amount regardless of render time,
+ * so timers and movement produce the same results in every run.
+ *
+ * @param Config The simulation configuration to use for setting up the time step.
+ */
+void ATSToolkitGameMode::_SetUpTimeStep(USimConfig* Config)
+{
+	if (!Config)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Config is null in _SetUpTimeStep."));
+		return;
+	}
+
+	if (Config->FixedTimeStep <= 0.0f)
+	{
+		return;
+	}
+
+	if (!_HasChangedTimeStep)
+	{
+		_PreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+		_PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+		_HasChangedTimeStep = true;
+	}
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Config->FixedTimeStep);
+	UE_LOG(LogTemp, Log, TEXT("_SetUpTimeStep: Using fixed time step %f s, seed %d."), Config->FixedTimeStep, Config->Seed);
+}
+
+/**
+ * Starts recording performance telemetry if the configuration enables it.
+ * The run is named after its start time so that consecutive runs never overwrite each other.
+ *
+ * @param Config The simulation configuration to use for setting up the telemetry.
+ */
+void ATSToolkitGameMode::_SetUpTelemetry(USimConfig* Config)
+{
+	if (!Config)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Config is null in _SetUpTelemetry."));
+		return;
+	}
+
+	if (!Config->bIsTelemetryEnabled)
+	{
+		return;
+	}
+
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _SetUpTelemetry."));
+		return;
+	}
+
+	UTelemetrySubsystem* telemetry = world->GetSubsystem<UTelemetrySubsystem>();
+	if (!telemetry)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Telemetry subsystem is null in _SetUpTelemetry."));
+		return;
+	}
+
+	telemetry->StartRun(FString::Printf(TEXT("Run_%s"), *FDateTime::Now().ToString(TEXT("%Y%m%d%H%M%S"))));
+}
+
+/**
+ * Sets up the traffic manager that advances all spawned cars.
+ *
+ * @param Config The simulation configuration to use for setting up the traffic manager.
+ */
+void ATSToolkitGameMode::_SetUpTrafficManager(USimConfig* Config)
+{
+	if (!Config)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Config is null in _SetUpTrafficManager."));
+		return;
+	}
+
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _SetUpTrafficManager."));
+		return;
+	}
+
+	ATrafficManager* manager = world->SpawnActor<ATrafficManager>(ATrafficManager::StaticClass());
+	if (!manager)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn traffic manager in _SetUpTrafficManager."));
+		return;
+	}
+
+	manager->FixedTimeStep = Config->FixedTimeStep;
+	manager->bUseCarFollowingModel = Config->bIsCarFollowingModelEnabled;
+	manager->bUseInstancedRendering = Config->bIsInstancedRenderingEnabled && Config->bIsCarSignificanceEnabled;
+
+	// Accelerated time advances the world by several frames worth of time at once, which the manager has to sub-step
+	if (Config->bIsAcceleratedTime)
+	{
+		if (manager->FixedTimeStep <= 0.0f)
+		{
+			manager->FixedTimeStep = ACCELERATED_TIME_SUB_STEP;
+		}
+
+		// The world caps the time dilation at MaxGlobalTimeDilation, raise the cap so the configured dilation takes effect
+		float dilation = FMath::Max(1.0f, Config->AcceleratedTimeDilation);
+		AWorldSettings* worldSettings = world->GetWorldSettings();
+		if (worldSettings)
+		{
+			worldSettings->MaxGlobalTimeDilation = FMath::Max(worldSettings->MaxGlobalTimeDilation, dilation);
+			dilation = FMath::Clamp(dilation, worldSettings->MinGlobalTimeDilation, worldSettings->MaxGlobalTimeDilation);
+		}
+
+		float frameTime = (Config->FixedTimeStep > 0.0f) ? Config->FixedTimeStep : ACCELERATED_TIME_SUB_STEP;
+		int subStepsPerFrame = FMath::CeilToInt(frameTime * dilation / manager->FixedTimeStep);
+		manager->MaxSubSteps = FMath::Max(manager->MaxSubSteps, subStepsPerFrame + 1);
+		UE_LOG(LogTemp, Log, TEXT("_SetUpTrafficManager: Accelerated time dilation %f, up to %d sub-steps per frame."), dilation, manager->MaxSubSteps);
+	}
+}
+
+/**
+ * Enables the car light budget if the configuration enables it.
+ * Must run before the first cars are spawned, so that they start with the emissive headlight proxy.
+ *
+ * @param Config The simulation configuration to use for setting up the light budget.
+ */
+void ATSToolkitGameMode::_SetUpLightBudget(USimConfig* Config)
+{
+	if (!Config)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Config is null in _SetUpLightBudget."));
+		return;
+	}
+
+	if (!Config->bIsLightBudgetEnabled)
+	{
+		return;
+	}
+
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _SetUpLightBudget."));
+		return;
+	}
+
+	UCarLightBudgetSubsystem* lightBudget = world->GetSubsystem<UCarLightBudgetSubsystem>();
+	if (!lightBudget)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Light budget subsystem is null in _SetUpLightBudget."));
+		return;
+	}
+
+	lightBudget->MaxSpotLightCars = Config->MaxSpotLightCars;
+	lightBudget->TargetFrameTimeMs = Config->LightBudgetTargetFrameTime;
+	lightBudget->SetEnabled(true);
+}
+
+/**
+ * Enables car significance if the configuration enables it.
+ * The capture cameras are handed over by the screenshot controller when it begins play.
+ *
+ * @param Config The simulation configuration to use for setting up car significance.
+ */
+void ATSToolkitGameMode::_SetUpCarSignificance(USimConfig* Config)
+{
+	if (!Config)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Config is null in _SetUpCarSignificance."));
+		return;
+	}
+
+	if (!Config->bIsCarSignificanceEnabled)
+	{
+		return;
+	}
+
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in _SetUpCarSignificance."));
+		return;
+	}
+
+	UCarSignificanceSubsystem* significance = world->GetSubsystem<UCarSignificanceSubsystem>();
+	if (!significance)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Car significance subsystem is null in _SetUpCarSignificance."));
+		return;
+	}
+
+	significance->SetEnabled(true);
 }
 
 /**
@@ -268,15 +588,19 @@ void ATSToolkitGameMode::_SetUpCarSpawnController(USimConfig* Config)
 	}
 
 	ECarSpawnControllerClasses controllerClassName = Config->ControllerClassName;
-	ACarSpawnController* controller = nullptr;
+	UClass* controllerClass = nullptr;
 
 	if (controllerClassName == ECarSpawnControllerClasses::Random)
 	{
-		controller = world->SpawnActor<ARandomCarSpawnController>(ARandomCarSpawnController::StaticClass());
+		controllerClass = ARandomCarSpawnController::StaticClass();
 	}
 	else if (controllerClassName == ECarSpawnControllerClasses::Periodic)
 	{
-		controller = world->SpawnActor<APeriodicCarSpawnController>(APeriodicCarSpawnController::StaticClass());
+		controllerClass = APeriodicCarSpawnController::StaticClass();
+	}
+	else if (controllerClassName == ECarSpawnControllerClasses::Poisson)
+	{
+		controllerClass = APoissonCarSpawnController::StaticClass();
 	}
 	else
 	{
@@ -284,6 +608,8 @@ void ATSToolkitGameMode::_SetUpCarSpawnController(USimConfig* Config)
 		return;
 	}
 
+	// Spawn deferred so the configuration is in place before BeginPlay seeds the sources and starts the timer
+	ACarSpawnController* controller = world->SpawnActorDeferred<ACarSpawnController>(controllerClass, FTransform::Identity);
 	if (!controller)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Failed to spawn car spawn controller in _SetUpCarSpawnController."));
@@ -292,6 +618,24 @@ void ATSToolkitGameMode::_SetUpCarSpawnController(USimConfig* Config)
 
 	controller->bRegisterAllAtBeginPlay = true;
 	controller->SpawnRate = Config->CarsSpawnRate;
+	controller->Seed = Config->Seed;
+	controller->bIncludeLargeVehicles = Config->bIsLargeVehiclesIncluded;
+	controller->bWarmUp = Config->bIsWarmUpEnabled;
+	controller->WarmUpDensity = Config->WarmUpDensity;
+	controller->WarmUpSettleTime = Config->WarmUpSettleTime;
+
+	APoissonCarSpawnController* poissonController = Cast<APoissonCarSpawnController>(controller);
+	if (poissonController)
+	{
+		poissonController->DemandSchedule = Config->DemandSchedule;
+		poissonController->MaxBacklog = Config->MaxSpawnBacklog;
+	}
+
+	if (Config->CarClassPaths.Num() > 0)
+	{
+		controller->SetCarClassPaths(Config->CarClassPaths);
+	}
+	controller->FinishSpawning(FTransform::Identity);
 }
 
 /**
@@ -314,7 +658,8 @@ void ATSToolkitGameMode::_SetUpScreenshotController(USimConfig* Config)
 		return;
 	}
 
-	AScreenshotController* controller = world->SpawnActor<AScreenshotController>(AScreenshotController::StaticClass());
+	// Spawn deferred so the configuration is in place before BeginPlay arms the screenshot timer
+	AScreenshotController* controller = world->SpawnActorDeferred<AScreenshotController>(AScreenshotController::StaticClass(), FTransform::Identity);
 	if (!controller)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Failed to spawn screenshot controller in _SetUpScreenshotController."));
@@ -324,6 +669,21 @@ void ATSToolkitGameMode::_SetUpScreenshotController(USimConfig* Config)
 	controller->bRegisterAllAtBeginPlay = true;
 	controller->ScreenshotInterval = Config->ScreenshotInterval;
 	controller->DelayBetweenScreenshots = Config->DelayBetweenScreenshots;
+	controller->bAcceleratedTime = Config->bIsAcceleratedTime;
+	controller->AcceleratedTimeDilation = Config->AcceleratedTimeDilation;
+	controller->MaxScreenshotQueueDepth = Config->ScreenshotQueueDepth;
+	controller->bStartCaptureAtBeginPlay = false;
+	controller->bWriteAnnotations = Config->bIsAnnotationEnabled;
+
+	UCaptureManifestSubsystem* manifest = world->GetSubsystem<UCaptureManifestSubsystem>();
+	if (manifest)
+	{
+		manifest->SetConfigHash(Config->GetConfigHash());
+	}
+	controller->FinishSpawning(FTransform::Identity);
+
+	// The capture clock starts with the end timer once the spawn controller loaded its cars
+	_ScreenshotController = controller;
 }
 
 /**
@@ -366,12 +726,10 @@ void ATSToolkitGameMode::_SetUpWeatherController(USimConfig* Config)
 		}
 	}
 
-	EDayTimeTypes dayTime = (Config->bIsNight) ? EDayTimeTypes::Night : EDayTimeTypes::Day;
-	EOvercastTypes overcast = (Config->bIsOvercast) ? EOvercastTypes::Overcast : EOvercastTypes::Clear;
-	ERainTypes rain = (Config->bIsRain) ? ERainTypes::Rain : ERainTypes::NoRain;
-
-	controller->SetWeather(dayTime, overcast);
-	controller->SetRain(rain);
+	// The starting weather is applied immediately, only later changes are interpolated
+	float daylight = (Config->bIsNight) ? 0.0f : 1.0f;
+	controller->SetWeatherParameters(daylight, Config->Cloudiness, Config->RainIntensity, 0.0f);
+	controller->TransitionDuration = Config->WeatherTransitionDuration;
 	controller->ChangeDayTime = Config->bIsChangeDayTime;
 	controller->ChangeDayTimeRate = Config->ChangeDayTimeRate;
 	controller->ChangeOvercast = Config->bIsChangeOvercast;
@@ -37,13 +37,6 @@ public:
 	TSubclassOf<AWeatherController> WeatherControllerClass;
 
 public:
-	/**
-	 * Called every frame to update the game mode.
-	 *
-	 * @param DeltaTime The time elapsed since the last frame.
-	 */
-	virtual void Tick(float DeltaTime) override;
-
 	/**
 	 * Checks if the current level is the main menu.
 	 *
@@ -70,12 +63,51 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Called when the game mode is being removed from the level.
+	 * Restores the engine time step changed by the level setup.
+	 *
+	 * @param EndPlayReason The reason the game mode is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Ends the current level and performs cleanup.
 	 */
 	virtual void _EndLevel();
 
 private:
+	/** Screenshot controller of the level, its capture clock starts together with the end timer. */
+	UPROPERTY()
+	class AScreenshotController* _ScreenshotController = nullptr;
+
+	/** Simulated time from the moment the cars are loaded until the level ends, in seconds. */
+	float _SimulationDuration = 0.0f;
+
+	/** Timer ending the level. */
+	FTimerHandle _EndTimerHandle;
+
+	/** Indicates whether the level setup changed the process-wide engine time step. */
+	bool _HasChangedTimeStep = false;
+
+	/** Whether the engine used a fixed time step before the level setup. */
+	bool _PreviousUseFixedTimeStep = false;
+
+	/** Fixed delta time of the engine before the level setup, in seconds. */
+	double _PreviousFixedDeltaTime = 0.0;
+
+	/**
+	 * Starts the capture clock and the end timer once the car spawn controller loaded its cars
+	 * and finished the warm-up, so the time spent loading does not shift the run.
+	 */
+	void _StartSimulationClockWhenCarsReady();
+
+	/**
+	 * Starts the screenshot capture and the timer ending the level.
+	 */
+	UFUNCTION()
+	void _StartSimulationClock();
+
 	/**
 	 * Sets up the UI viewport with the specified widget.
 	 *
@@ -88,6 +120,11 @@ private:
 	 */
 	void _LevelViewportSetup();
 
+	/**
+	 * Logs the actors and components with an enabled tick function, grouped by class.
+	 */
+	void _LogTickAudit();
+
 	// Level setup functions
 
 	/**
@@ -97,6 +134,41 @@ private:
 	 */
 	void _SetUpLevel(USimConfig* Config);
 
+	/**
+	 * Sets up a fixed engine time step if the configuration requests one.
+	 *
+	 * @param Config The simulation configuration to use for setting up the time step.
+	 */
+	void _SetUpTimeStep(USimConfig* Config);
+
+	/**
+	 * Starts recording performance telemetry if the configuration enables it.
+	 *
+	 * @param Config The simulation configuration to use for setting up the telemetry.
+	 */
+	void _SetUpTelemetry(USimConfig* Config);
+
+	/**
+	 * Sets up the traffic manager that advances all spawned cars.
+	 *
+	 * @param Config The simulation configuration to use for setting up the traffic manager.
+	 */
+	void _SetUpTrafficManager(USimConfig* Config);
+
+	/**
+	 * Enables the car light budget if the configuration enables it.
+	 *
+	 * @param Config The simulation configuration to use for setting up the light budget.
+	 */
+	void _SetUpLightBudget(USimConfig* Config);
+
+	/**
+	 * Enables car significance if the configuration enables it.
+	 *
+	 * @param Config The simulation configuration to use for setting up car significance.
+	 */
+	void _SetUpCarSignificance(USimConfig* Config);
+
 	/**
 	 * Sets up the car spawn controller based on the provided simulation configuration.
 	 *
@@ -0,0 +1,326 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TelemetrySubsystem.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Dom/JsonObject.h"
+
+// Static member initialization
+const FString UTelemetrySubsystem::TelemetryDirPath = FPaths::ProjectDir() + "Telemetry/";
+const int32 UTelemetrySubsystem::RowsPerFlush = 120;
+
+/**
+ * Names of the tagged scopes, used as column and summary field names.
+ */
+static const TCHAR* TelemetryScopeNames[(int32)ETelemetryScopes::Count] =
+{
+	TEXT("CarMovement"),
+	TEXT("Spawn"),
+	TEXT("Capture"),
+	TEXT("Weather")
+};
+
+/**
+ * Starts recording a run into a new file.
+ * The CSV header is written immediately so that a run cut short still leaves a readable file.
+ *
+ * @param RunName The name of the run, used as the file name.
+ */
+void UTelemetrySubsystem::StartRun(const FString& RunName)
+{
+	if (_IsRecording)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("StartRun: A run is already recorded, ending it first."));
+		EndRun();
+	}
+
+	_TraceFilePath = TelemetryDirPath + RunName + ".csv";
+	_SummaryFilePath = TelemetryDirPath + RunName + "_summary.json";
+
+	FString header = TEXT("Frame,SimTime,FrameTimeMs,LiveCars,Spawns,Despawns,WaitingCars,ReservedZones,ScreenshotQueueDepth");
+	for (const TCHAR* scopeName : TelemetryScopeNames)
+	{
+		header += FString::Printf(TEXT(",%sMs"), scopeName);
+	}
+	header += LINE_TERMINATOR;
+
+	if (!FFileHelper::SaveStringToFile(header, *_TraceFilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to create telemetry file: %s"), *_TraceFilePath);
+		return;
+	}
+
+	_PendingRows.Reset();
+	_PendingRowsCount = 0;
+	_FramesCount = 0;
+	_TotalFrameSeconds = 0.0;
+	_MaxFrameSeconds = 0.0;
+	_TotalSpawns = 0;
+	_TotalDespawns = 0;
+	_PeakLiveCars = 0;
+	FMemory::Memzero(_TotalScopeSeconds, sizeof(_TotalScopeSeconds));
+	FMemory::Memzero(_FrameScopeSeconds, sizeof(_FrameScopeSeconds));
+	_FrameSpawns = 0;
+	_FrameDespawns = 0;
+
+	_RunStartSeconds = FPlatformTime::Seconds();
+	_LastFrameSeconds = _RunStartSeconds;
+	_IsRecording = true;
+
+	UE_LOG(LogTemp, Log, TEXT("Recording telemetry to %s"), *_TraceFilePath);
+}
+
+/**
+ * Stops recording, appends the buffered rows and writes the run summary.
+ */
+void UTelemetrySubsystem::EndRun()
+{
+	if (!_IsRecording)
+	{
+		return;
+	}
+
+	_FlushRows();
+	_WriteSummary();
+	_IsRecording = false;
+}
+
+/**
+ * Called every frame while a run is recorded to write the frame's row.
+ * The frame time is measured on the wall clock, the simulation time is the world time.
+ *
+ * @param DeltaTime The simulation time elapsed since the last frame.
+ */
+void UTelemetrySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in UTelemetrySubsystem::Tick."));
+		return;
+	}
+
+	double now = FPlatformTime::Seconds();
+	double frameSeconds = now - _LastFrameSeconds;
+	_LastFrameSeconds = now;
+
+	_PendingRows += FString::Printf(TEXT("%lld,%.4f,%.3f,%d,%d,%d,%d,%d,%d"),
+		_FramesCount, world->GetTimeSeconds(), frameSeconds * 1000.0, _LiveCars, _FrameSpawns, _FrameDespawns,
+		_WaitingCars, _ReservedZones, _ScreenshotQueueDepth);
+	for (int32 i = 0; i < (int32)ETelemetryScopes::Count; i++)
+	{
+		_PendingRows += FString::Printf(TEXT(",%.3f"), _FrameScopeSeconds[i] * 1000.0);
+		_TotalScopeSeconds[i] += _FrameScopeSeconds[i];
+		_FrameScopeSeconds[i] = 0.0;
+	}
+	_PendingRows += LINE_TERMINATOR;
+	_PendingRowsCount++;
+
+	_FramesCount++;
+	_TotalFrameSeconds += frameSeconds;
+	_MaxFrameSeconds = FMath::Max(_MaxFrameSeconds, frameSeconds);
+	_TotalSpawns += _FrameSpawns;
+	_TotalDespawns += _FrameDespawns;
+	_PeakLiveCars = FMath::Max(_PeakLiveCars, _LiveCars);
+	_FrameSpawns = 0;
+	_FrameDespawns = 0;
+
+	if (_PendingRowsCount >= RowsPerFlush)
+	{
+		_FlushRows();
+	}
+}
+
+/**
+ * Gets whether the subsystem ticks this frame.
+ *
+ * @return True while a run is recorded.
+ */
+bool UTelemetrySubsystem::IsTickable() const
+{
+	return _IsRecording;
+}
+
+/**
+ * Gets the stat id used to profile the subsystem's tick.
+ *
+ * @return The stat id of the subsystem.
+ */
+TStatId UTelemetrySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTelemetrySubsystem, STATGROUP_Tickables);
+}
+
+/**
+ * Called when the world is torn down. Ends the run if it was not ended before.
+ */
+void UTelemetrySubsystem::Deinitialize()
+{
+	EndRun();
+
+	Super::Deinitialize();
+}
+
+/**
+ * Adds time spent in a tagged scope to the current frame.
+ *
+ * @param Scope The tagged scope.
+ * @param Seconds The time spent in the scope.
+ */
+void UTelemetrySubsystem::AddScopeTime(ETelemetryScopes Scope, double Seconds)
+{
+	int32 index = (int32)Scope;
+	if (index < 0 || index >= (int32)ETelemetryScopes::Count)
+	{
+		UE_LOG(LogTemp, Error, TEXT("AddScopeTime: Invalid scope %d."), index);
+		return;
+	}
+
+	_FrameScopeSeconds[index] += Seconds;
+}
+
+/**
+ * Counts a car spawned this frame.
+ */
+void UTelemetrySubsystem::CountSpawn()
+{
+	_FrameSpawns++;
+}
+
+/**
+ * Counts a car despawned this frame.
+ */
+void UTelemetrySubsystem::CountDespawn()
+{
+	_FrameDespawns++;
+}
+
+/**
+ * Sets the number of cars in the simulation and the number of waiting cars.
+ *
+ * @param LiveCars The number of cars in the simulation.
+ * @param WaitingCars The number of cars stopped by traffic lights or waiting for a critical zone.
+ */
+void UTelemetrySubsystem::SetTrafficCounts(int32 LiveCars, int32 WaitingCars)
+{
+	_LiveCars = LiveCars;
+	_WaitingCars = WaitingCars;
+}
+
+/**
+ * Changes the number of reserved critical zones.
+ *
+ * @param Delta The change of the number of reserved zones.
+ */
+void UTelemetrySubsystem::AddReservedZones(int32 Delta)
+{
+	_ReservedZones = FMath::Max(0, _ReservedZones + Delta);
+}
+
+/**
+ * Sets the number of screenshots queued for encoding.
+ *
+ * @param QueueDepth The screenshot queue depth.
+ */
+void UTelemetrySubsystem::SetScreenshotQueueDepth(int32 QueueDepth)
+{
+	_ScreenshotQueueDepth = QueueDepth;
+}
+
+/**
+ * Appends the buffered rows to the trace file.
+ */
+void UTelemetrySubsystem::_FlushRows()
+{
+	if (_PendingRowsCount <= 0)
+	{
+		return;
+	}
+
+	if (!FFileHelper::SaveStringToFile(_PendingRows, *_TraceFilePath, FFileHelper::EEncodingOptions::AutoDetect,
+		&IFileManager::Get(), FILEWRITE_Append))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to append to telemetry file: %s"), *_TraceFilePath);
+	}
+
+	_PendingRows.Reset();
+	_PendingRowsCount = 0;
+}
+
+/**
+ * Writes the summary of the run to a JSON file and the log.
+ */
+void UTelemetrySubsystem::_WriteSummary()
+{
+	double wallSeconds = FPlatformTime::Seconds() - _RunStartSeconds;
+	double averageFrameMs = (_FramesCount > 0) ? _TotalFrameSeconds * 1000.0 / _FramesCount : 0.0;
+	UWorld* world = GetWorld();
+	double simSeconds = world ? world->GetTimeSeconds() : 0.0;
+
+	TSharedPtr<FJsonObject> jsonObject = MakeShareable(new FJsonObject());
+	jsonObject->SetNumberField(TEXT("Frames"), _FramesCount);
+	jsonObject->SetNumberField(TEXT("WallTime"), wallSeconds);
+	jsonObject->SetNumberField(TEXT("SimTime"), simSeconds);
+	jsonObject->SetNumberField(TEXT("AverageFrameTimeMs"), averageFrameMs);
+	jsonObject->SetNumberField(TEXT("MaxFrameTimeMs"), _MaxFrameSeconds * 1000.0);
+	jsonObject->SetNumberField(TEXT("Spawns"), _TotalSpawns);
+	jsonObject->SetNumberField(TEXT("Despawns"), _TotalDespawns);
+	jsonObject->SetNumberField(TEXT("PeakLiveCars"), _PeakLiveCars);
+
+	TSharedPtr<FJsonObject> scopesObject = MakeShareable(new FJsonObject());
+	for (int32 i = 0; i < (int32)ETelemetryScopes::Count; i++)
+	{
+		scopesObject->SetNumberField(TelemetryScopeNames[i], _TotalScopeSeconds[i] * 1000.0);
+	}
+	jsonObject->SetObjectField(TEXT("ScopeTotalsMs"), scopesObject);
+
+	FString jsonString;
+	TSharedRef<TJsonWriter<TCHAR>> jsonWriter = TJsonWriterFactory<>::Create(&jsonString);
+	if (!FJsonSerializer::Serialize(jsonObject.ToSharedRef(), jsonWriter))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to serialize telemetry summary to JSON."));
+		return;
+	}
+
+	if (!FFileHelper::SaveStringToFile(jsonString, *_SummaryFilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to save telemetry summary to file: %s"), *_SummaryFilePath);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Telemetry: %lld frames in %.1f s wall time (%.1f s simulated), average frame %.2f ms, max %.2f ms, %lld spawns, %lld despawns, peak %d cars."),
+		_FramesCount, wallSeconds, simSeconds, averageFrameMs, _MaxFrameSeconds * 1000.0, _TotalSpawns, _TotalDespawns, _PeakLiveCars);
+}
+
+/**
+ * Constructor for FTelemetryScope. Starts timing the scope.
+ *
+ * @param World The world whose telemetry records the scope.
+ * @param Scope The tagged scope.
+ */
+FTelemetryScope::FTelemetryScope(const UWorld* World, ETelemetryScopes Scope)
+	: _Scope(Scope)
+{
+	UTelemetrySubsystem* telemetry = World ? World->GetSubsystem<UTelemetrySubsystem>() : nullptr;
+	if (telemetry && telemetry->IsRecording())
+	{
+		_Telemetry = telemetry;
+		_StartSeconds = FPlatformTime::Seconds();
+	}
+}
+
+/**
+ * Destructor for FTelemetryScope. Adds the elapsed time to the telemetry.
+ */
+FTelemetryScope::~FTelemetryScope()
+{
+	if (_Telemetry)
+	{
+		_Telemetry->AddScopeTime(_Scope, FPlatformTime::Seconds() - _StartSeconds);
+	}
+}
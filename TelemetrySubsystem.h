@@ -0,0 +1,240 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TelemetrySubsystem.generated.h"
+
+/**
+ * Enum representing the tagged scopes whose time is recorded by the telemetry.
+ * - CarMovement: Advancing the cars along their paths.
+ * - Spawn: Spawning cars at the sources.
+ * - Capture: Capturing and queueing screenshots.
+ * - Weather: Applying weather changes.
+ */
+UENUM()
+enum class ETelemetryScopes : uint8
+{
+	CarMovement,
+	Spawn,
+	Capture,
+	Weather,
+	Count UMETA(Hidden)
+};
+
+/**
+ * UTelemetrySubsystem records a row of performance counters for every frame of a simulation run.
+ * Rows are buffered and appended to a CSV file named after the run, and a JSON summary is written at the end of the run.
+ * The subsystem only ticks while a run is being recorded.
+ */
+UCLASS()
+class TSTOOLKIT_API UTelemetrySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Directory path where telemetry files are stored. */
+	static const FString TelemetryDirPath;
+
+	/** Number of rows buffered before they are appended to the file. */
+	static const int32 RowsPerFlush;
+
+private:
+	/** Indicates whether a run is being recorded. */
+	bool _IsRecording = false;
+
+	/** Path of the CSV file of the current run. */
+	FString _TraceFilePath;
+
+	/** Path of the JSON summary of the current run. */
+	FString _SummaryFilePath;
+
+	/** Rows not yet appended to the file. */
+	FString _PendingRows;
+
+	/** Number of rows in _PendingRows. */
+	int32 _PendingRowsCount = 0;
+
+	/** Wall clock time of the previous recorded frame. */
+	double _LastFrameSeconds = 0.0;
+
+	/** Wall clock time at which the run started. */
+	double _RunStartSeconds = 0.0;
+
+	// Per-frame counters
+	/** Cars spawned this frame. */
+	int32 _FrameSpawns = 0;
+
+	/** Cars despawned this frame. */
+	int32 _FrameDespawns = 0;
+
+	/** Time spent in each tagged scope this frame, in seconds. */
+	double _FrameScopeSeconds[(int32)ETelemetryScopes::Count] = {};
+
+	// Gauges
+	/** Cars currently in the simulation. */
+	int32 _LiveCars = 0;
+
+	/** Cars currently stopped by traffic lights or waiting for a critical zone. */
+	int32 _WaitingCars = 0;
+
+	/** Critical zones currently reserved. */
+	int32 _ReservedZones = 0;
+
+	/** Screenshots currently queued for encoding. */
+	int32 _ScreenshotQueueDepth = 0;
+
+	// Run totals
+	/** Number of recorded frames. */
+	int64 _FramesCount = 0;
+
+	/** Sum of the wall clock frame times, in seconds. */
+	double _TotalFrameSeconds = 0.0;
+
+	/** Longest wall clock frame time, in seconds. */
+	double _MaxFrameSeconds = 0.0;
+
+	/** Total number of spawned cars. */
+	int64 _TotalSpawns = 0;
+
+	/** Total number of despawned cars. */
+	int64 _TotalDespawns = 0;
+
+	/** Highest number of cars in the simulation at the same time. */
+	int32 _PeakLiveCars = 0;
+
+	/** Total time spent in each tagged scope, in seconds. */
+	double _TotalScopeSeconds[(int32)ETelemetryScopes::Count] = {};
+
+public:
+	/**
+	 * Starts recording a run into a new file.
+	 *
+	 * @param RunName The name of the run, used as the file name.
+	 */
+	void StartRun(const FString& RunName);
+
+	/**
+	 * Stops recording, appends the buffered rows and writes the run summary.
+	 */
+	void EndRun();
+
+	/**
+	 * Called every frame while a run is recorded to write the frame's row.
+	 *
+	 * @param DeltaTime The simulation time elapsed since the last frame.
+	 */
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Gets whether the subsystem ticks this frame.
+	 *
+	 * @return True while a run is recorded.
+	 */
+	virtual bool IsTickable() const override;
+
+	/**
+	 * Gets the stat id used to profile the subsystem's tick.
+	 *
+	 * @return The stat id of the subsystem.
+	 */
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Called when the world is torn down. Ends the run if it was not ended before.
+	 */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Adds time spent in a tagged scope to the current frame.
+	 *
+	 * @param Scope The tagged scope.
+	 * @param Seconds The time spent in the scope.
+	 */
+	void AddScopeTime(ETelemetryScopes Scope, double Seconds);
+
+	/**
+	 * Counts a car spawned this frame.
+	 */
+	void CountSpawn();
+
+	/**
+	 * Counts a car despawned this frame.
+	 */
+	void CountDespawn();
+
+	/**
+	 * Sets the number of cars in the simulation and the number of waiting cars.
+	 *
+	 * @param LiveCars The number of cars in the simulation.
+	 * @param WaitingCars The number of cars stopped by traffic lights or waiting for a critical zone.
+	 */
+	void SetTrafficCounts(int32 LiveCars, int32 WaitingCars);
+
+	/**
+	 * Changes the number of reserved critical zones.
+	 *
+	 * @param Delta The change of the number of reserved zones.
+	 */
+	void AddReservedZones(int32 Delta);
+
+	/**
+	 * Sets the number of screenshots queued for encoding.
+	 *
+	 * @param QueueDepth The screenshot queue depth.
+	 */
+	void SetScreenshotQueueDepth(int32 QueueDepth);
+
+	/**
+	 * Gets whether a run is being recorded.
+	 *
+	 * @return True while a run is recorded.
+	 */
+	FORCEINLINE bool IsRecording() const
+	{
+		return _IsRecording;
+	}
+
+private:
+	/**
+	 * Appends the buffered rows to the trace file.
+	 */
+	void _FlushRows();
+
+	/**
+	 * Writes the summary of the run to a JSON file and the log.
+	 */
+	void _WriteSummary();
+};
+
+/**
+ * FTelemetryScope adds the time spent between its construction and destruction to a tagged scope of the world's telemetry.
+ * Does nothing if the world has no telemetry subsystem or no run is recorded.
+ */
+class TSTOOLKIT_API FTelemetryScope
+{
+public:
+	/**
+	 * Constructor for FTelemetryScope. Starts timing the scope.
+	 *
+	 * @param World The world whose telemetry records the scope.
+	 * @param Scope The tagged scope.
+	 */
+	FTelemetryScope(const UWorld* World, ETelemetryScopes Scope);
+
+	/**
+	 * Destructor for FTelemetryScope. Adds the elapsed time to the telemetry.
+	 */
+	~FTelemetryScope();
+
+private:
+	/** Telemetry recording the scope, or nullptr if nothing is recorded. */
+	UTelemetrySubsystem* _Telemetry = nullptr;
+
+	/** The tagged scope. */
+	ETelemetryScopes _Scope;
+
+	/** Wall clock time at which the scope started. */
+	double _StartSeconds = 0.0;
+};
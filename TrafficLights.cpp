@@ -5,6 +5,7 @@
 #include "Components/BoxComponent.h"
 #include "Components/SpotLightComponent.h"
 #include "Car.h"
+#include "TrafficRegistrySubsystem.h"
 
 /**
  * Constructor for ATrafficLights.
@@ -12,8 +13,8 @@
  */
 ATrafficLights::ATrafficLights()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Initialize the traffic light's mesh component
 	TrafficLightsMeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("TrafficLightsMeshComponent"));
@@ -80,13 +81,35 @@ void ATrafficLights::BeginPlay()
 }
 
 /**
- * Called every frame to update the actor.
+ * Called after the actor's components are initialized.
+ * Registers the traffic lights with the traffic registry before any actor begins play.
+ */
+void ATrafficLights::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterTrafficLights(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the traffic lights from the traffic registry.
  *
- * @param DeltaTime The time elapsed since the last frame.
+ * @param EndPlayReason The reason the actor is being removed.
  */
-void ATrafficLights::Tick(float DeltaTime)
+void ATrafficLights::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterTrafficLights(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
@@ -117,37 +140,65 @@ void ATrafficLights::SetTrafficLightsState(ETrafficLightsStates NewState)
 }
 
 /**
- * Sets whether cars are allowed to move based on the traffic light's state.
+ * Adds a car to the cars waiting for green.
+ * Cars are kept in order of arrival.
+ *
+ * @param Car The car stopped by the traffic lights.
+ */
+void ATrafficLights::AddWaitingCar(ACar* Car)
+{
+	if (!Car)
+	{
+		UE_LOG(LogTemp, Error, TEXT("AddWaitingCar called with a null Car."));
+		return;
+	}
+
+	_WaitingCars.AddUnique(Car);
+}
+
+/**
+ * Removes a car from the cars waiting for green.
+ *
+ * @param Car The car to remove.
+ */
+void ATrafficLights::RemoveWaitingCar(ACar* Car)
+{
+	_WaitingCars.Remove(Car);
+}
+
+/**
+ * Sets whether the waiting cars are allowed to move based on the traffic light's state.
+ * Only the cars stopped by these traffic lights are notified, in order of arrival.
+ * Released cars leave the waiting list.
  *
  * @param CarsMoveValue True if cars are allowed to move, false otherwise.
  */
 void ATrafficLights::_SetCarsMove(bool CarsMoveValue)
 {
-	if (!TrafficLightsEffectBox)
+	if (_WaitingCars.Num() <= 0)
 	{
-		UE_LOG(LogTemp, Error, TEXT("TrafficLightsEffectBox is null in _SetCarsMove."));
 		return;
 	}
 
-	// Get all actors overlapping the effect box
-	TArray<AActor*> overlappingActors;
-	TrafficLightsEffectBox->GetOverlappingActors(overlappingActors);
+	// The list is swapped out first because released cars may re-enter it
+	TArray<ACar*> waitingCars = MoveTemp(_WaitingCars);
+	_WaitingCars.Reset();
 
-	// Update the movement state of overlapping cars
-	for (AActor* actor : overlappingActors)
+	for (ACar* car : waitingCars)
 	{
-		if (!actor)
+		if (!car)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Null actor found in _SetCarsMove."));
+			UE_LOG(LogTemp, Warning, TEXT("Null car found in _SetCarsMove."));
 			continue;
 		}
 
-		ACar* car = Cast<ACar>(actor);
-		if (!car)
+		if (CarsMoveValue)
 		{
-			continue;
+			car->ReleaseFromTrafficLights(this);
+		}
+		else
+		{
+			_WaitingCars.Add(car);
 		}
-
-		car->SetCanMove(CarsMoveValue);
 	}
 }
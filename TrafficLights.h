@@ -7,6 +7,8 @@
 #include "GameFramework/Actor.h"
 #include "TrafficLights.generated.h"
 
+class ACar;
+
 /**
  * Enum representing the states of traffic lights.
  * - Green: Cars can move.
@@ -61,6 +63,11 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Traffic Lights Details")
 	ETrafficLightsStates CurrentState = ETrafficLightsStates::Green;
 
+private:
+	/** Cars stopped by these traffic lights, in order of arrival. */
+	UPROPERTY()
+	TArray<ACar*> _WaitingCars;
+
 protected:
 	/**
 	 * Called when the game starts or when the actor is spawned.
@@ -68,14 +75,21 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
-public:
 	/**
-	 * Called every frame to update the actor.
+	 * Called after the actor's components are initialized.
+	 * Registers the traffic lights with the traffic registry before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the traffic lights from the traffic registry.
 	 *
-	 * @param DeltaTime The time elapsed since the last frame.
+	 * @param EndPlayReason The reason the actor is being removed.
 	 */
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+public:
 	/**
 	 * Sets the state of the traffic lights.
 	 *
@@ -115,9 +129,33 @@ public:
 		return CurrentState == ETrafficLightsStates::Red;
 	}
 
+	/**
+	 * Adds a car to the cars waiting for green.
+	 *
+	 * @param Car The car stopped by the traffic lights.
+	 */
+	void AddWaitingCar(ACar* Car);
+
+	/**
+	 * Removes a car from the cars waiting for green.
+	 *
+	 * @param Car The car to remove.
+	 */
+	void RemoveWaitingCar(ACar* Car);
+
+	/**
+	 * Gets the number of cars waiting for green.
+	 *
+	 * @return The number of waiting cars.
+	 */
+	FORCEINLINE int32 GetWaitingCarsCount() const
+	{
+		return _WaitingCars.Num();
+	}
+
 protected:
 	/**
-	 * Sets whether cars are allowed to move based on the traffic light's state.
+	 * Sets whether the waiting cars are allowed to move based on the traffic light's state.
 	 *
 	 * @param CarsMoveValue True if cars are allowed to move, false otherwise.
 	 */
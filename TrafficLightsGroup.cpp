@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "TrafficLightsGroup.h"
+#include "TrafficRegistrySubsystem.h"
 
 /**
  * Constructor for ATrafficLightsGroup.
@@ -8,8 +9,8 @@
  */
 ATrafficLightsGroup::ATrafficLightsGroup()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 /**
@@ -22,6 +23,38 @@ void ATrafficLightsGroup::BeginPlay()
 	_InitTrafficLightsList();
 }
 
+/**
+ * Called after the actor's components are initialized.
+ * Registers the traffic light group with the traffic registry before any actor begins play.
+ */
+void ATrafficLightsGroup::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterTrafficLightsGroup(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the traffic light group from the traffic registry.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void ATrafficLightsGroup::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterTrafficLightsGroup(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 /**
  * Initializes the list of traffic lights in the group.
  * Sets the default state for all traffic lights in the list.
@@ -46,16 +79,6 @@ void ATrafficLightsGroup::_InitTrafficLightsList()
 	}
 }
 
-/**
- * Called every frame to update the actor.
- *
- * @param DeltaTime The time elapsed since the last frame.
- */
-void ATrafficLightsGroup::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 /**
  * Sets the state of all traffic lights in the group.
  *
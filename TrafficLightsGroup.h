@@ -45,19 +45,26 @@ protected:
 	virtual void BeginPlay() override;
 
 	/**
-	 * Initializes the list of traffic lights in the group.
-	 * This method is called during BeginPlay to populate the TrafficLightsList.
+	 * Called after the actor's components are initialized.
+	 * Registers the traffic light group with the traffic registry before any actor begins play.
 	 */
-	virtual void _InitTrafficLightsList();
+	virtual void PostInitializeComponents() override;
 
-public:
 	/**
-	 * Called every frame to update the actor.
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the traffic light group from the traffic registry.
 	 *
-	 * @param DeltaTime The time elapsed since the last frame.
+	 * @param EndPlayReason The reason the actor is being removed.
 	 */
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	/**
+	 * Initializes the list of traffic lights in the group.
+	 * This method is called during BeginPlay to populate the TrafficLightsList.
+	 */
+	virtual void _InitTrafficLightsList();
+
+public:
 	/**
 	 * Sets the state of all traffic lights in the group.
 	 *
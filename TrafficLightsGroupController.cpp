@@ -2,7 +2,7 @@
 
 #include "TrafficLightsGroupController.h"
 #include "TrafficLightsGroup.h"
-#include "Kismet/GameplayStatics.h"
+#include "TrafficRegistrySubsystem.h"
 
 /**
  * Constructor for ATrafficLightsGroupController.
@@ -10,8 +10,8 @@
  */
 ATrafficLightsGroupController::ATrafficLightsGroupController()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Set this actor to not call Tick() every frame to improve performance.
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 /**
@@ -49,16 +49,6 @@ void ATrafficLightsGroupController::BeginPlay()
 	}
 }
 
-/**
- * Called every frame to update the actor.
- *
- * @param DeltaTime The time elapsed since the last frame.
- */
-void ATrafficLightsGroupController::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 /**
  * Advances to the next traffic light group and updates its state.
  */
@@ -81,35 +71,24 @@ void ATrafficLightsGroupController::NextGroup()
  */
 void ATrafficLightsGroupController::_RegisterAllGroups()
 {
-	UWorld* world = GetWorld();
-	if (!world)
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!registry)
 	{
-		UE_LOG(LogTemp, Error, TEXT("_RegisterAllGroups: World is null."));
+		UE_LOG(LogTemp, Error, TEXT("_RegisterAllGroups: Traffic registry is null."));
 		return;
 	}
 
 	TrafficLightsGroups.Empty();
 
-	TArray<AActor*> found;
-	UGameplayStatics::GetAllActorsOfClass(world, ATrafficLightsGroup::StaticClass(), found);
-
-	for (AActor* actor : found)
+	for (ATrafficLightsGroup* group : registry->GetTrafficLightsGroups())
 	{
-		if (!actor)
+		if (!group)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("_RegisterAllGroups: Null actor found."));
+			UE_LOG(LogTemp, Warning, TEXT("_RegisterAllGroups: Null group found."));
 			continue;
 		}
 
-		ATrafficLightsGroup* group = Cast<ATrafficLightsGroup>(actor);
-		if (group)
-		{
-			TrafficLightsGroups.Add(group);
-		}
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("_RegisterAllGroups: Failed to cast actor to ATrafficLightsGroup."));
-		}
+		TrafficLightsGroups.Add(group);
 	}
 }
 
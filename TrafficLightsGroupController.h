@@ -52,13 +52,6 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
-	/**
-	 * Called every frame to update the actor.
-	 *
-	 * @param DeltaTime The time elapsed since the last frame.
-	 */
-	virtual void Tick(float DeltaTime) override;
-
 	/**
 	 * Advances to the next traffic light group and updates its state.
 	 */
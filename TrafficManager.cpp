@@ -0,0 +1,1221 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrafficManager.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Components/BoxComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Car.h"
+#include "CarFollowingModel.h"
+#include "CarPath.h"
+#include "CriticalZone.h"
+#include "TelemetrySubsystem.h"
+#include "TrafficLights.h"
+#include "TrafficRegistrySubsystem.h"
+#include "TSToolkit.h"
+
+DECLARE_CYCLE_STAT(TEXT("Traffic Step"), STAT_TrafficStep, STATGROUP_TSToolkit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Cars"), STAT_LiveCars, STATGROUP_TSToolkit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Waiting Cars"), STAT_WaitingCars, STATGROUP_TSToolkit);
+DECLARE_CYCLE_STAT(TEXT("Traffic Compute"), STAT_TrafficCompute, STATGROUP_TSToolkit);
+DECLARE_CYCLE_STAT(TEXT("Traffic Commit"), STAT_TrafficCommit, STATGROUP_TSToolkit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Instanced Cars"), STAT_InstancedCars, STATGROUP_TSToolkit);
+
+/** Number of cars advanced by the car following model in a single task, a multiple of the vector width. */
+static const int32 CarFollowingChunkSize = 1024;
+
+/** Default number of steps run by the TSToolkit.BenchTrafficStep console command. */
+static const int32 DefaultBenchmarkSteps = 100;
+
+/** Simulated time of a step run by the TSToolkit.BenchTrafficStep console command. */
+static const float BenchmarkDeltaTime = 1.0f / 30.0f;
+
+/**
+ * Runs the compute phase of the traffic step of the world's traffic manager serially and in parallel
+ * and logs the average step times and the speedup.
+ *
+ * @param Args The optional number of steps.
+ * @param World The world of the traffic manager.
+ */
+static void BenchTrafficStep(const TArray<FString>& Args, UWorld* World)
+{
+	if (!World)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in BenchTrafficStep."));
+		return;
+	}
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(World);
+	ATrafficManager* trafficManager = registry ? registry->GetTrafficManager() : nullptr;
+	if (!trafficManager)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BenchTrafficStep: The level has no traffic manager."));
+		return;
+	}
+
+	int32 steps = DefaultBenchmarkSteps;
+	if (Args.Num() > 0 && Args[0].IsNumeric())
+	{
+		steps = FMath::Max(FCString::Atoi(*Args[0]), 1);
+	}
+
+	double serialSeconds = trafficManager->BenchmarkSteps(steps, BenchmarkDeltaTime, false);
+	double parallelSeconds = trafficManager->BenchmarkSteps(steps, BenchmarkDeltaTime, true);
+	double speedup = (parallelSeconds > 0.0) ? serialSeconds / parallelSeconds : 0.0;
+
+	UE_LOG(LogTemp, Log, TEXT("BenchTrafficStep: %d cars, %d steps, %d worker threads, serial %.3f ms, parallel %.3f ms, speedup %.2fx."),
+		trafficManager->GetCarsCount(), steps, FTaskGraphInterface::Get().GetNumWorkerThreads(),
+		serialSeconds * 1000.0, parallelSeconds * 1000.0, speedup);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchTrafficStepCommand(
+	TEXT("TSToolkit.BenchTrafficStep"),
+	TEXT("Times the compute phase of the traffic step serially and in parallel. Usage: TSToolkit.BenchTrafficStep [Steps]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchTrafficStep));
+
+/**
+ * Gets the flags of a ParallelFor over the cars.
+ *
+ * @param bParallel True to run on worker threads, false to run on the calling thread.
+ * @return The flags of the ParallelFor.
+ */
+static EParallelForFlags GetParallelForFlags(bool bParallel)
+{
+	return bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+}
+
+/**
+ * Constructor for ATrafficManager.
+ * The manager ticks after physics so that overlap events raised this frame are already applied to the car state.
+ */
+ATrafficManager::ATrafficManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+/**
+ * Called when the game starts or when the actor is spawned.
+ * Used for initialization logic.
+ */
+void ATrafficManager::BeginPlay()
+{
+	Super::BeginPlay();
+}
+
+/**
+ * Called after the actor's components are initialized.
+ * Registers the traffic manager with the traffic registry before any actor begins play.
+ */
+void ATrafficManager::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->RegisterTrafficManager(this);
+	}
+}
+
+/**
+ * Called when the actor is being removed from the level.
+ * Unregisters the traffic manager from the traffic registry.
+ *
+ * @param EndPlayReason The reason the actor is being removed.
+ */
+void ATrafficManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (registry)
+	{
+		registry->UnregisterTrafficManager(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * Called every frame to advance all managed cars.
+ * With a fixed time step the frame time is accumulated and consumed in steps of FixedTimeStep,
+ * so the simulated trajectory does not depend on the render frame rate.
+ *
+ * @param DeltaTime The time elapsed since the last frame.
+ */
+void ATrafficManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (FixedTimeStep <= 0.0f)
+	{
+		if (_Cars.Num() > 0)
+		{
+			_Step(DeltaTime);
+		}
+		_ReportCounts();
+		return;
+	}
+
+	_TimeAccumulator += DeltaTime;
+
+	int steps = 0;
+	while (_TimeAccumulator >= FixedTimeStep && steps < MaxSubSteps)
+	{
+		_TimeAccumulator -= FixedTimeStep;
+		steps++;
+
+		if (_Cars.Num() > 0)
+		{
+			_Step(FixedTimeStep);
+		}
+	}
+
+	if (steps >= MaxSubSteps && _TimeAccumulator >= FixedTimeStep)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Tick: Traffic manager fell behind by %f s, dropping it."), _TimeAccumulator);
+		_TimeAccumulator = FMath::Fmod(_TimeAccumulator, FixedTimeStep);
+	}
+
+	_ReportCounts();
+}
+
+/**
+ * Runs a single simulation step over all managed cars.
+ * In the compute phase car following is resolved from the positions at the start of the step and movement is computed
+ * over the contiguous state arrays, on worker threads for large enough steps. In the serial commit phase the transforms
+ * are applied to the actors and the cars that reached their destination are handled.
+ *
+ * @param DeltaTime The simulated time of the step.
+ */
+void ATrafficManager::_Step(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TrafficStep);
+	FTelemetryScope telemetryScope(GetWorld(), ETelemetryScopes::CarMovement);
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TrafficCompute);
+
+		if (bUseProximityIndex)
+		{
+			_UpdateProximity();
+		}
+
+		_AdvanceCars(DeltaTime);
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_TrafficCommit);
+	_CommitTransforms();
+	_HandleCarEvents();
+}
+
+/**
+ * Measures the compute phase of the step, the car following and movement, without moving the car actors.
+ * The state of the cars is restored afterwards, so the simulation is not affected.
+ *
+ * @param Steps The number of steps to run.
+ * @param DeltaTime The simulated time of each step.
+ * @param bParallel True to run the steps on worker threads, false to run them on the game thread.
+ * @return The average time of a step, in seconds.
+ */
+double ATrafficManager::BenchmarkSteps(int32 Steps, float DeltaTime, bool bParallel)
+{
+	if (Steps <= 0 || _Cars.Num() <= 0)
+	{
+		return 0.0;
+	}
+
+	TArray<float> distances = _Distances;
+	TArray<float> speeds = _Speeds;
+	TArray<ETrafficCarFlags> flags = _Flags;
+	TArray<FVector> locations = _Locations;
+	TArray<FQuat> rotations = _Rotations;
+
+	bool wasParallelUpdate = bParallelUpdate;
+	int32 minParallelCars = MinParallelCars;
+	bParallelUpdate = bParallel;
+	MinParallelCars = 0;
+	_IsSerialForced = !bParallel;
+
+	double start = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Steps; i++)
+	{
+		_UpdateProximity();
+		_AdvanceCars(DeltaTime);
+	}
+	double seconds = FPlatformTime::Seconds() - start;
+
+	bParallelUpdate = wasParallelUpdate;
+	MinParallelCars = minParallelCars;
+	_IsSerialForced = false;
+
+	_Distances = MoveTemp(distances);
+	_Speeds = MoveTemp(speeds);
+	_Flags = MoveTemp(flags);
+	_Locations = MoveTemp(locations);
+	_Rotations = MoveTemp(rotations);
+	_MovedIndices.Reset();
+
+	return seconds / Steps;
+}
+
+/**
+ * Registers a car with the manager and disables the car's own tick.
+ *
+ * @param Car The car to register.
+ */
+void ATrafficManager::RegisterCar(ACar* Car)
+{
+	if (!Car)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RegisterCar called with a null Car."));
+		return;
+	}
+
+	if (Car->GetTrafficIndex() != INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RegisterCar: Car is already registered."));
+		return;
+	}
+
+	if (!Car->GetPath())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RegisterCar: Path of the car is null."));
+		return;
+	}
+
+	ETrafficCarFlags flags = ETrafficCarFlags::None;
+	if (Car->GetCanMove())
+	{
+		flags |= ETrafficCarFlags::CanMove;
+	}
+	if (Car->GetReachedDestination())
+	{
+		flags |= ETrafficCarFlags::ReachedDestination;
+	}
+	if (Car->IsWaitingForCriticalZone())
+	{
+		flags |= ETrafficCarFlags::WaitingForCriticalZone;
+	}
+
+	int32 index = _Cars.Add(Car);
+	_Distances.Add(Car->GetDistanceAlongSpline());
+	_Speeds.Add(Car->StaticSpeed);
+	_DesiredSpeeds.Add(Car->StaticSpeed);
+	_MaxAccelerations.Add(Car->MaxAcceleration);
+	_ComfortableDecelerations.Add(Car->ComfortableDeceleration);
+	_MinimumGaps.Add(Car->MinimumGap);
+	_TimeHeadways.Add(Car->TimeHeadway);
+	_PathIndices.Add(_GetPathIndex(Car->GetPath()));
+	_Offsets.Add(Car->GetMovementOffset());
+	_Flags.Add(flags);
+	_Locations.Add(Car->GetActorLocation());
+	_Rotations.Add(Car->GetActorQuat());
+	_SafeReaches.Add(Car->GetSafeDistanceReach());
+	_HalfExtents.Add(Car->GetBodyHalfExtent());
+	_Priorities.Add(Car->GetMovementPriority());
+	_InstanceBatchIndices.Add(INDEX_NONE);
+	_InstanceSlots.Add(INDEX_NONE);
+
+	Car->SetTrafficHandle(this, index);
+	Car->SetActorTickEnabled(false);
+	UpdateCarInstance(Car);
+
+	// Car following is resolved by the proximity index, the physics scene does not need car pairs
+	if (bUseProximityIndex)
+	{
+		Car->SetCarOverlapsEnabled(false);
+	}
+}
+
+/**
+ * Unregisters a car from the manager and re-enables the car's own tick.
+ * The last car is swapped into the freed slot to keep the state arrays contiguous.
+ *
+ * @param Car The car to unregister.
+ */
+void ATrafficManager::UnregisterCar(ACar* Car)
+{
+	if (!Car)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UnregisterCar called with a null Car."));
+		return;
+	}
+
+	int32 index = Car->GetTrafficIndex();
+	if (!_Cars.IsValidIndex(index) || _Cars[index] != Car)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UnregisterCar: Car is not registered with this manager."));
+		return;
+	}
+
+	_ReleaseCarInstance(index);
+
+	// Write the managed state back so the car can continue on its own
+	Car->SetTrafficHandle(nullptr, INDEX_NONE);
+	Car->SetInitDistanceAlongSpline(_Distances[index]);
+	Car->SetActorTickEnabled(true);
+	if (bUseProximityIndex)
+	{
+		Car->SetCarOverlapsEnabled(true);
+	}
+
+	_Cars.RemoveAtSwap(index, 1, false);
+	_Distances.RemoveAtSwap(index, 1, false);
+	_Speeds.RemoveAtSwap(index, 1, false);
+	_DesiredSpeeds.RemoveAtSwap(index, 1, false);
+	_MaxAccelerations.RemoveAtSwap(index, 1, false);
+	_ComfortableDecelerations.RemoveAtSwap(index, 1, false);
+	_MinimumGaps.RemoveAtSwap(index, 1, false);
+	_TimeHeadways.RemoveAtSwap(index, 1, false);
+	_PathIndices.RemoveAtSwap(index, 1, false);
+	_Offsets.RemoveAtSwap(index, 1, false);
+	_Flags.RemoveAtSwap(index, 1, false);
+	_Locations.RemoveAtSwap(index, 1, false);
+	_Rotations.RemoveAtSwap(index, 1, false);
+	_SafeReaches.RemoveAtSwap(index, 1, false);
+	_HalfExtents.RemoveAtSwap(index, 1, false);
+	_Priorities.RemoveAtSwap(index, 1, false);
+	_InstanceBatchIndices.RemoveAtSwap(index, 1, false);
+	_InstanceSlots.RemoveAtSwap(index, 1, false);
+
+	if (_Cars.IsValidIndex(index) && _Cars[index])
+	{
+		_Cars[index]->SetTrafficHandle(this, index);
+	}
+}
+
+/**
+ * Sets or clears a state flag of a managed car.
+ *
+ * @param Index The traffic index of the car.
+ * @param Flag The flag to update.
+ * @param bValue True to set the flag, false to clear it.
+ */
+void ATrafficManager::SetCarFlag(int32 Index, ETrafficCarFlags Flag, bool bValue)
+{
+	if (!_Flags.IsValidIndex(Index))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SetCarFlag: Invalid index %d."), Index);
+		return;
+	}
+
+	if (bValue)
+	{
+		_Flags[Index] |= Flag;
+	}
+	else
+	{
+		_Flags[Index] &= ~Flag;
+	}
+}
+
+/**
+ * Gets the distance a managed car has travelled along its path.
+ *
+ * @param Index The traffic index of the car.
+ * @return The distance along the path spline, or zero for an invalid index.
+ */
+float ATrafficManager::GetCarDistance(int32 Index) const
+{
+	if (!_Distances.IsValidIndex(Index))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GetCarDistance: Invalid index %d."), Index);
+		return 0.0f;
+	}
+
+	return _Distances[Index];
+}
+
+/**
+ * Gets the current speed of a managed car, zero while the car is stopped.
+ * Uses the same conditions as _AdvanceCars to decide whether the car moves.
+ *
+ * @param Index The traffic index of the car.
+ * @return The speed of the car, in units per second, or zero for an invalid index.
+ */
+float ATrafficManager::GetCarSpeed(int32 Index) const
+{
+	if (!_Speeds.IsValidIndex(Index))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GetCarSpeed: Invalid index %d."), Index);
+		return 0.0f;
+	}
+
+	bool isMoving = EnumHasAnyFlags(_Flags[Index], ETrafficCarFlags::CanMove)
+		&& !EnumHasAnyFlags(_Flags[Index], ETrafficCarFlags::ReachedDestination | ETrafficCarFlags::BlockedByCar);
+	return isMoving ? _Speeds[Index] : 0.0f;
+}
+
+/**
+ * Updates the BlockedByCar flag of all cars from the positions at the start of the step.
+ * With the car following model the gap of every car to its leader or nearest closed obstacle is updated instead,
+ * and no car is blocked. Every car is evaluated against the same snapshot, so the result does not depend
+ * on the order of the cars.
+ */
+void ATrafficManager::_UpdateProximity()
+{
+	_BlockedByCar.Reset();
+	_BlockedByCar.SetNumZeroed(_Cars.Num());
+
+	if (IsCarFollowingModelActive())
+	{
+		_Gaps.Init(FCarFollowingModel::NoObstacleGap, _Cars.Num());
+		_LeaderSpeeds.Init(0.0f, _Cars.Num());
+	}
+
+	_UpdateLanes();
+	_UpdateOtherPaths();
+
+	if (IsCarFollowingModelActive())
+	{
+		_UpdateStopLines();
+	}
+
+	ParallelFor(_Cars.Num(), [this](int32 i)
+		{
+			if (_BlockedByCar[i])
+			{
+				_Flags[i] |= ETrafficCarFlags::BlockedByCar;
+			}
+			else
+			{
+				_Flags[i] &= ~ETrafficCarFlags::BlockedByCar;
+			}
+		}, GetParallelForFlags(_IsParallelStep()));
+}
+
+/**
+ * Checks whether the compute phase of the step runs on worker threads.
+ * Small steps stay on the game thread, where they finish faster than the tasks could be scheduled.
+ *
+ * @return True if the step is parallel, false if it runs on the game thread.
+ */
+bool ATrafficManager::_IsParallelStep() const
+{
+	return bParallelUpdate && !_IsSerialForced && _Cars.Num() >= MinParallelCars;
+}
+
+/**
+ * Checks whether the cars move with the car following model.
+ * The model reads the gaps from the proximity index, without it cars keep stopping instantly.
+ * Managed cars then brake for red lights and reserved zones at the stop lines instead of stopping on overlap.
+ *
+ * @return True if the car following model is used, false if cars stop instantly.
+ */
+bool ATrafficManager::IsCarFollowingModelActive() const
+{
+	return bUseCarFollowingModel && bUseProximityIndex;
+}
+
+/**
+ * Rebuilds the per-path lanes and marks every car that is too close to its leader on the same path.
+ * A follower keeps its distance while the leader's body is within the reach of the follower's safe box,
+ * or with the car following model gets the gap to its leader's body.
+ * The lanes are processed in parallel, every car belongs to a single lane.
+ */
+void ATrafficManager::_UpdateLanes()
+{
+	_PathLanes.SetNum(_Paths.Num());
+	for (TArray<int32>& lane : _PathLanes)
+	{
+		lane.Reset();
+	}
+
+	for (int32 i = 0; i < _Cars.Num(); i++)
+	{
+		_PathLanes[_PathIndices[i]].Add(i);
+	}
+
+	const bool useCarFollowingModel = IsCarFollowingModelActive();
+	ParallelFor(_PathLanes.Num(), [this, useCarFollowingModel](int32 laneIndex)
+		{
+			TArray<int32>& lane = _PathLanes[laneIndex];
+			lane.Sort([this](int32 left, int32 right)
+				{
+					return _Distances[left] > _Distances[right];
+				});
+
+			for (int32 i = 1; i < lane.Num(); i++)
+			{
+				int32 leader = lane[i - 1];
+				int32 follower = lane[i];
+				float gap = _Distances[leader] - _Distances[follower];
+				if (useCarFollowingModel)
+				{
+					_Gaps[follower] = FMath::Max(gap - _HalfExtents[leader].X - _HalfExtents[follower].X, 0.0f);
+					_LeaderSpeeds[follower] = _Speeds[leader];
+				}
+				else if (gap < _SafeReaches[follower] + _HalfExtents[leader].X)
+				{
+					_BlockedByCar[follower] = true;
+				}
+			}
+		}, GetParallelForFlags(_IsParallelStep()));
+}
+
+/**
+ * Rebuilds the grid and marks every car whose safe area contains a car on another path.
+ * Every pair of paths is tested, like the safe box overlaps this replaces, since paths that are not related
+ * may still meet after a junction or merge outside a critical zone. Cars on the same path are left to the lanes.
+ * When two cars block each other, only the car with the lower movement priority value moves.
+ * With the car following model the blocking car becomes a standing obstacle if it is closer than the car's leader.
+ * The grid is built serially and queried in parallel, each query only writes the flag of its own car.
+ */
+void ATrafficManager::_UpdateOtherPaths()
+{
+	_ProximityGrid.Reset();
+
+	for (int32 i = 0; i < _Cars.Num(); i++)
+	{
+		if (_Paths[_PathIndices[i]])
+		{
+			_ProximityGrid.FindOrAdd(_GetCell(_Locations[i])).Add(i);
+		}
+	}
+
+	const bool useCarFollowingModel = IsCarFollowingModelActive();
+	ParallelFor(_Cars.Num(), [this, useCarFollowingModel](int32 i)
+		{
+			if (_BlockedByCar[i] || !_Paths[_PathIndices[i]])
+			{
+				return;
+			}
+
+			FIntPoint cell = _GetCell(_Locations[i]);
+			for (int32 x = cell.X - 1; x <= cell.X + 1 && !_BlockedByCar[i]; x++)
+			{
+				for (int32 y = cell.Y - 1; y <= cell.Y + 1 && !_BlockedByCar[i]; y++)
+				{
+					const TArray<int32>* cellCars = _ProximityGrid.Find(FIntPoint(x, y));
+					if (!cellCars)
+					{
+						continue;
+					}
+
+					for (int32 other : *cellCars)
+					{
+						if (_PathIndices[other] == _PathIndices[i])
+						{
+							continue;
+						}
+
+						if (!_IsInSafeArea(i, other))
+						{
+							continue;
+						}
+
+						// Both cars wait for each other, let the one with the lower priority value go first
+						if (_IsInSafeArea(other, i) && _Priorities[i] < _Priorities[other])
+						{
+							continue;
+						}
+
+						if (useCarFollowingModel)
+						{
+							float obstacleGap = _GetForwardDistance(i, other) - _HalfExtents[i].X - _HalfExtents[other].X;
+							if (obstacleGap < _Gaps[i])
+							{
+								_Gaps[i] = FMath::Max(obstacleGap, 0.0f);
+								_LeaderSpeeds[i] = 0.0f;
+							}
+							continue;
+						}
+
+						_BlockedByCar[i] = true;
+						break;
+					}
+				}
+			}
+		}, GetParallelForFlags(_IsParallelStep()));
+}
+
+/**
+ * Lowers the gap of every car to the nearest closed stop line ahead of it on its path.
+ * Stop lines the car's front already passed are ignored, so a car that entered on green is not stopped.
+ */
+void ATrafficManager::_UpdateStopLines()
+{
+	_RebakeStopLinesIfDirty();
+	_SnapshotZoneStopLines();
+
+	ParallelFor(_Cars.Num(), [this](int32 i)
+		{
+			float front = _Distances[i] + _HalfExtents[i].X;
+			for (const FTrafficStopLine& stopLine : _PathStopLines[_PathIndices[i]])
+			{
+				float gap = stopLine.Distance - front;
+				if (gap < 0.0f)
+				{
+					continue;
+				}
+
+				// The stop lines are sorted, the remaining ones are behind the current obstacle
+				if (gap >= _Gaps[i])
+				{
+					break;
+				}
+
+				if (_IsStopLineClosed(i, stopLine, gap))
+				{
+					_Gaps[i] = gap;
+					_LeaderSpeeds[i] = 0.0f;
+					break;
+				}
+			}
+		}, GetParallelForFlags(_IsParallelStep()));
+}
+
+/**
+ * Checks whether a stop line is closed for a car.
+ * Red lights are closed, orange lights only if the car can still stop comfortably before them,
+ * and critical zones if the snapshot of the step found them occupied by a path conflicting with the car's path.
+ *
+ * @param Index The traffic index of the car.
+ * @param StopLine The stop line ahead of the car.
+ * @param Gap The gap of the car's front to the stop line.
+ * @return True if the car has to stop at the stop line, false otherwise.
+ */
+bool ATrafficManager::_IsStopLineClosed(int32 Index, const FTrafficStopLine& StopLine, float Gap) const
+{
+	if (ATrafficLights* trafficLights = StopLine.TrafficLights)
+	{
+		if (trafficLights->IsRed())
+		{
+			return true;
+		}
+
+		float brakingDistance = FMath::Square(_Speeds[Index]) / (2.0f * FMath::Max(_ComfortableDecelerations[Index], KINDA_SMALL_NUMBER));
+		return trafficLights->IsOrange() && brakingDistance <= Gap;
+	}
+
+	if (StopLine.CriticalZone)
+	{
+		return StopLine.bIsZoneClosed;
+	}
+
+	return false;
+}
+
+/**
+ * Marks the baked stop lines as outdated, they are baked again before the next step reads them.
+ * The stop lines hold plain pointers to the traffic lights and zones, so they must not outlive those actors.
+ */
+void ATrafficManager::InvalidateStopLines()
+{
+	_AreStopLinesDirty = true;
+}
+
+/**
+ * Bakes the stop lines of every path again if traffic lights or critical zones changed since they were baked.
+ * Runs on the game thread before the parallel phase, the registry no longer lists actors that ended play.
+ */
+void ATrafficManager::_RebakeStopLinesIfDirty()
+{
+	if (!_AreStopLinesDirty)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < _Paths.Num(); i++)
+	{
+		_PathStopLines[i].Reset();
+		_BakeStopLines(_Paths[i], _PathStopLines[i]);
+	}
+	_AreStopLinesDirty = false;
+}
+
+/**
+ * Snapshots for every stop line of a critical zone whether its path may enter the zone.
+ * The occupancy of the zones only changes on the game thread, so the snapshot stays valid for the whole step
+ * and each pair of a path and a zone is evaluated once instead of once per car.
+ */
+void ATrafficManager::_SnapshotZoneStopLines()
+{
+	for (int32 i = 0; i < _Paths.Num(); i++)
+	{
+		for (FTrafficStopLine& stopLine : _PathStopLines[i])
+		{
+			stopLine.bIsZoneClosed = stopLine.CriticalZone && _Paths[i] && !stopLine.CriticalZone->CanPathEnter(_Paths[i]);
+		}
+	}
+}
+
+/**
+ * Gets the distance of a car ahead of another car along the other car's heading.
+ *
+ * @param Index The traffic index of the car whose heading is used.
+ * @param OtherIndex The traffic index of the other car.
+ * @return The distance of the other car's origin in front of the car's origin.
+ */
+float ATrafficManager::_GetForwardDistance(int32 Index, int32 OtherIndex) const
+{
+	return _Rotations[Index].UnrotateVector(_Locations[OtherIndex] - _Locations[Index]).X;
+}
+
+/**
+ * Checks whether a car lies in the safe area in front of another car.
+ * The safe area spans from the car's origin to the reach of its safe box, widened by the other car's body.
+ *
+ * @param Index The traffic index of the car whose safe area is tested.
+ * @param OtherIndex The traffic index of the other car.
+ * @return True if the other car is inside the safe area, false otherwise.
+ */
+bool ATrafficManager::_IsInSafeArea(int32 Index, int32 OtherIndex) const
+{
+	FVector local = _Rotations[Index].UnrotateVector(_Locations[OtherIndex] - _Locations[Index]);
+	return local.X > 0.0f
+		&& local.X < _SafeReaches[Index] + _HalfExtents[OtherIndex].X
+		&& FMath::Abs(local.Y) < _HalfExtents[Index].Y + _HalfExtents[OtherIndex].Y;
+}
+
+/**
+ * Gets the grid cell containing a world location.
+ *
+ * @param Location The world location.
+ * @return The coordinates of the grid cell.
+ */
+FIntPoint ATrafficManager::_GetCell(const FVector& Location) const
+{
+	float cellSize = FMath::Max(ProximityCellSize, 1.0f);
+	return FIntPoint(FMath::FloorToInt(Location.X / cellSize), FMath::FloorToInt(Location.Y / cellSize));
+}
+
+/**
+ * Advances the distance of all movable cars and computes their new transforms.
+ * With the car following model the speeds are first advanced by the vectorized kernel in chunks of cars.
+ * The cars are computed in parallel into per-car buffers, then the indices of the moved cars are collected in order.
+ *
+ * @param DeltaTime The time elapsed since the last frame.
+ */
+void ATrafficManager::_AdvanceCars(float DeltaTime)
+{
+	const int32 count = _Cars.Num();
+	_HasMoved.SetNumUninitialized(count);
+	_NewLocations.SetNumUninitialized(count);
+	_NewRotations.SetNumUninitialized(count);
+
+	if (IsCarFollowingModelActive())
+	{
+		_Advances.SetNumUninitialized(count);
+		FCarFollowingBatch batch = _GetCarFollowingBatch();
+		ParallelFor(FMath::DivideAndRoundUp(count, CarFollowingChunkSize), [&batch, count, DeltaTime](int32 chunk)
+			{
+				int32 start = chunk * CarFollowingChunkSize;
+				FCarFollowingModel::Step(batch, start, FMath::Min(CarFollowingChunkSize, count - start), DeltaTime);
+			}, GetParallelForFlags(_IsParallelStep()));
+	}
+
+	ParallelFor(count, [this, DeltaTime](int32 i)
+		{
+			_AdvanceCar(i, DeltaTime);
+		}, GetParallelForFlags(_IsParallelStep()));
+
+	_MovedIndices.Reset();
+	for (int32 i = 0; i < count; i++)
+	{
+		if (_HasMoved[i])
+		{
+			_MovedIndices.Add(i);
+		}
+	}
+}
+
+/**
+ * Computes the new distance and transform of a single car. Runs on a worker thread during a parallel step.
+ * Mirrors ACar::_MoveAlongSpline for a car with the CanMove flag that is not blocked by another car,
+ * reading the path lookup tables. The car travels the distance computed by the car following model,
+ * or at its desired speed without it. Only the state of the car itself is written.
+ *
+ * @param Index The traffic index of the car.
+ * @param DeltaTime The time elapsed since the last frame.
+ */
+void ATrafficManager::_AdvanceCar(int32 Index, float DeltaTime)
+{
+	_HasMoved[Index] = false;
+
+	if (!EnumHasAnyFlags(_Flags[Index], ETrafficCarFlags::CanMove)
+		|| EnumHasAnyFlags(_Flags[Index], ETrafficCarFlags::ReachedDestination | ETrafficCarFlags::BlockedByCar))
+	{
+		_Speeds[Index] = 0.0f;
+		return;
+	}
+
+	float advance;
+	if (IsCarFollowingModelActive())
+	{
+		advance = _Advances[Index];
+	}
+	else
+	{
+		_Speeds[Index] = _DesiredSpeeds[Index];
+		advance = _Speeds[Index] * DeltaTime;
+	}
+
+	if (advance <= 0.0f)
+	{
+		return;
+	}
+
+	ACarPath* path = _Paths[_PathIndices[Index]];
+	if (!path || !path->Path)
+	{
+		return;
+	}
+
+	float newDistance = _Distances[Index] + advance;
+	_Distances[Index] = newDistance;
+
+	FVector location;
+	FRotator rotation;
+	path->GetTransformAtDistance(newDistance, location, rotation);
+
+	_HasMoved[Index] = true;
+	_NewLocations[Index] = location + _Offsets[Index];
+	_NewRotations[Index] = rotation;
+	_Locations[Index] = _NewLocations[Index];
+	_Rotations[Index] = rotation.Quaternion();
+}
+
+/**
+ * Gets the per-car arrays read and written by the car following model.
+ *
+ * @return The batch pointing to the state arrays.
+ */
+FCarFollowingBatch ATrafficManager::_GetCarFollowingBatch()
+{
+	FCarFollowingBatch batch;
+	batch.Speeds = _Speeds.GetData();
+	batch.DesiredSpeeds = _DesiredSpeeds.GetData();
+	batch.MaxAccelerations = _MaxAccelerations.GetData();
+	batch.ComfortableDecelerations = _ComfortableDecelerations.GetData();
+	batch.MinimumGaps = _MinimumGaps.GetData();
+	batch.TimeHeadways = _TimeHeadways.GetData();
+	batch.Gaps = _Gaps.GetData();
+	batch.LeaderSpeeds = _LeaderSpeeds.GetData();
+	batch.Advances = _Advances.GetData();
+	return batch;
+}
+
+/**
+ * Pushes the transforms computed in _AdvanceCars back to the car actors.
+ * Location and rotation are applied in a single move per car, on the game thread.
+ * The instances of instanced cars are collected and sent to their instanced meshes in one update per mesh.
+ */
+void ATrafficManager::_CommitTransforms()
+{
+	for (int32 index : _MovedIndices)
+	{
+		ACar* car = _Cars[index];
+		if (!car)
+		{
+			continue;
+		}
+
+		car->SetActorLocationAndRotation(_NewLocations[index], _NewRotations[index]);
+
+		int32 batchIndex = _InstanceBatchIndices[index];
+		if (batchIndex != INDEX_NONE && car->CarMeshComponent)
+		{
+			FCarInstanceBatch& batch = _InstanceBatches[batchIndex];
+			batch.Transforms[_InstanceSlots[index]] = car->CarMeshComponent->GetComponentTransform();
+			batch.bIsDirty = true;
+		}
+	}
+
+	_FlushInstances();
+}
+
+/**
+ * Sends the instance transforms of all batches changed this step to their instanced meshes.
+ */
+void ATrafficManager::_FlushInstances()
+{
+	for (int32 i = 0; i < _InstanceBatches.Num(); i++)
+	{
+		FCarInstanceBatch& batch = _InstanceBatches[i];
+		if (!batch.bIsDirty || !_InstanceComponents[i])
+		{
+			continue;
+		}
+
+		_InstanceComponents[i]->BatchUpdateInstancesTransforms(0, batch.Transforms, true, true, true);
+		batch.bIsDirty = false;
+	}
+}
+
+/**
+ * Switches a managed car between being drawn by its actor and by an instanced mesh, depending on its significance.
+ * Cars no capture camera sees are drawn by the instanced mesh of their mesh and materials, with their own mesh hidden.
+ * The headlight of an instance is passed in the first custom data float, which the car material reads
+ * as PerInstanceCustomData in place of the emissive headlight parameter.
+ *
+ * @param Car The car to update.
+ */
+void ATrafficManager::UpdateCarInstance(ACar* Car)
+{
+	if (!Car)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UpdateCarInstance called with a null Car."));
+		return;
+	}
+
+	int32 index = Car->GetTrafficIndex();
+	if (!_Cars.IsValidIndex(index) || _Cars[index] != Car)
+	{
+		return;
+	}
+
+	bool isInstanced = bUseInstancedRendering && !Car->IsSignificant()
+		&& Car->CarMeshComponent && Car->CarMeshComponent->GetStaticMesh();
+	if (!isInstanced)
+	{
+		_ReleaseCarInstance(index);
+		return;
+	}
+
+	if (_InstanceBatchIndices[index] == INDEX_NONE)
+	{
+		int32 batchIndex = _FindOrAddInstanceBatch(Car);
+		if (batchIndex == INDEX_NONE)
+		{
+			return;
+		}
+
+		FCarInstanceBatch& batch = _InstanceBatches[batchIndex];
+		UInstancedStaticMeshComponent* component = _InstanceComponents[batchIndex];
+		FTransform transform = Car->CarMeshComponent->GetComponentTransform();
+
+		int32 slot;
+		if (batch.FreeSlots.Num() > 0)
+		{
+			slot = batch.FreeSlots.Pop(false);
+			batch.Transforms[slot] = transform;
+			component->UpdateInstanceTransform(slot, transform, true, true, true);
+		}
+		else
+		{
+			slot = component->AddInstance(transform, true);
+			batch.Transforms.Add(transform);
+		}
+
+		_InstanceBatchIndices[index] = batchIndex;
+		_InstanceSlots[index] = slot;
+		_InstancedCarsCount++;
+		Car->CarMeshComponent->SetVisibility(false);
+	}
+
+	UInstancedStaticMeshComponent* component = _InstanceComponents[_InstanceBatchIndices[index]];
+	component->SetCustomDataValue(_InstanceSlots[index], 0, Car->GetLightsOn() ? 1.0f : 0.0f, true);
+}
+
+/**
+ * Gets the batch of the instanced mesh matching a car's mesh and materials, creating it if there is none.
+ * Dynamic material instances are matched by their parent, the per-car parameters are not instanced.
+ *
+ * @param Car The car to draw.
+ * @return The index of the batch, or INDEX_NONE if it could not be created.
+ */
+int32 ATrafficManager::_FindOrAddInstanceBatch(ACar* Car)
+{
+	UStaticMeshComponent* meshComponent = Car->CarMeshComponent;
+	UStaticMesh* mesh = meshComponent->GetStaticMesh();
+
+	TArray<UMaterialInterface*> materials;
+	for (int32 i = 0; i < meshComponent->GetNumMaterials(); i++)
+	{
+		UMaterialInterface* material = meshComponent->GetMaterial(i);
+		if (UMaterialInstanceDynamic* dynamicMaterial = Cast<UMaterialInstanceDynamic>(material))
+		{
+			material = dynamicMaterial->Parent;
+		}
+		materials.Add(material);
+	}
+
+	for (int32 i = 0; i < _InstanceBatches.Num(); i++)
+	{
+		if (_InstanceBatches[i].Mesh == mesh && _InstanceBatches[i].Materials == materials)
+		{
+			return i;
+		}
+	}
+
+	UInstancedStaticMeshComponent* component = NewObject<UInstancedStaticMeshComponent>(this);
+	if (!component)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to create instanced mesh in _FindOrAddInstanceBatch."));
+		return INDEX_NONE;
+	}
+
+	// Instanced cars are the ones no capture camera sees, they are drawn like insignificant cars without shadows
+	component->SetMobility(EComponentMobility::Movable);
+	component->SetStaticMesh(mesh);
+	for (int32 i = 0; i < materials.Num(); i++)
+	{
+		component->SetMaterial(i, materials[i]);
+	}
+	component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	component->SetCastShadow(false);
+	component->SetNumCustomDataFloats(1);
+	component->RegisterComponent();
+	AddInstanceComponent(component);
+
+	_InstanceComponents.Add(component);
+	FCarInstanceBatch& batch = _InstanceBatches.AddDefaulted_GetRef();
+	batch.Mesh = mesh;
+	batch.Materials = MoveTemp(materials);
+	return _InstanceBatches.Num() - 1;
+}
+
+/**
+ * Hides the instance of a car and shows the car's own mesh again.
+ * The slot is hidden by a zero scale and kept for the next instanced car.
+ *
+ * @param Index The traffic index of the car.
+ */
+void ATrafficManager::_ReleaseCarInstance(int32 Index)
+{
+	int32 batchIndex = _InstanceBatchIndices[Index];
+	if (batchIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FCarInstanceBatch& batch = _InstanceBatches[batchIndex];
+	int32 slot = _InstanceSlots[Index];
+	batch.Transforms[slot] = FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	batch.FreeSlots.Add(slot);
+	if (_InstanceComponents[batchIndex])
+	{
+		_InstanceComponents[batchIndex]->UpdateInstanceTransform(slot, batch.Transforms[slot], true, true, true);
+	}
+
+	_InstanceBatchIndices[Index] = INDEX_NONE;
+	_InstanceSlots[Index] = INDEX_NONE;
+	_InstancedCarsCount--;
+
+	ACar* car = _Cars[Index];
+	if (car && car->CarMeshComponent)
+	{
+		car->CarMeshComponent->SetVisibility(true);
+	}
+}
+
+/**
+ * Handles cars that reached their destination.
+ * Cars are collected first because despawning changes the state arrays.
+ * Cars waiting for a critical zone are notified by the zone and need no handling here.
+ */
+void ATrafficManager::_HandleCarEvents()
+{
+	_FinishedCars.Reset();
+
+	for (int32 i = 0; i < _Cars.Num(); i++)
+	{
+		if (EnumHasAnyFlags(_Flags[i], ETrafficCarFlags::ReachedDestination))
+		{
+			_FinishedCars.Add(_Cars[i]);
+		}
+	}
+
+	for (ACar* car : _FinishedCars)
+	{
+		if (!car)
+		{
+			continue;
+		}
+
+		UnregisterCar(car);
+		car->Despawn();
+	}
+}
+
+/**
+ * Reports the number of managed cars and of cars that are stopped or waiting for traffic lights,
+ * a critical zone or another car to the stat group and the telemetry.
+ */
+void ATrafficManager::_ReportCounts()
+{
+	int32 waitingCount = 0;
+	for (int32 i = 0; i < _Cars.Num(); i++)
+	{
+		if (_Cars[i] && _Cars[i]->IsStopped())
+		{
+			waitingCount++;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_LiveCars, _Cars.Num());
+	SET_DWORD_STAT(STAT_WaitingCars, waitingCount);
+	SET_DWORD_STAT(STAT_InstancedCars, _InstancedCarsCount);
+
+	UWorld* world = GetWorld();
+	if (UTelemetrySubsystem* telemetry = world ? world->GetSubsystem<UTelemetrySubsystem>() : nullptr)
+	{
+		telemetry->SetTrafficCounts(_Cars.Num(), waitingCount);
+	}
+}
+
+/**
+ * Gets the index of a path in _Paths, adding the path if it is not known yet.
+ *
+ * @param Path The path to look up.
+ * @return The index of the path.
+ */
+int32 ATrafficManager::_GetPathIndex(ACarPath* Path)
+{
+	if (const int32* found = _PathIndexMap.Find(Path))
+	{
+		return *found;
+	}
+
+	int32 index = _Paths.Add(Path);
+	_PathIndexMap.Add(Path, index);
+	_BakeStopLines(Path, _PathStopLines.AddDefaulted_GetRef());
+	return index;
+}
+
+/**
+ * Bakes the stop lines of a path from the traffic lights and critical zones of the traffic registry.
+ * A stop line is placed where the path first enters the area of the traffic lights or the zone.
+ *
+ * @param Path The path to bake.
+ * @param OutStopLines The stop lines of the path, sorted by distance along the path.
+ */
+void ATrafficManager::_BakeStopLines(ACarPath* Path, TArray<FTrafficStopLine>& OutStopLines) const
+{
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!Path || !registry)
+	{
+		return;
+	}
+
+	for (ATrafficLights* trafficLights : registry->GetTrafficLights())
+	{
+		float distance;
+		if (trafficLights && Path->FindBoxEntryDistance(trafficLights->TrafficLightsEffectBox, distance))
+		{
+			FTrafficStopLine& stopLine = OutStopLines.AddDefaulted_GetRef();
+			stopLine.TrafficLights = trafficLights;
+			stopLine.Distance = distance;
+		}
+	}
+
+	for (ACriticalZone* criticalZone : registry->GetCriticalZones())
+	{
+		float distance;
+		if (criticalZone && Path->FindBoxEntryDistance(criticalZone->BoxComponent, distance))
+		{
+			FTrafficStopLine& stopLine = OutStopLines.AddDefaulted_GetRef();
+			stopLine.CriticalZone = criticalZone;
+			stopLine.Distance = distance;
+		}
+	}
+
+	OutStopLines.Sort([](const FTrafficStopLine& Left, const FTrafficStopLine& Right)
+		{
+			return Left.Distance < Right.Distance;
+		});
+}
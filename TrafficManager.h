@@ -0,0 +1,531 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TrafficManager.generated.h"
+
+class ACar;
+class ACarPath;
+class ACriticalZone;
+class ATrafficLights;
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+struct FCarFollowingBatch;
+
+/**
+ * Flags describing the per-frame state of a car managed by ATrafficManager.
+ * - CanMove: The car advances along its path.
+ * - ReachedDestination: The car entered a sink and has to be removed.
+ * - WaitingForCriticalZone: The car waits for a critical zone reservation.
+ * - BlockedByCar: The car keeps its distance to a car in front, independent of CanMove.
+ */
+enum class ETrafficCarFlags : uint8
+{
+	None = 0,
+	CanMove = 1 << 0,
+	ReachedDestination = 1 << 1,
+	WaitingForCriticalZone = 1 << 2,
+	BlockedByCar = 1 << 3
+};
+ENUM_CLASS_FLAGS(ETrafficCarFlags);
+
+/**
+ * FTrafficStopLine is the point where a path enters the area of traffic lights or a critical zone.
+ * A car following the path treats a closed stop line as a standing obstacle.
+ * The pointers are not tracked by the garbage collector, the stop lines are baked again whenever
+ * traffic lights or a critical zone register with or unregister from the traffic registry.
+ */
+struct FTrafficStopLine
+{
+	/** Traffic lights controlling the stop line, or nullptr. */
+	ATrafficLights* TrafficLights = nullptr;
+
+	/** Critical zone controlling the stop line, or nullptr. */
+	ACriticalZone* CriticalZone = nullptr;
+
+	/** Distance of the stop line along the path. */
+	float Distance = 0.0f;
+
+	/** Whether the critical zone is occupied by a path conflicting with the path of the stop line, snapshot at the start of the step. */
+	bool bIsZoneClosed = false;
+};
+
+/**
+ * FCarInstanceBatch holds the instances of all cars drawn with the same mesh and materials.
+ * Slots of cars that are drawn by their actor again are hidden and reused, so instance indices stay stable.
+ */
+struct FCarInstanceBatch
+{
+	/** Mesh of the cars in the batch. */
+	UStaticMesh* Mesh = nullptr;
+
+	/** Base materials of the cars in the batch. */
+	TArray<UMaterialInterface*> Materials;
+
+	/** World transform of each instance slot. */
+	TArray<FTransform> Transforms;
+
+	/** Instance slots not used by any car. */
+	TArray<int32> FreeSlots;
+
+	/** Whether Transforms changed since they were last sent to the instanced mesh. */
+	bool bIsDirty = false;
+};
+
+/**
+ * ATrafficManager advances all registered cars in a single pass.
+ * Car state is stored in contiguous arrays (structure of arrays) indexed by the car's traffic index,
+ * and the resulting transforms are pushed back to the car actors in one batch per frame.
+ * Each step has a compute phase that only reads and writes the state arrays and runs on worker threads,
+ * and a serial commit phase on the game thread that moves the actors and handles their events.
+ * Registered cars have their own tick disabled.
+ */
+UCLASS()
+class TSTOOLKIT_API ATrafficManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Default constructor for ATrafficManager.
+	 * Sets default values for this actor's properties.
+	 */
+	ATrafficManager();
+
+	/** Fixed simulation step in seconds, or zero to advance the cars by the frame time. */
+	UPROPERTY(EditAnywhere, Category = "Traffic Manager Details")
+	float FixedTimeStep = 0.0f;
+
+	/** Maximum number of fixed steps simulated in a single frame, the remaining time is dropped. */
+	UPROPERTY(EditAnywhere, Category = "Traffic Manager Details")
+	int MaxSubSteps = 8;
+
+	/** Whether car following is resolved by the manager's proximity index instead of safe box overlap events. */
+	UPROPERTY(EditAnywhere, Category = "Traffic Manager Details")
+	bool bUseProximityIndex = true;
+
+	/** Size of a cell of the grid used to find cars on other paths, in units. */
+	UPROPERTY(EditAnywhere, Category = "Traffic Manager Details")
+	float ProximityCellSize = 1000.0f;
+
+	/**
+	 * Whether cars accelerate and brake smoothly with the car following model instead of stopping instantly.
+	 * Red lights and critical zones reserved by other paths act as standing obstacles. Requires bUseProximityIndex.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Traffic Manager Details")
+	bool bUseCarFollowingModel = true;
+
+	/**
+	 * Whether cars no capture camera sees are drawn through one instanced mesh per car mesh instead of their own mesh.
+	 * The car actors keep driving the simulation. Takes effect with car significance enabled.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Traffic Manager Details")
+	bool bUseInstancedRendering = false;
+
+	/** Whether the car following and movement of the step are computed on worker threads. */
+	UPROPERTY(EditAnywhere, Category = "Traffic Manager Details")
+	bool bParallelUpdate = true;
+
+	/** Minimum number of managed cars for the step to run on worker threads, smaller steps run on the game thread. */
+	UPROPERTY(EditAnywhere, Category = "Traffic Manager Details")
+	int32 MinParallelCars = 64;
+
+private:
+	/** Frame time not yet consumed by fixed steps. */
+	float _TimeAccumulator = 0.0f;
+
+	/** Cars managed by this manager, indexed by traffic index. */
+	UPROPERTY()
+	TArray<ACar*> _Cars;
+
+	/** Distance travelled along the path spline for each car. */
+	TArray<float> _Distances;
+
+	/** Current speed of each car, in units per second. */
+	TArray<float> _Speeds;
+
+	/** Speed of each car on a free road, in units per second. */
+	TArray<float> _DesiredSpeeds;
+
+	/** Maximum acceleration of each car in the car following model. */
+	TArray<float> _MaxAccelerations;
+
+	/** Comfortable deceleration of each car in the car following model. */
+	TArray<float> _ComfortableDecelerations;
+
+	/** Gap each car keeps to a standing obstacle in the car following model. */
+	TArray<float> _MinimumGaps;
+
+	/** Time gap each car keeps to its leader in the car following model. */
+	TArray<float> _TimeHeadways;
+
+	/** Index into _Paths of the path each car follows. */
+	TArray<int32> _PathIndices;
+
+	/** Random lateral offset of each car from its path. */
+	TArray<FVector> _Offsets;
+
+	/** State flags of each car. */
+	TArray<ETrafficCarFlags> _Flags;
+
+	/** World location of each car at the start of the current step. */
+	TArray<FVector> _Locations;
+
+	/** World rotation of each car at the start of the current step. */
+	TArray<FQuat> _Rotations;
+
+	/** Reach of each car's safe distance box in front of the car's origin. */
+	TArray<float> _SafeReaches;
+
+	/** Half extent of each car's body box. */
+	TArray<FVector> _HalfExtents;
+
+	/** Movement priority of each car, the lower value wins when two cars block each other. */
+	TArray<int32> _Priorities;
+
+	/** Paths referenced by the managed cars. */
+	UPROPERTY()
+	TArray<ACarPath*> _Paths;
+
+	/** Lookup from a path to its index in _Paths. */
+	TMap<ACarPath*, int32> _PathIndexMap;
+
+	/** Stop lines of each path in _Paths, sorted by distance along the path. */
+	TArray<TArray<FTrafficStopLine>> _PathStopLines;
+
+	/** Indicates whether traffic lights or critical zones changed since the stop lines were baked. */
+	bool _AreStopLinesDirty = false;
+
+	/** Instanced mesh of each batch in _InstanceBatches. */
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> _InstanceComponents;
+
+	/** Instances of the cars drawn by instanced meshes, one batch per mesh and materials. */
+	TArray<FCarInstanceBatch> _InstanceBatches;
+
+	/** Index into _InstanceBatches of each car, INDEX_NONE while the car is drawn by its actor. */
+	TArray<int32> _InstanceBatchIndices;
+
+	/** Instance slot of each car in its batch, INDEX_NONE while the car is drawn by its actor. */
+	TArray<int32> _InstanceSlots;
+
+	/** Number of cars drawn by instanced meshes. */
+	int32 _InstancedCarsCount = 0;
+
+	// Per-frame scratch buffers, kept between frames to avoid reallocation
+	/** Indices of the cars that moved this frame. */
+	TArray<int32> _MovedIndices;
+
+	/** Whether each car moved this frame, written by the compute phase. */
+	TArray<bool> _HasMoved;
+
+	/** New location of each car that moved this frame, indexed by traffic index. */
+	TArray<FVector> _NewLocations;
+
+	/** New rotation of each car that moved this frame, indexed by traffic index. */
+	TArray<FRotator> _NewRotations;
+
+	/** Cars that reached their destination this frame. */
+	TArray<ACar*> _FinishedCars;
+
+	/** Indices of the cars on each path, sorted by distance along the path with the leading car first. */
+	TArray<TArray<int32>> _PathLanes;
+
+	/** Indices of the cars in each grid cell. */
+	TMap<FIntPoint, TArray<int32>> _ProximityGrid;
+
+	/** Whether each car is blocked by another car, evaluated from the snapshot at the start of the step. */
+	TArray<bool> _BlockedByCar;
+
+	/** Bumper to bumper gap of each car to its leader or nearest closed obstacle, used by the car following model. */
+	TArray<float> _Gaps;
+
+	/** Speed of each car's leader, zero for a standing obstacle. */
+	TArray<float> _LeaderSpeeds;
+
+	/** Distance each car travels this step, computed by the car following model. */
+	TArray<float> _Advances;
+
+	/** Forces the step onto the game thread regardless of bParallelUpdate, used by the benchmark. */
+	bool _IsSerialForced = false;
+
+protected:
+	/**
+	 * Called when the game starts or when the actor is spawned.
+	 * Used for initialization logic.
+	 */
+	virtual void BeginPlay() override;
+
+	/**
+	 * Called after the actor's components are initialized.
+	 * Registers the traffic manager with the traffic registry before any actor begins play.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the actor is being removed from the level.
+	 * Unregisters the traffic manager from the traffic registry.
+	 *
+	 * @param EndPlayReason The reason the actor is being removed.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	/**
+	 * Called every frame to advance all managed cars, in fixed steps if FixedTimeStep is set.
+	 *
+	 * @param DeltaTime The time elapsed since the last frame.
+	 */
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Registers a car with the manager and disables the car's own tick.
+	 * The car's path, speed, offset and distance along spline are copied into the manager.
+	 *
+	 * @param Car The car to register.
+	 */
+	void RegisterCar(ACar* Car);
+
+	/**
+	 * Unregisters a car from the manager and re-enables the car's own tick.
+	 *
+	 * @param Car The car to unregister.
+	 */
+	void UnregisterCar(ACar* Car);
+
+	/**
+	 * Sets or clears a state flag of a managed car.
+	 *
+	 * @param Index The traffic index of the car.
+	 * @param Flag The flag to update.
+	 * @param bValue True to set the flag, false to clear it.
+	 */
+	void SetCarFlag(int32 Index, ETrafficCarFlags Flag, bool bValue);
+
+	/**
+	 * Gets the distance a managed car has travelled along its path.
+	 *
+	 * @param Index The traffic index of the car.
+	 * @return The distance along the path spline.
+	 */
+	float GetCarDistance(int32 Index) const;
+
+	/**
+	 * Gets the current speed of a managed car, zero while the car is stopped.
+	 *
+	 * @param Index The traffic index of the car.
+	 * @return The speed of the car, in units per second.
+	 */
+	float GetCarSpeed(int32 Index) const;
+
+	/**
+	 * Marks the baked stop lines as outdated, they are baked again before the next step reads them.
+	 * Called by the traffic registry whenever traffic lights or a critical zone register or unregister.
+	 */
+	void InvalidateStopLines();
+
+	/**
+	 * Switches a managed car between being drawn by its actor and by an instanced mesh,
+	 * depending on its significance, and updates the headlight of its instance.
+	 *
+	 * @param Car The car to update.
+	 */
+	void UpdateCarInstance(ACar* Car);
+
+	/**
+	 * Checks whether the cars move with the car following model.
+	 * Managed cars then brake for red lights and reserved zones at the stop lines instead of stopping on overlap.
+	 *
+	 * @return True if the car following model is used, false if cars stop instantly.
+	 */
+	bool IsCarFollowingModelActive() const;
+
+	/**
+	 * Gets the number of cars managed by this manager.
+	 *
+	 * @return The number of managed cars.
+	 */
+	FORCEINLINE int32 GetCarsCount() const
+	{
+		return _Cars.Num();
+	}
+
+	/**
+	 * Gets the cars managed by this manager, indexed by traffic index.
+	 *
+	 * @return The managed cars.
+	 */
+	FORCEINLINE const TArray<ACar*>& GetCars() const
+	{
+		return _Cars;
+	}
+
+	/**
+	 * Measures the compute phase of the step, the car following and movement, without moving the car actors.
+	 * The state of the cars is restored afterwards, so the simulation is not affected.
+	 *
+	 * @param Steps The number of steps to run.
+	 * @param DeltaTime The simulated time of each step.
+	 * @param bParallel True to run the steps on worker threads, false to run them on the game thread.
+	 * @return The average time of a step, in seconds.
+	 */
+	double BenchmarkSteps(int32 Steps, float DeltaTime, bool bParallel);
+
+private:
+	/**
+	 * Runs a single simulation step over all managed cars.
+	 *
+	 * @param DeltaTime The simulated time of the step.
+	 */
+	void _Step(float DeltaTime);
+
+	/**
+	 * Checks whether the compute phase of the step runs on worker threads.
+	 *
+	 * @return True if the step is parallel, false if it runs on the game thread.
+	 */
+	bool _IsParallelStep() const;
+
+	/**
+	 * Updates the BlockedByCar flag of all cars from the positions at the start of the step.
+	 */
+	void _UpdateProximity();
+
+	/**
+	 * Rebuilds the per-path lanes and marks every car that is too close to its leader on the same path.
+	 */
+	void _UpdateLanes();
+
+	/**
+	 * Rebuilds the grid and marks every car whose safe area contains a car on another path.
+	 */
+	void _UpdateOtherPaths();
+
+	/**
+	 * Lowers the gap of every car to the nearest closed stop line ahead of it on its path.
+	 */
+	void _UpdateStopLines();
+
+	/**
+	 * Snapshots for every stop line of a critical zone whether its path may enter the zone.
+	 * Runs on the game thread, so the parallel phase never reads the zones themselves.
+	 */
+	void _SnapshotZoneStopLines();
+
+	/**
+	 * Bakes the stop lines of every path again if traffic lights or critical zones changed since they were baked.
+	 */
+	void _RebakeStopLinesIfDirty();
+
+	/**
+	 * Checks whether a stop line is closed for a car.
+	 *
+	 * @param Index The traffic index of the car.
+	 * @param StopLine The stop line ahead of the car.
+	 * @param Gap The gap of the car's front to the stop line.
+	 * @return True if the car has to stop at the stop line, false otherwise.
+	 */
+	bool _IsStopLineClosed(int32 Index, const FTrafficStopLine& StopLine, float Gap) const;
+
+	/**
+	 * Gets the distance of a car ahead of another car along the other car's heading.
+	 *
+	 * @param Index The traffic index of the car whose heading is used.
+	 * @param OtherIndex The traffic index of the other car.
+	 * @return The distance of the other car's origin in front of the car's origin.
+	 */
+	float _GetForwardDistance(int32 Index, int32 OtherIndex) const;
+
+	/**
+	 * Checks whether a car lies in the safe area in front of another car.
+	 *
+	 * @param Index The traffic index of the car whose safe area is tested.
+	 * @param OtherIndex The traffic index of the other car.
+	 * @return True if the other car is inside the safe area, false otherwise.
+	 */
+	bool _IsInSafeArea(int32 Index, int32 OtherIndex) const;
+
+	/**
+	 * Gets the grid cell containing a world location.
+	 *
+	 * @param Location The world location.
+	 * @return The coordinates of the grid cell.
+	 */
+	FIntPoint _GetCell(const FVector& Location) const;
+
+	/**
+	 * Advances the distance of all movable cars and computes their new transforms.
+	 *
+	 * @param DeltaTime The time elapsed since the last frame.
+	 */
+	void _AdvanceCars(float DeltaTime);
+
+	/**
+	 * Gets the per-car arrays read and written by the car following model.
+	 *
+	 * @return The batch pointing to the state arrays.
+	 */
+	FCarFollowingBatch _GetCarFollowingBatch();
+
+	/**
+	 * Computes the new distance and transform of a single car. Runs on a worker thread during a parallel step.
+	 *
+	 * @param Index The traffic index of the car.
+	 * @param DeltaTime The time elapsed since the last frame.
+	 */
+	void _AdvanceCar(int32 Index, float DeltaTime);
+
+	/**
+	 * Pushes the transforms computed in _AdvanceCars back to the car actors.
+	 */
+	void _CommitTransforms();
+
+	/**
+	 * Sends the instance transforms of all batches changed this step to their instanced meshes.
+	 */
+	void _FlushInstances();
+
+	/**
+	 * Gets the batch of the instanced mesh matching a car's mesh and materials, creating it if there is none.
+	 *
+	 * @param Car The car to draw.
+	 * @return The index of the batch, or INDEX_NONE if it could not be created.
+	 */
+	int32 _FindOrAddInstanceBatch(ACar* Car);
+
+	/**
+	 * Hides the instance of a car and shows the car's own mesh again.
+	 *
+	 * @param Index The traffic index of the car.
+	 */
+	void _ReleaseCarInstance(int32 Index);
+
+	/**
+	 * Handles cars that reached their destination.
+	 */
+	void _HandleCarEvents();
+
+	/**
+	 * Reports the number of managed and waiting cars to the stat group and the telemetry.
+	 */
+	void _ReportCounts();
+
+	/**
+	 * Gets the index of a path in _Paths, adding the path if it is not known yet.
+	 *
+	 * @param Path The path to look up.
+	 * @return The index of the path.
+	 */
+	int32 _GetPathIndex(ACarPath* Path);
+
+	/**
+	 * Bakes the stop lines of a path from the traffic lights and critical zones of the traffic registry.
+	 *
+	 * @param Path The path to bake.
+	 * @param OutStopLines The stop lines of the path, sorted by distance along the path.
+	 */
+	void _BakeStopLines(ACarPath* Path, TArray<FTrafficStopLine>& OutStopLines) const;
+};
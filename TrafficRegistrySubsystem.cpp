@@ -0,0 +1,428 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrafficRegistrySubsystem.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "TimerManager.h"
+#include "Lamp.h"
+#include "Puddle.h"
+#include "Camera.h"
+#include "CarPath.h"
+#include "CarSource.h"
+#include "CarSpawnController.h"
+#include "CriticalZone.h"
+#include "TrafficLightsGroup.h"
+#include "TrafficLights.h"
+#include "TrafficManager.h"
+
+/**
+ * Adds an actor to a registry list, ignoring null and already registered actors.
+ *
+ * @param List The list to add the actor to.
+ * @param Actor The actor to add.
+ */
+template<typename T>
+static void RegisterInList(TArray<T*>& List, T* Actor)
+{
+	if (!Actor)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UTrafficRegistrySubsystem: Tried to register a null actor."));
+		return;
+	}
+
+	List.AddUnique(Actor);
+}
+
+/**
+ * Removes an actor from a registry list, keeping the registration order of the remaining actors.
+ *
+ * @param List The list to remove the actor from.
+ * @param Actor The actor to remove.
+ */
+template<typename T>
+static void UnregisterFromList(TArray<T*>& List, T* Actor)
+{
+	List.Remove(Actor);
+}
+
+/**
+ * Fills a registry list with all actors of its type in a world.
+ *
+ * @param World The world to scan.
+ * @param List The list to fill.
+ */
+template<typename T>
+static void FillListFromWorld(UWorld* World, TArray<T*>& List)
+{
+	List.Reset();
+	for (TActorIterator<T> it(World); it; ++it)
+	{
+		List.Add(*it);
+	}
+}
+
+/**
+ * Rebuilds all lists from the actors currently in the world.
+ * Used in editor worlds, where actors do not register themselves.
+ */
+void UTrafficRegistrySubsystem::RefreshFromWorld()
+{
+	UWorld* world = GetWorld();
+	if (!world)
+	{
+		UE_LOG(LogTemp, Error, TEXT("World is null in RefreshFromWorld."));
+		return;
+	}
+
+	FillListFromWorld(world, _Lamps);
+	FillListFromWorld(world, _Puddles);
+	FillListFromWorld(world, _Cameras);
+	FillListFromWorld(world, _CarSources);
+	FillListFromWorld(world, _CarSpawnControllers);
+	FillListFromWorld(world, _CriticalZones);
+	FillListFromWorld(world, _TrafficLightsGroups);
+	FillListFromWorld(world, _TrafficLights);
+	FillListFromWorld(world, _TrafficManagers);
+	FillListFromWorld(world, _CarPaths);
+}
+
+/**
+ * Registers a lamp.
+ *
+ * @param Lamp The lamp to register.
+ */
+void UTrafficRegistrySubsystem::RegisterLamp(ALamp* Lamp)
+{
+	RegisterInList(_Lamps, Lamp);
+}
+
+/**
+ * Unregisters a lamp.
+ *
+ * @param Lamp The lamp to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterLamp(ALamp* Lamp)
+{
+	UnregisterFromList(_Lamps, Lamp);
+}
+
+/**
+ * Registers a puddle.
+ *
+ * @param Puddle The puddle to register.
+ */
+void UTrafficRegistrySubsystem::RegisterPuddle(APuddle* Puddle)
+{
+	RegisterInList(_Puddles, Puddle);
+}
+
+/**
+ * Unregisters a puddle.
+ *
+ * @param Puddle The puddle to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterPuddle(APuddle* Puddle)
+{
+	UnregisterFromList(_Puddles, Puddle);
+}
+
+/**
+ * Registers a camera.
+ *
+ * @param Camera The camera to register.
+ */
+void UTrafficRegistrySubsystem::RegisterCamera(ACamera* Camera)
+{
+	RegisterInList(_Cameras, Camera);
+}
+
+/**
+ * Unregisters a camera.
+ *
+ * @param Camera The camera to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterCamera(ACamera* Camera)
+{
+	UnregisterFromList(_Cameras, Camera);
+}
+
+/**
+ * Registers a car source.
+ *
+ * @param Source The car source to register.
+ */
+void UTrafficRegistrySubsystem::RegisterCarSource(ACarSource* Source)
+{
+	RegisterInList(_CarSources, Source);
+}
+
+/**
+ * Unregisters a car source.
+ *
+ * @param Source The car source to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterCarSource(ACarSource* Source)
+{
+	UnregisterFromList(_CarSources, Source);
+}
+
+/**
+ * Registers a car spawn controller.
+ *
+ * @param Controller The car spawn controller to register.
+ */
+void UTrafficRegistrySubsystem::RegisterCarSpawnController(ACarSpawnController* Controller)
+{
+	RegisterInList(_CarSpawnControllers, Controller);
+}
+
+/**
+ * Unregisters a car spawn controller.
+ *
+ * @param Controller The car spawn controller to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterCarSpawnController(ACarSpawnController* Controller)
+{
+	UnregisterFromList(_CarSpawnControllers, Controller);
+}
+
+/**
+ * Registers a critical zone.
+ *
+ * @param Zone The critical zone to register.
+ */
+void UTrafficRegistrySubsystem::RegisterCriticalZone(ACriticalZone* Zone)
+{
+	RegisterInList(_CriticalZones, Zone);
+	_InvalidateStopLines();
+}
+
+/**
+ * Unregisters a critical zone.
+ *
+ * @param Zone The critical zone to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterCriticalZone(ACriticalZone* Zone)
+{
+	UnregisterFromList(_CriticalZones, Zone);
+	_InvalidateStopLines();
+}
+
+/**
+ * Registers a traffic light group.
+ *
+ * @param Group The traffic light group to register.
+ */
+void UTrafficRegistrySubsystem::RegisterTrafficLightsGroup(ATrafficLightsGroup* Group)
+{
+	RegisterInList(_TrafficLightsGroups, Group);
+}
+
+/**
+ * Unregisters a traffic light group.
+ *
+ * @param Group The traffic light group to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterTrafficLightsGroup(ATrafficLightsGroup* Group)
+{
+	UnregisterFromList(_TrafficLightsGroups, Group);
+}
+
+/**
+ * Registers traffic lights.
+ *
+ * @param TrafficLights The traffic lights to register.
+ */
+void UTrafficRegistrySubsystem::RegisterTrafficLights(ATrafficLights* TrafficLights)
+{
+	RegisterInList(_TrafficLights, TrafficLights);
+	_InvalidateStopLines();
+}
+
+/**
+ * Unregisters traffic lights.
+ *
+ * @param TrafficLights The traffic lights to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterTrafficLights(ATrafficLights* TrafficLights)
+{
+	UnregisterFromList(_TrafficLights, TrafficLights);
+	_InvalidateStopLines();
+}
+
+/**
+ * Registers a traffic manager.
+ *
+ * @param Manager The traffic manager to register.
+ */
+void UTrafficRegistrySubsystem::RegisterTrafficManager(ATrafficManager* Manager)
+{
+	RegisterInList(_TrafficManagers, Manager);
+}
+
+/**
+ * Unregisters a traffic manager.
+ *
+ * @param Manager The traffic manager to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterTrafficManager(ATrafficManager* Manager)
+{
+	UnregisterFromList(_TrafficManagers, Manager);
+}
+
+/**
+ * Registers a car path. Paths added after the network was compiled mark it dirty.
+ *
+ * @param Path The car path to register.
+ */
+void UTrafficRegistrySubsystem::RegisterCarPath(ACarPath* Path)
+{
+	RegisterInList(_CarPaths, Path);
+	MarkPathNetworkDirty();
+}
+
+/**
+ * Unregisters a car path. The network is marked dirty, so the relation indices of the remaining paths become dense again.
+ *
+ * @param Path The car path to unregister.
+ */
+void UTrafficRegistrySubsystem::UnregisterCarPath(ACarPath* Path)
+{
+	UnregisterFromList(_CarPaths, Path);
+
+	if (Path)
+	{
+		Path->SetCompiledRelations(INDEX_NONE, TBitArray<>());
+	}
+
+	MarkPathNetworkDirty();
+}
+
+/**
+ * Schedules a compilation of the path network for the next tick, so that several changes compile once.
+ * Does nothing before the network was first compiled or while the world is tearing down,
+ * when every path unregisters and the network is not used anymore.
+ */
+void UTrafficRegistrySubsystem::MarkPathNetworkDirty()
+{
+	UWorld* world = GetWorld();
+	if (!_IsPathNetworkCompiled || _IsPathNetworkDirty || !world || world->bIsTearingDown)
+	{
+		return;
+	}
+
+	_IsPathNetworkDirty = true;
+	world->GetTimerManager().SetTimerForNextTick(this, &UTrafficRegistrySubsystem::_CompileDirtyPathNetwork);
+}
+
+/**
+ * Tells the traffic managers that the traffic lights or critical zones changed, so they bake their stop lines again.
+ * The stop lines point to the traffic lights and zones, and must not keep pointing to actors that ended play.
+ */
+void UTrafficRegistrySubsystem::_InvalidateStopLines()
+{
+	for (ATrafficManager* manager : _TrafficManagers)
+	{
+		if (manager)
+		{
+			manager->InvalidateStopLines();
+		}
+	}
+}
+
+/**
+ * Compiles the path network if it was marked dirty since the last compilation.
+ */
+void UTrafficRegistrySubsystem::_CompileDirtyPathNetwork()
+{
+	if (_IsPathNetworkDirty)
+	{
+		CompilePathRelations();
+	}
+}
+
+/**
+ * Compiles the registered car paths into a network with dense path indices and a symmetric relation matrix.
+ * Every path gets its index in the list of registered paths and one row of the matrix, with a bit set for
+ * each related path. A relation listed by either path relates both, self-references and unregistered paths are ignored.
+ * The RelatedPaths arrays of the paths are only read. The critical zones recount their conflicts afterwards.
+ */
+void UTrafficRegistrySubsystem::CompilePathRelations()
+{
+	_CarPaths.RemoveAll([](const ACarPath* Path)
+		{
+			return !Path;
+		});
+
+	const int32 pathsCount = _CarPaths.Num();
+	TMap<const ACarPath*, int32> pathIndices;
+	pathIndices.Reserve(pathsCount);
+	for (int32 i = 0; i < pathsCount; i++)
+	{
+		pathIndices.Add(_CarPaths[i], i);
+	}
+
+	TArray<TBitArray<>> rows;
+	rows.Reserve(pathsCount);
+	for (int32 i = 0; i < pathsCount; i++)
+	{
+		rows.Emplace(false, pathsCount);
+	}
+
+	for (int32 i = 0; i < pathsCount; i++)
+	{
+		for (const ACarPath* relatedPath : _CarPaths[i]->RelatedPaths)
+		{
+			const int32* relatedIndex = pathIndices.Find(relatedPath);
+			if (!relatedIndex || *relatedIndex == i)
+			{
+				continue;
+			}
+
+			rows[i][*relatedIndex] = true;
+			rows[*relatedIndex][i] = true;
+		}
+	}
+
+	for (int32 i = 0; i < pathsCount; i++)
+	{
+		_CarPaths[i]->SetCompiledRelations(i, rows[i]);
+	}
+
+	// Relation indices may have moved, the zones recount the conflicts of their occupying paths
+	for (ACriticalZone* criticalZone : _CriticalZones)
+	{
+		if (criticalZone)
+		{
+			criticalZone->RebuildPathConflicts(pathsCount);
+		}
+	}
+
+	_IsPathNetworkCompiled = true;
+	_IsPathNetworkDirty = false;
+	UE_LOG(LogTemp, Log, TEXT("CompilePathRelations: Compiled %d car paths."), pathsCount);
+}
+
+/**
+ * Called when the world begins play, before any actor begins play. Compiles the path network.
+ *
+ * @param InWorld The world beginning play.
+ */
+void UTrafficRegistrySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	CompilePathRelations();
+}
+
+/**
+ * Gets the registry of the world an actor belongs to.
+ *
+ * @param WorldContext An object in the world.
+ * @return The registry, or nullptr if the object has no world.
+ */
+UTrafficRegistrySubsystem* UTrafficRegistrySubsystem::Get(const UObject* WorldContext)
+{
+	UWorld* world = WorldContext ? WorldContext->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UTrafficRegistrySubsystem>() : nullptr;
+}
@@ -0,0 +1,361 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TrafficRegistrySubsystem.generated.h"
+
+class ALamp;
+class APuddle;
+class ACamera;
+class ACarPath;
+class ACarSource;
+class ACarSpawnController;
+class ACriticalZone;
+class ATrafficLightsGroup;
+class ATrafficLights;
+class ATrafficManager;
+
+/**
+ * UTrafficRegistrySubsystem keeps typed lists of the simulation actors of a world.
+ * Actors register themselves once their components are initialized and unregister when they leave play,
+ * so controllers iterate the cached lists instead of scanning the whole world with GetAllActorsOfClass.
+ * The registered car paths are compiled into a network with dense path indices and a bitset relation matrix
+ * when the world begins play, so relation checks between paths take constant time.
+ */
+UCLASS()
+class TSTOOLKIT_API UTrafficRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+private:
+	/** Registered lamps. */
+	UPROPERTY()
+	TArray<ALamp*> _Lamps;
+
+	/** Registered puddles. */
+	UPROPERTY()
+	TArray<APuddle*> _Puddles;
+
+	/** Registered cameras. */
+	UPROPERTY()
+	TArray<ACamera*> _Cameras;
+
+	/** Registered car sources. */
+	UPROPERTY()
+	TArray<ACarSource*> _CarSources;
+
+	/** Registered car spawn controllers. */
+	UPROPERTY()
+	TArray<ACarSpawnController*> _CarSpawnControllers;
+
+	/** Registered critical zones. */
+	UPROPERTY()
+	TArray<ACriticalZone*> _CriticalZones;
+
+	/** Registered traffic light groups. */
+	UPROPERTY()
+	TArray<ATrafficLightsGroup*> _TrafficLightsGroups;
+
+	/** Registered traffic lights, grouped or standalone. */
+	UPROPERTY()
+	TArray<ATrafficLights*> _TrafficLights;
+
+	/** Registered traffic managers. */
+	UPROPERTY()
+	TArray<ATrafficManager*> _TrafficManagers;
+
+	/** Registered car paths, the index of a path is its relation index once the network is compiled. */
+	UPROPERTY()
+	TArray<ACarPath*> _CarPaths;
+
+	/** Indicates whether the path network was compiled, later changes of the paths recompile it. */
+	bool _IsPathNetworkCompiled = false;
+
+	/** Indicates whether the paths changed since the last compilation and a compilation is scheduled. */
+	bool _IsPathNetworkDirty = false;
+
+	/**
+	 * Compiles the path network if it was marked dirty since the last compilation.
+	 */
+	void _CompileDirtyPathNetwork();
+
+	/**
+	 * Tells the traffic managers that the traffic lights or critical zones changed, so they bake their stop lines again.
+	 */
+	void _InvalidateStopLines();
+
+public:
+	/**
+	 * Rebuilds all lists from the actors currently in the world.
+	 * Used in editor worlds, where actors do not register themselves.
+	 */
+	void RefreshFromWorld();
+
+	/**
+	 * Registers a lamp.
+	 *
+	 * @param Lamp The lamp to register.
+	 */
+	void RegisterLamp(ALamp* Lamp);
+
+	/**
+	 * Unregisters a lamp.
+	 *
+	 * @param Lamp The lamp to unregister.
+	 */
+	void UnregisterLamp(ALamp* Lamp);
+
+	/**
+	 * Registers a puddle.
+	 *
+	 * @param Puddle The puddle to register.
+	 */
+	void RegisterPuddle(APuddle* Puddle);
+
+	/**
+	 * Unregisters a puddle.
+	 *
+	 * @param Puddle The puddle to unregister.
+	 */
+	void UnregisterPuddle(APuddle* Puddle);
+
+	/**
+	 * Registers a camera.
+	 *
+	 * @param Camera The camera to register.
+	 */
+	void RegisterCamera(ACamera* Camera);
+
+	/**
+	 * Unregisters a camera.
+	 *
+	 * @param Camera The camera to unregister.
+	 */
+	void UnregisterCamera(ACamera* Camera);
+
+	/**
+	 * Registers a car source.
+	 *
+	 * @param Source The car source to register.
+	 */
+	void RegisterCarSource(ACarSource* Source);
+
+	/**
+	 * Unregisters a car source.
+	 *
+	 * @param Source The car source to unregister.
+	 */
+	void UnregisterCarSource(ACarSource* Source);
+
+	/**
+	 * Registers a car spawn controller.
+	 *
+	 * @param Controller The car spawn controller to register.
+	 */
+	void RegisterCarSpawnController(ACarSpawnController* Controller);
+
+	/**
+	 * Unregisters a car spawn controller.
+	 *
+	 * @param Controller The car spawn controller to unregister.
+	 */
+	void UnregisterCarSpawnController(ACarSpawnController* Controller);
+
+	/**
+	 * Registers a critical zone.
+	 *
+	 * @param Zone The critical zone to register.
+	 */
+	void RegisterCriticalZone(ACriticalZone* Zone);
+
+	/**
+	 * Unregisters a critical zone.
+	 *
+	 * @param Zone The critical zone to unregister.
+	 */
+	void UnregisterCriticalZone(ACriticalZone* Zone);
+
+	/**
+	 * Registers a traffic light group.
+	 *
+	 * @param Group The traffic light group to register.
+	 */
+	void RegisterTrafficLightsGroup(ATrafficLightsGroup* Group);
+
+	/**
+	 * Unregisters a traffic light group.
+	 *
+	 * @param Group The traffic light group to unregister.
+	 */
+	void UnregisterTrafficLightsGroup(ATrafficLightsGroup* Group);
+
+	/**
+	 * Registers traffic lights.
+	 *
+	 * @param TrafficLights The traffic lights to register.
+	 */
+	void RegisterTrafficLights(ATrafficLights* TrafficLights);
+
+	/**
+	 * Unregisters traffic lights.
+	 *
+	 * @param TrafficLights The traffic lights to unregister.
+	 */
+	void UnregisterTrafficLights(ATrafficLights* TrafficLights);
+
+	/**
+	 * Registers a traffic manager.
+	 *
+	 * @param Manager The traffic manager to register.
+	 */
+	void RegisterTrafficManager(ATrafficManager* Manager);
+
+	/**
+	 * Unregisters a traffic manager.
+	 *
+	 * @param Manager The traffic manager to unregister.
+	 */
+	void UnregisterTrafficManager(ATrafficManager* Manager);
+
+	/**
+	 * Registers a car path.
+	 *
+	 * @param Path The car path to register.
+	 */
+	void RegisterCarPath(ACarPath* Path);
+
+	/**
+	 * Unregisters a car path.
+	 *
+	 * @param Path The car path to unregister.
+	 */
+	void UnregisterCarPath(ACarPath* Path);
+
+	/**
+	 * Compiles the registered car paths into a network with dense path indices and a symmetric relation matrix.
+	 */
+	void CompilePathRelations();
+
+	/**
+	 * Schedules a compilation of the path network for the next tick, so that several changes compile once.
+	 * Does nothing before the network was first compiled or while the world is tearing down.
+	 */
+	void MarkPathNetworkDirty();
+
+	/**
+	 * Called when the world begins play, before any actor begins play. Compiles the path network.
+	 *
+	 * @param InWorld The world beginning play.
+	 */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/**
+	 * Gets the registered lamps.
+	 *
+	 * @return The registered lamps.
+	 */
+	FORCEINLINE const TArray<ALamp*>& GetLamps() const
+	{
+		return _Lamps;
+	}
+
+	/**
+	 * Gets the registered puddles.
+	 *
+	 * @return The registered puddles.
+	 */
+	FORCEINLINE const TArray<APuddle*>& GetPuddles() const
+	{
+		return _Puddles;
+	}
+
+	/**
+	 * Gets the registered cameras.
+	 *
+	 * @return The registered cameras.
+	 */
+	FORCEINLINE const TArray<ACamera*>& GetCameras() const
+	{
+		return _Cameras;
+	}
+
+	/**
+	 * Gets the registered car sources.
+	 *
+	 * @return The registered car sources.
+	 */
+	FORCEINLINE const TArray<ACarSource*>& GetCarSources() const
+	{
+		return _CarSources;
+	}
+
+	/**
+	 * Gets the registered car spawn controllers.
+	 *
+	 * @return The registered car spawn controllers.
+	 */
+	FORCEINLINE const TArray<ACarSpawnController*>& GetCarSpawnControllers() const
+	{
+		return _CarSpawnControllers;
+	}
+
+	/**
+	 * Gets the registered critical zones.
+	 *
+	 * @return The registered critical zones.
+	 */
+	FORCEINLINE const TArray<ACriticalZone*>& GetCriticalZones() const
+	{
+		return _CriticalZones;
+	}
+
+	/**
+	 * Gets the registered traffic light groups.
+	 *
+	 * @return The registered traffic light groups.
+	 */
+	FORCEINLINE const TArray<ATrafficLightsGroup*>& GetTrafficLightsGroups() const
+	{
+		return _TrafficLightsGroups;
+	}
+
+	/**
+	 * Gets the registered traffic lights.
+	 *
+	 * @return The registered traffic lights.
+	 */
+	FORCEINLINE const TArray<ATrafficLights*>& GetTrafficLights() const
+	{
+		return _TrafficLights;
+	}
+
+	/**
+	 * Gets the traffic manager of the world.
+	 *
+	 * @return The first registered traffic manager, or nullptr if the world has none.
+	 */
+	FORCEINLINE ATrafficManager* GetTrafficManager() const
+	{
+		return _TrafficManagers.Num() > 0 ? _TrafficManagers[0] : nullptr;
+	}
+
+	/**
+	 * Gets the registered car paths.
+	 *
+	 * @return The registered car paths.
+	 */
+	FORCEINLINE const TArray<ACarPath*>& GetCarPaths() const
+	{
+		return _CarPaths;
+	}
+
+	/**
+	 * Gets the registry of the world an actor belongs to.
+	 *
+	 * @param WorldContext An object in the world.
+	 * @return The registry, or nullptr if the object has no world.
+	 */
+	static UTrafficRegistrySubsystem* Get(const UObject* WorldContext);
+};
@@ -5,15 +5,52 @@
 #include "Components/DirectionalLightComponent.h"
 #include "Components/VolumetricCloudComponent.h"
 #include "Components/SkyAtmosphereComponent.h"
-#include "Kismet/GameplayStatics.h"
 #include "Engine/World.h"
 #include "Lamp.h"
 #include "Puddle.h"
 #include "CarSpawnController.h"
+#include "Car.h"
+#include "TrafficManager.h"
 #include "NiagaraFunctionLibrary.h"
 #include "NiagaraComponent.h"
+#include "TelemetrySubsystem.h"
+#include "TrafficRegistrySubsystem.h"
+#include "TSToolkit.h"
 
-typedef UGameplayStatics GS;
+DECLARE_CYCLE_STAT(TEXT("Weather Change"), STAT_WeatherChange, STATGROUP_TSToolkit);
+
+/**
+ * Converts a day time type to an amount of daylight.
+ *
+ * @param type The day time type.
+ * @return 1 for day, 0 for night.
+ */
+static float DayTimeToDaylight(EDayTimeTypes type)
+{
+	return (type == EDayTimeTypes::Night) ? 0.0f : 1.0f;
+}
+
+/**
+ * Converts an overcast type to a cloudiness.
+ *
+ * @param type The overcast type.
+ * @return 1 for overcast, 0 for clear.
+ */
+static float OvercastToCloudiness(EOvercastTypes type)
+{
+	return (type == EOvercastTypes::Overcast) ? 1.0f : 0.0f;
+}
+
+/**
+ * Converts a rain type to a rain intensity.
+ *
+ * @param type The rain type.
+ * @return 1 for rain, 0 for no rain.
+ */
+static float RainToIntensity(ERainTypes type)
+{
+	return (type == ERainTypes::Rain) ? 1.0f : 0.0f;
+}
 
 /**
  * Constructor for AWeatherController.
@@ -21,8 +58,9 @@ typedef UGameplayStatics GS;
  */
 AWeatherController::AWeatherController()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
+	// Tick only while a weather transition or actor updates are pending
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Initialize components
 	Sun = CreateDefaultSubobject<UDirectionalLightComponent>(TEXT("Sun"));
@@ -88,15 +126,12 @@ void AWeatherController::_ChangeRainAction()
 
 /**
  * Called when the game starts or when the actor is spawned.
- * Initializes weather and rain settings and sets up timers.
+ * Applies the weather settings immediately and sets up timers.
  */
 void AWeatherController::BeginPlay()
 {
 	Super::BeginPlay();
 
-	SetWeather(CurrentDayTime, CurrentOvercast);
-	SetRain(CurrentRain);
-
 	if (RainComponent)
 	{
 		RainComponent->ActivateSystem();
@@ -107,257 +142,218 @@ void AWeatherController::BeginPlay()
 		UE_LOG(LogTemp, Error, TEXT("RainComponent is null in BeginPlay."));
 	}
 
+	SetWeatherParameters(DayTimeToDaylight(CurrentDayTime), OvercastToCloudiness(CurrentOvercast), RainToIntensity(CurrentRain), 0.0f);
 	SetUpTimers();
 }
 
 /**
- * Performs an action on all actors of a specified class.
+ * Called when the actor is constructed or properties are changed in the editor.
+ * Applies the weather settings immediately. Actors in editor worlds do not register themselves,
+ * so the registry is rebuilt from the world first.
  *
- * @param ActorClass The class of actors to target.
- * @param Action The action to perform on each actor.
+ * @param Transform The transform of the actor.
  */
-void AWeatherController::_PerformActionOnAllActors(TSubclassOf<AActor> ActorClass, void(*Action)(AActor*))
+void AWeatherController::OnConstruction(const FTransform& Transform)
 {
-	if (!ActorClass)
+	UWorld* world = GetWorld();
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (world && registry && !world->IsGameWorld())
 	{
-		UE_LOG(LogTemp, Error, TEXT("_PerformActionOnAllActors: ActorClass is null."));
-		return;
+		registry->RefreshFromWorld();
 	}
 
-	TArray<AActor*> found;
-	GS::GetAllActorsOfClass(GetWorld(), ActorClass, found);
-
-	for (AActor* actor : found)
-	{
-		if (actor)
-		{
-			Action(actor);
-		}
-	}
+	SetWeatherParameters(DayTimeToDaylight(CurrentDayTime), OvercastToCloudiness(CurrentOvercast), RainToIntensity(CurrentRain), 0.0f);
 }
 
 /**
- * Sets a state on all actors of a specified class.
+ * Called every frame while a transition or actor updates are pending.
+ * Advances the transition and applies a budgeted number of actor updates, then stops ticking once idle.
  *
- * @param ActorClass The class of actors to target.
- * @param state The state to set.
- * @param Action The action to perform on each actor with the state.
+ * @param DeltaTime The time elapsed since the last frame.
  */
-void AWeatherController::_SetStateOnAllActors(TSubclassOf<AActor> ActorClass, bool state, void(*Action)(AActor*, bool))
+void AWeatherController::Tick(float DeltaTime)
 {
-	if (!ActorClass)
-	{
-		UE_LOG(LogTemp, Error, TEXT("_SetStateOnAllActors: ActorClass is null."));
-		return;
-	}
+	Super::Tick(DeltaTime);
 
-	TArray<AActor*> found;
-	GS::GetAllActorsOfClass(GetWorld(), ActorClass, found);
+	SCOPE_CYCLE_COUNTER(STAT_WeatherChange);
+	FTelemetryScope telemetryScope(GetWorld(), ETelemetryScopes::Weather);
 
-	for (AActor* actor : found)
+	if (_IsTransitioning)
 	{
-		if (actor)
+		_TransitionElapsed += DeltaTime;
+		float alpha = (_CurrentTransitionDuration > 0.0f) ? FMath::Clamp(_TransitionElapsed / _CurrentTransitionDuration, 0.0f, 1.0f) : 1.0f;
+		float smoothAlpha = FMath::SmoothStep(0.0f, 1.0f, alpha);
+
+		Daylight = FMath::Lerp(_StartDaylight, _TargetDaylight, smoothAlpha);
+		Cloudiness = FMath::Lerp(_StartCloudiness, _TargetCloudiness, smoothAlpha);
+		RainIntensity = FMath::Lerp(_StartRainIntensity, _TargetRainIntensity, smoothAlpha);
+		_ApplyWeather();
+
+		if (alpha >= 1.0f)
 		{
-			Action(actor, state);
+			_IsTransitioning = false;
 		}
 	}
-}
 
-/**
- * Called every frame to update the actor.
- *
- * @param deltaTime The time elapsed since the last frame.
- */
-void AWeatherController::Tick(float deltaTime)
-{
-	Super::Tick(deltaTime);
+	_ProcessActorUpdates(FMath::Max(1, ActorUpdatesPerFrame));
+
+	if (!_IsTransitioning && _PendingActorUpdates.Num() == 0)
+	{
+		SetActorTickEnabled(false);
+	}
 }
 
 /**
- * Called when the actor is constructed or properties are changed in the editor.
- * Updates weather and rain settings.
+ * Starts a transition to the given weather parameters.
+ * The discrete weather settings are updated to the nearest values of the targets.
+ * Outside of a game world, or with a zero duration, the parameters and all actor updates are applied immediately.
  *
- * @param Transform The transform of the actor.
+ * @param NewDaylight The target amount of daylight, 1 at day and 0 at night.
+ * @param NewCloudiness The target cloudiness, 0 for a clear sky and 1 for an overcast sky.
+ * @param NewRainIntensity The target rain intensity, 0 for no rain and 1 for full rain.
+ * @param Duration The duration of the transition, in seconds. Zero applies the parameters immediately.
  */
-void AWeatherController::OnConstruction(const FTransform& Transform)
+void AWeatherController::SetWeatherParameters(float NewDaylight, float NewCloudiness, float NewRainIntensity, float Duration)
 {
-	SetWeather(CurrentDayTime, CurrentOvercast);
-	SetRain(CurrentRain);
+	_StartDaylight = Daylight;
+	_StartCloudiness = Cloudiness;
+	_StartRainIntensity = RainIntensity;
+	_TargetDaylight = FMath::Clamp(NewDaylight, 0.0f, 1.0f);
+	_TargetCloudiness = FMath::Clamp(NewCloudiness, 0.0f, 1.0f);
+	_TargetRainIntensity = FMath::Clamp(NewRainIntensity, 0.0f, 1.0f);
+
+	CurrentDayTime = (_TargetDaylight >= 0.5f) ? EDayTimeTypes::Day : EDayTimeTypes::Night;
+	CurrentOvercast = (_TargetCloudiness >= 0.5f) ? EOvercastTypes::Overcast : EOvercastTypes::Clear;
+	CurrentRain = (_TargetRainIntensity >= 0.5f) ? ERainTypes::Rain : ERainTypes::NoRain;
+
+	UWorld* world = GetWorld();
+	if (Duration > 0.0f && world && world->IsGameWorld())
+	{
+		_TransitionElapsed = 0.0f;
+		_CurrentTransitionDuration = Duration;
+		_IsTransitioning = true;
+		SetActorTickEnabled(true);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_WeatherChange);
+	FTelemetryScope telemetryScope(world, ETelemetryScopes::Weather);
+
+	_IsTransitioning = false;
+	Daylight = _TargetDaylight;
+	Cloudiness = _TargetCloudiness;
+	RainIntensity = _TargetRainIntensity;
+
+	// Switch every actor again, actors registered since the last change may not match the weather yet
+	_LightsOn.Reset();
+	_PuddlesVisible.Reset();
+	_ApplyWeather();
+	_ProcessActorUpdates(MAX_int32);
 }
 
 /**
  * Sets the weather to the specified day time and overcast type.
+ * The change is interpolated over TransitionDuration.
  *
  * @param time The day time type to set.
  * @param overcast The overcast type to set.
  */
 void AWeatherController::SetWeather(EDayTimeTypes time, EOvercastTypes overcast)
 {
-	if (time == EDayTimeTypes::Day)
-	{
-		_SetDay(overcast);
-	}
-	else if (time == EDayTimeTypes::Night)
-	{
-		_SetNight(overcast);
-	}
-	else
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Invalid day time in SetWeather."));
-	}
+	SetWeatherParameters(DayTimeToDaylight(time), OvercastToCloudiness(overcast), _TargetRainIntensity, TransitionDuration);
 }
 
 /**
  * Sets the rain state in the simulation.
+ * The change is interpolated over TransitionDuration.
  *
  * @param rain The rain type to set.
  */
 void AWeatherController::SetRain(ERainTypes rain)
 {
-	if (rain == ERainTypes::NoRain)
-	{
-		_SetNoRain();
-	}
-	else if (rain == ERainTypes::Rain)
-	{
-		_SetRain();
-	}
-	else
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Invalid rain type in SetRain."));
-	}
+	SetWeatherParameters(_TargetDaylight, _TargetCloudiness, RainToIntensity(rain), TransitionDuration);
 }
 
 /**
- * Sets the weather to daytime with the specified overcast type.
- *
- * @param overcast The overcast type to set.
+ * Applies the current daylight, cloudiness and rain intensity to the sun, sky, clouds and rain.
+ * Lamps, car lights and puddles are only switched when their threshold is crossed, and the switches
+ * are queued so that they are spread over several frames.
  */
-void AWeatherController::_SetDay(EOvercastTypes overcast)
+void AWeatherController::_ApplyWeather()
 {
-	if (!Sun)
+	if (Sun)
 	{
-		UE_LOG(LogTemp, Error, TEXT("_SetDay: Sun component is null."));
-		return;
+		float clearIntensity = FMath::Lerp(NightSunIntensity, DaySunIntensity, Daylight);
+		float overcastIntensity = FMath::Lerp(NightOvercastIntensity, DayOvercastIntensity, Daylight);
+		Sun->SetIntensity(FMath::Lerp(clearIntensity, overcastIntensity, Cloudiness));
+		Sun->SetLightSourceAngle(0.54f);
+		Sun->SetWorldRotation(FRotator(270.0f, -80.0f, 270.0f));
 	}
-
-	float sunIntensity = (overcast == EOvercastTypes::Clear) ? DaySunIntensity : DayOvercastIntensity;
-	Sun->SetIntensity(sunIntensity);
-	Sun->SetLightSourceAngle(0.54f);
-	FRotator newRotation = FRotator(270.0f, -80.0f, 270.0f);
-	Sun->SetWorldRotation(newRotation);
-
-	_SetNightForControllers(false);
-	_SetCloudOvercast(overcast);
-	_TurnOffLamps();
-	CurrentDayTime = EDayTimeTypes::Day;
-}
-
-/**
- * Sets the weather to nighttime with the specified overcast type.
- *
- * @param overcast The overcast type to set.
- */
-void AWeatherController::_SetNight(EOvercastTypes overcast)
-{
-	if (!Sun)
+	else
 	{
-		UE_LOG(LogTemp, Error, TEXT("_SetNight: Sun component is null."));
-		return;
+		UE_LOG(LogTemp, Error, TEXT("_ApplyWeather: Sun component is null."));
 	}
 
-	float sunIntensity = (overcast == EOvercastTypes::Clear) ? NightSunIntensity : NightOvercastIntensity;
-	Sun->SetIntensity(sunIntensity);
-	Sun->SetLightSourceAngle(0.54f);
-	FRotator newRotation = FRotator(270.0f, -80.0f, 270.0f);
-	Sun->SetWorldRotation(newRotation);
-
-	_SetNightForControllers(true);
-	_SetCloudOvercast(overcast);
-	_TurnOnLamps();
-	CurrentDayTime = EDayTimeTypes::Night;
-}
-
-/**
- * Configures the cloud component for the specified overcast type.
- *
- * @param overcast The overcast type to set.
- */
-void AWeatherController::_SetCloudOvercast(EOvercastTypes overcast)
-{
-	if (!SkyAtmosphere || !VolumetricCloud)
+	if (SkyAtmosphere && VolumetricCloud)
 	{
-		UE_LOG(LogTemp, Error, TEXT("_SetCloudOvercast: SkyAtmosphere or VolumetricCloud is null."));
-		return;
+		SkyAtmosphere->SetMieScatteringScale(FMath::Lerp(ClearMieScattering, OvercastMieScattering, Cloudiness));
+		SkyAtmosphere->SetMieAnisotropy(FMath::Lerp(ClearMieAnisotropy, OvercastMieAnisotropy, Cloudiness));
+		SkyAtmosphere->SetRayleighScatteringScale(FMath::Lerp(ClearRayleighScattering, OvercastRayleighScattering, Cloudiness));
+		VolumetricCloud->SetVisibility(Cloudiness > KINDA_SMALL_NUMBER);
 	}
-
-	if (overcast == EOvercastTypes::Clear)
+	else
 	{
-		SkyAtmosphere->SetMieScatteringScale(ClearMieScattering);
-		SkyAtmosphere->SetMieAnisotropy(ClearMieAnisotropy);
-		SkyAtmosphere->SetRayleighScatteringScale(ClearRayleighScattering);
-		VolumetricCloud->SetVisibility(false);
-		CurrentOvercast = EOvercastTypes::Clear;
+		UE_LOG(LogTemp, Error, TEXT("_ApplyWeather: SkyAtmosphere or VolumetricCloud is null."));
 	}
-	else if (overcast == EOvercastTypes::Overcast)
+
+	if (RainComponent)
 	{
-		SkyAtmosphere->SetMieScatteringScale(OvercastMieScattering);
-		SkyAtmosphere->SetMieAnisotropy(OvercastMieAnisotropy);
-		SkyAtmosphere->SetRayleighScatteringScale(OvercastRayleighScattering);
-		VolumetricCloud->SetVisibility(true);
-		CurrentOvercast = EOvercastTypes::Overcast;
+		RainComponent->SetVisibility(RainIntensity > KINDA_SMALL_NUMBER);
+		RainComponent->SetNiagaraVariableFloat(RainIntensityParameterName, RainIntensity);
 	}
 	else
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Invalid overcast type in _SetCloudOvercast."));
+		UE_LOG(LogTemp, Error, TEXT("_ApplyWeather: RainComponent is null."));
 	}
-}
 
-/**
- * Turns on all lamps in the simulation.
- */
-void AWeatherController::_TurnOnLamps()
-{
-	_PerformActionOnAllActors(ALamp::StaticClass(), [](AActor* actor)
-		{
-			ALamp* lamp = Cast<ALamp>(actor);
-			if (lamp)
-			{
-				lamp->TurnOn();
-			}
-		});
-}
+	bool lightsOn = Daylight < LightsOnDaylight;
+	if (!_LightsOn.IsSet() || _LightsOn.GetValue() != lightsOn)
+	{
+		_LightsOn = lightsOn;
+		_SetNightForControllers(lightsOn);
+		_QueueLightUpdates(lightsOn);
+	}
 
-/**
- * Turns off all lamps in the simulation.
- */
-void AWeatherController::_TurnOffLamps()
-{
-	_PerformActionOnAllActors(ALamp::StaticClass(), [](AActor* actor)
-		{
-			ALamp* lamp = Cast<ALamp>(actor);
-			if (lamp)
-			{
-				lamp->TurnOff();
-			}
-		});
+	bool puddlesVisible = RainIntensity >= PuddlesRainIntensity;
+	if (!_PuddlesVisible.IsSet() || _PuddlesVisible.GetValue() != puddlesVisible)
+	{
+		_PuddlesVisible = puddlesVisible;
+		_QueuePuddleUpdates(puddlesVisible);
+	}
 }
 
 /**
  * Sets the nighttime state for all controllers in the simulation.
+ * Only affects cars spawned from now on, the lights of cars already on the road are queued separately.
  *
  * @param state True to enable nighttime, false otherwise.
  */
 void AWeatherController::_SetNightForControllers(bool state)
 {
-	_SetStateOnAllActors(ACarSpawnController::StaticClass(), state, [](AActor* actor, bool newState)
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!registry)
+	{
+		UE_LOG(LogTemp, Error, TEXT("_SetNightForControllers: Traffic registry is null."));
+		return;
+	}
+
+	for (ACarSpawnController* controller : registry->GetCarSpawnControllers())
+	{
+		if (controller)
 		{
-			ACarSpawnController* controller = Cast<ACarSpawnController>(actor);
-			if (controller)
-			{
-				controller->SetNight(newState);
-			}
-		});
+			controller->SetNight(state);
+		}
+	}
 }
 
 /**
@@ -377,56 +373,118 @@ void AWeatherController::_InitVolumetricCloud()
 }
 
 /**
- * Enables rain effects in the simulation.
+ * Queues the lamps and the lights of the managed cars to be switched on or off.
+ *
+ * @param State True to turn the lights on, false to turn them off.
  */
-void AWeatherController::_SetRain()
+void AWeatherController::_QueueLightUpdates(bool State)
 {
-	if (RainComponent)
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!registry)
 	{
-		RainComponent->SetVisibility(true);
+		UE_LOG(LogTemp, Error, TEXT("_QueueLightUpdates: Traffic registry is null."));
+		return;
 	}
-	else
+
+	for (ALamp* lamp : registry->GetLamps())
 	{
-		UE_LOG(LogTemp, Error, TEXT("_SetRain: RainComponent is null."));
+		if (lamp)
+		{
+			_PendingActorUpdates.Add({ lamp, EWeatherActorUpdateTypes::Lamp, State });
+		}
 	}
 
-	_SetPuddlesVisiblity(true);
-	CurrentRain = ERainTypes::Rain;
+	if (ATrafficManager* trafficManager = registry->GetTrafficManager())
+	{
+		for (ACar* car : trafficManager->GetCars())
+		{
+			if (car)
+			{
+				_PendingActorUpdates.Add({ car, EWeatherActorUpdateTypes::CarLights, State });
+			}
+		}
+	}
 }
 
 /**
- * Disables rain effects in the simulation.
+ * Queues the puddles to be shown or hidden.
+ *
+ * @param State True to show the puddles, false to hide them.
  */
-void AWeatherController::_SetNoRain()
+void AWeatherController::_QueuePuddleUpdates(bool State)
 {
-	if (RainComponent)
+	UTrafficRegistrySubsystem* registry = UTrafficRegistrySubsystem::Get(this);
+	if (!registry)
 	{
-		RainComponent->SetVisibility(false);
+		UE_LOG(LogTemp, Error, TEXT("_QueuePuddleUpdates: Traffic registry is null."));
+		return;
 	}
-	else
+
+	for (APuddle* puddle : registry->GetPuddles())
 	{
-		UE_LOG(LogTemp, Error, TEXT("_SetNoRain: RainComponent is null."));
+		if (puddle)
+		{
+			_PendingActorUpdates.Add({ puddle, EWeatherActorUpdateTypes::Puddle, State });
+		}
 	}
-
-	_SetPuddlesVisiblity(false);
-	CurrentRain = ERainTypes::NoRain;
 }
 
 /**
- * Sets the visibility of puddles in the simulation.
+ * Applies pending actor updates in the order they were queued.
+ * Updates of actors destroyed since they were queued are skipped.
  *
- * @param State True to make puddles visible, false otherwise.
+ * @param MaxUpdates The maximum number of updates to apply.
  */
-void AWeatherController::_SetPuddlesVisiblity(bool State)
+void AWeatherController::_ProcessActorUpdates(int32 MaxUpdates)
 {
-	_SetStateOnAllActors(APuddle::StaticClass(), State, [](AActor* actor, bool newState)
+	int32 processedCount = 0;
+	while (_NextActorUpdateIndex < _PendingActorUpdates.Num() && processedCount < MaxUpdates)
+	{
+		const FWeatherActorUpdate& update = _PendingActorUpdates[_NextActorUpdateIndex];
+		_NextActorUpdateIndex++;
+		processedCount++;
+
+		AActor* actor = update.Actor.Get();
+		if (!actor)
 		{
-			APuddle* puddle = Cast<APuddle>(actor);
-			if (puddle)
+			continue;
+		}
+
+		if (update.Type == EWeatherActorUpdateTypes::Lamp)
+		{
+			ALamp* lamp = Cast<ALamp>(actor);
+			if (lamp && update.bState)
 			{
-				puddle->SetActorHiddenInGame(!newState);
+				lamp->TurnOn();
 			}
-		});
+			else if (lamp)
+			{
+				lamp->TurnOff();
+			}
+		}
+		else if (update.Type == EWeatherActorUpdateTypes::Puddle)
+		{
+			actor->SetActorHiddenInGame(!update.bState);
+		}
+		else if (update.Type == EWeatherActorUpdateTypes::CarLights)
+		{
+			ACar* car = Cast<ACar>(actor);
+			if (car && update.bState)
+			{
+				car->TurnLightsOn();
+			}
+			else if (car)
+			{
+				car->TurnLightsOff();
+			}
+		}
+	}
+
+	if (_NextActorUpdateIndex >= _PendingActorUpdates.Num())
+	{
+		_PendingActorUpdates.Reset();
+		_NextActorUpdateIndex = 0;
+	}
 }
 
 /**
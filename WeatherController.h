@@ -66,10 +66,41 @@ enum class ERainTypes
  */
 ERainTypes GetNextRainType(ERainTypes type);
 
+/**
+ * Enum representing the kinds of actor updates applied by the weather controller over several frames.
+ * - Lamp: Turns a lamp on or off.
+ * - Puddle: Shows or hides a puddle.
+ * - CarLights: Turns the lights of a car on or off.
+ */
+enum class EWeatherActorUpdateTypes : uint8
+{
+	Lamp,
+	Puddle,
+	CarLights
+};
+
+/**
+ * FWeatherActorUpdate is a single pending actor update of the weather controller.
+ */
+struct FWeatherActorUpdate
+{
+	/** The actor to update, skipped if it was destroyed in the meantime. */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** The kind of the update. */
+	EWeatherActorUpdateTypes Type;
+
+	/** The state to set, on or visible if true. */
+	bool bState;
+};
+
 /**
  * AWeatherController is responsible for managing weather conditions in the simulation.
  * It controls day/night cycles, overcast conditions, and rain, and provides functionality
  * to dynamically change these conditions during runtime.
+ * Weather is described by continuous daylight, cloudiness and rain intensity values that are interpolated
+ * over TransitionDuration. Lamps, puddles and car lights are switched over several frames, at most
+ * ActorUpdatesPerFrame per frame. The controller only ticks while a transition or actor updates are pending.
  */
 UCLASS()
 class TSTOOLKIT_API AWeatherController : public AActor
@@ -115,6 +146,40 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Weather Settings")
 	ERainTypes CurrentRain = ERainTypes::NoRain;
 
+	/** Current amount of daylight, 1 at day and 0 at night. */
+	UPROPERTY(VisibleAnywhere, Category = "Weather Settings")
+	float Daylight = 1.0f;
+
+	/** Current cloudiness, 0 for a clear sky and 1 for an overcast sky. */
+	UPROPERTY(VisibleAnywhere, Category = "Weather Settings")
+	float Cloudiness = 0.0f;
+
+	/** Current rain intensity, 0 for no rain and 1 for full rain. */
+	UPROPERTY(VisibleAnywhere, Category = "Weather Settings")
+	float RainIntensity = 0.0f;
+
+	// Weather transition settings
+
+	/** Duration of a weather transition, in seconds. Zero applies changes immediately. */
+	UPROPERTY(EditAnywhere, Category = "Weather Transition Settings")
+	float TransitionDuration = 10.0f;
+
+	/** Maximum number of lamps, puddles and car lights switched in a single frame. */
+	UPROPERTY(EditAnywhere, Category = "Weather Transition Settings")
+	int32 ActorUpdatesPerFrame = 64;
+
+	/** Daylight below which lamps and car lights are turned on. */
+	UPROPERTY(EditAnywhere, Category = "Weather Transition Settings")
+	float LightsOnDaylight = 0.5f;
+
+	/** Rain intensity above which puddles are visible. */
+	UPROPERTY(EditAnywhere, Category = "Weather Transition Settings")
+	float PuddlesRainIntensity = 0.3f;
+
+	/** Name of the rain system's user parameter driven by the rain intensity. */
+	UPROPERTY(EditAnywhere, Category = "Weather Transition Settings")
+	FString RainIntensityParameterName = TEXT("RainIntensity");
+
 	// Weather change settings
 
 	/** Whether to enable dynamic day/night changes. */
@@ -186,36 +251,50 @@ public:
 	float OvercastRayleighScattering = 0.0f;
 
 private:
-	/**
-	 * Sets the weather to daytime with the specified overcast type.
-	 *
-	 * @param overcast The overcast type to set.
-	 */
-	void _SetDay(EOvercastTypes overcast);
+	/** Daylight at the start of the current transition. */
+	float _StartDaylight = 1.0f;
 
-	/**
-	 * Sets the weather to nighttime with the specified overcast type.
-	 *
-	 * @param overcast The overcast type to set.
-	 */
-	void _SetNight(EOvercastTypes overcast);
+	/** Cloudiness at the start of the current transition. */
+	float _StartCloudiness = 0.0f;
 
-	/**
-	 * Configures the cloud component for the specified overcast type.
-	 *
-	 * @param overcast The overcast type to set.
-	 */
-	void _SetCloudOvercast(EOvercastTypes overcast);
+	/** Rain intensity at the start of the current transition. */
+	float _StartRainIntensity = 0.0f;
 
-	/**
-	 * Turns on all lamps in the simulation.
-	 */
-	void _TurnOnLamps();
+	/** Daylight at the end of the current transition. */
+	float _TargetDaylight = 1.0f;
+
+	/** Cloudiness at the end of the current transition. */
+	float _TargetCloudiness = 0.0f;
+
+	/** Rain intensity at the end of the current transition. */
+	float _TargetRainIntensity = 0.0f;
+
+	/** Time elapsed since the start of the current transition, in seconds. */
+	float _TransitionElapsed = 0.0f;
+
+	/** Duration of the current transition, in seconds. */
+	float _CurrentTransitionDuration = 0.0f;
+
+	/** Indicates whether a transition is in progress. */
+	bool _IsTransitioning = false;
+
+	/** Whether lamps and car lights were last switched on, unset until the first switch. */
+	TOptional<bool> _LightsOn;
+
+	/** Whether puddles were last made visible, unset until the first switch. */
+	TOptional<bool> _PuddlesVisible;
+
+	/** Actor updates not applied yet, oldest first. */
+	TArray<FWeatherActorUpdate> _PendingActorUpdates;
+
+	/** Index of the next update in _PendingActorUpdates. */
+	int32 _NextActorUpdateIndex = 0;
 
 	/**
-	 * Turns off all lamps in the simulation.
+	 * Applies the current daylight, cloudiness and rain intensity to the sun, sky, clouds and rain,
+	 * and queues actor updates when a lights or puddles threshold is crossed.
 	 */
-	void _TurnOffLamps();
+	void _ApplyWeather();
 
 	/**
 	 * Sets the nighttime state for all controllers in the simulation.
@@ -230,21 +309,25 @@ private:
 	void _InitVolumetricCloud();
 
 	/**
-	 * Enables rain effects in the simulation.
+	 * Queues the lamps and the lights of the managed cars to be switched on or off.
+	 *
+	 * @param State True to turn the lights on, false to turn them off.
 	 */
-	void _SetRain();
+	void _QueueLightUpdates(bool State);
 
 	/**
-	 * Disables rain effects in the simulation.
+	 * Queues the puddles to be shown or hidden.
+	 *
+	 * @param State True to show the puddles, false to hide them.
 	 */
-	void _SetNoRain();
+	void _QueuePuddleUpdates(bool State);
 
 	/**
-	 * Sets the visibility of puddles in the simulation.
+	 * Applies pending actor updates.
 	 *
-	 * @param State True to make puddles visible, false otherwise.
+	 * @param MaxUpdates The maximum number of updates to apply.
 	 */
-	void _SetPuddlesVisiblity(bool State);
+	void _ProcessActorUpdates(int32 MaxUpdates);
 
 	// Timer methods
 
@@ -280,45 +363,53 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+public:
 	/**
-	 * Performs an action on all actors of a specified class.
+	 * Called when the actor is constructed or properties are changed in the editor.
 	 *
-	 * @param ActorClass The class of actors to target.
-	 * @param Action The action to perform on each actor.
+	 * @param Transform The transform of the actor.
 	 */
-	void _PerformActionOnAllActors(TSubclassOf<AActor> ActorClass, void (*Action)(AActor*));
+	void OnConstruction(const FTransform& Transform) override;
 
 	/**
-	 * Sets a state on all actors of a specified class.
+	 * Called every frame while a transition or actor updates are pending.
+	 * Advances the transition and applies a budgeted number of actor updates.
 	 *
-	 * @param ActorClass The class of actors to target.
-	 * @param state The state to set.
-	 * @param Action The action to perform on each actor with the state.
+	 * @param DeltaTime The time elapsed since the last frame.
 	 */
-	void _SetStateOnAllActors(TSubclassOf<AActor> ActorClass, bool state, void (*Action)(AActor*, bool));
+	virtual void Tick(float DeltaTime) override;
 
-public:
 	/**
-	 * Called every frame to update the actor.
-	 *
-	 * @param deltaTime The time elapsed since the last frame.
+	 * Sets up timers for dynamic weather changes.
 	 */
-	virtual void Tick(float deltaTime) override;
+	void SetUpTimers();
 
 	/**
-	 * Called when the actor is constructed or properties are changed in the editor.
+	 * Starts a transition to the given weather parameters.
+	 * The discrete weather settings are updated to the nearest values of the targets.
 	 *
-	 * @param Transform The transform of the actor.
+	 * @param NewDaylight The target amount of daylight, 1 at day and 0 at night.
+	 * @param NewCloudiness The target cloudiness, 0 for a clear sky and 1 for an overcast sky.
+	 * @param NewRainIntensity The target rain intensity, 0 for no rain and 1 for full rain.
+	 * @param Duration The duration of the transition, in seconds. Zero applies the parameters immediately.
 	 */
-	void OnConstruction(const FTransform& Transform) override;
+	UFUNCTION(BlueprintCallable)
+	void SetWeatherParameters(float NewDaylight, float NewCloudiness, float NewRainIntensity, float Duration);
 
 	/**
-	 * Sets up timers for dynamic weather changes.
+	 * Checks whether a weather transition is in progress.
+	 *
+	 * @return True if a transition is in progress, false otherwise.
 	 */
-	void SetUpTimers();
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE bool IsTransitioning() const
+	{
+		return _IsTransitioning;
+	}
 
 	/**
 	 * Sets the weather to the specified day time and overcast type.
+	 * The change is interpolated over TransitionDuration.
 	 *
 	 * @param time The day time type to set.
 	 * @param overcast The overcast type to set.
@@ -328,6 +419,7 @@ public:
 
 	/**
 	 * Sets the rain state in the simulation.
+	 * The change is interpolated over TransitionDuration.
 	 *
 	 * @param rain The rain type to set.
 	 */